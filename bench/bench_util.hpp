@@ -0,0 +1,99 @@
+/**
+ * @file bench_util.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Benchmark Utilities
+ * @brief Timing and corpus fixture shared by the programs under bench/.
+ */
+
+#ifndef _BENCH_UTIL_HPP_
+#define _BENCH_UTIL_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+
+//! @brief Best of three runs, in milliseconds.
+template < typename F >
+double best_time( F f_ )
+{
+    double best = 1e30;
+    for ( int run = 0; run < 3; ++run )
+    {
+        auto start = std::chrono::steady_clock::now();
+        f_();
+        std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min( best, elapsed.count() );
+    }
+    return best;
+}
+
+//! @brief The lines of a corpus that parse, with their postfix forms.
+struct Corpus
+{
+    std::string name;
+    std::vector< std::string > lines;                   //!< Lines that parsed, others are skipped.
+    std::vector< std::vector< std::string > > postfixes; //!< infix2postfix() of each one of `lines`.
+};
+
+//! @brief Parses every line of `lines_`, keeping the ones that are OK.
+inline Corpus parse_corpus( const std::string & name_, const std::vector< std::string > & lines_ )
+{
+    Parser parser;
+    Corpus corpus;
+    corpus.name = name_;
+
+    for ( const auto & line : lines_ )
+    {
+        if ( parser.parse( line ).type != Parser::ResultType::OK ) continue;
+
+        corpus.lines.push_back( line );
+        corpus.postfixes.push_back( infix2postfix( parser.get_tokens() ) );
+    }
+    return corpus;
+}
+
+//! @brief Every line of the file `path_`.
+inline std::vector< std::string > read_corpus( const std::string & path_ )
+{
+    std::ifstream ifs( path_ );
+    std::vector< std::string > lines;
+    for ( std::string line; std::getline( ifs, line ); )
+        lines.push_back( line );
+    return lines;
+}
+
+//! @brief Parses one corpus and hands it, with `args_`, to the benchmark's `measure_`.
+/*!
+ * @return What `measure_` returns: false if the evaluators disagreed.
+ */
+template < typename F, typename... Args >
+bool run_corpus( const std::string & name_, const std::vector< std::string > & lines_, F measure_, Args &&... args_ )
+{
+    return measure_( parse_corpus( name_, lines_ ), std::forward< Args >( args_ )... );
+}
+
+//! @brief run_corpus() on the files `argv_[first_]` to `argv_[argc_ - 1]`, named without their directory.
+/*!
+ * @return false if any of them failed; every file is run anyway.
+ */
+template < typename F, typename... Args >
+bool run_corpus_files( int first_, int argc_, char **argv_, F measure_, Args &&... args_ )
+{
+    bool ok = true;
+    for ( int i = first_; i < argc_; ++i )
+    {
+        std::string path( argv_[i] );
+        ok = run_corpus( path.substr( path.find_last_of( '/' ) + 1 ), read_corpus( path ), measure_, args_... ) and ok;
+    }
+    return ok;
+}
+
+#endif
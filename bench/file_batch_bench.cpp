@@ -0,0 +1,141 @@
+/**
+ * @file file_batch_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title File Batch Benchmark
+ * @brief Many small files and a few large ones through process_files(), split or not.
+ *
+ * Usage: file_batch_bench [small files] [large files] [lines of a large file] [max_workers]
+ *
+ * The files are written to a temporary directory. Each run is checked
+ * against the outputs of a run with one worker and no splitting. Without
+ * splitting, a large file is one task and the run waits for it at the end.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h> // mkdtemp, rmdir, unlink
+
+#include "../include/file_batch.hpp"
+#include "../include/infix2postfix.hpp"
+
+using ms = std::chrono::duration< double, std::milli >;
+
+//! @brief A random expression of `terms_` terms.
+std::string expression( std::mt19937 & rng_, int terms_ )
+{
+    const char ops[] = "+-*/%";
+    std::string e = std::to_string( rng_() % 1000 );
+    for ( int t = 1; t < terms_; ++t )
+        e += std::string( " " ) + ops[ rng_() % 5 ] + " " + ( rng_() % 4 == 0 ? "(" + std::to_string( rng_() % 100 ) +
+             " - " + std::to_string( rng_() % 100 ) + ")" : std::to_string( rng_() % 1000 ) );
+    return e;
+}
+
+//! @brief Writes a file of `lines_` expressions.
+void write_file( const std::string & path_, size_t lines_, std::mt19937 & rng_ )
+{
+    std::ofstream ofs( path_.c_str() );
+    for ( auto i(0u); i < lines_; ++i )
+        ofs << expression( rng_, 2 + static_cast< int >( rng_() % 12 ) ) << "\n";
+}
+
+//! @brief The whole content of `path_`.
+std::string slurp( const std::string & path_ )
+{
+    std::ifstream ifs( path_.c_str() );
+    std::ostringstream content;
+    content << ifs.rdbuf();
+    return content.str();
+}
+
+//! @brief Parses and evaluates a line, writing the answer or "error".
+void evaluate( Parser & parser_, const std::string & line_, std::string & out_ )
+{
+    if ( parser_.parse( line_ ).type != Parser::ResultType::OK )
+    {
+        out_ += "error\n";
+        return;
+    }
+    auto depth = parser_.get_stack_depth();
+    auto answer = evaluate_postfix( infix2postfix( parser_.get_tokens(), depth ), depth );
+    out_ += answer.second == 0 ? std::to_string( answer.first ) : answer.second < 0 ? "div0" : "overflow";
+    out_ += '\n';
+}
+
+int main( int argc, char **argv )
+{
+    size_t small = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 2000;
+    size_t large = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 2;
+    size_t large_lines = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 200000;
+    size_t max_workers = argc > 4 ? std::strtoul( argv[4], nullptr, 10 ) : std::thread::hardware_concurrency();
+    if ( max_workers == 0 ) max_workers = 1;
+
+    char dir_template[] = "/tmp/bares_batch_XXXXXX";
+    if ( mkdtemp( dir_template ) == nullptr ) return EXIT_FAILURE;
+    std::string dir( dir_template );
+
+    std::mt19937 rng( 2018 );
+    std::vector< BatchFile > files;
+    for ( auto i(0u); i < small + large; ++i )
+    {
+        auto name = dir + "/in" + std::to_string( i );
+        write_file( name, i < large ? large_lines : 1 + rng() % 200, rng );
+        files.push_back( BatchFile{ name, dir + "/out" + std::to_string( i ) } );
+    }
+    std::cout << small << " small files and " << large << " files of " << large_lines << " lines\n\n";
+
+    const size_t whole = size_t( -1 ) / 2; // No file is split.
+    std::vector< std::string > expected;
+    bool ok = true;
+
+    auto run = [&]( size_t workers_, size_t split_ ){
+        ThreadPool pool( workers_ );
+        auto start = std::chrono::steady_clock::now();
+        auto stats = process_files( files, pool, Parser::Limits(), evaluate, split_ );
+        double elapsed = ms( std::chrono::steady_clock::now() - start ).count();
+
+        ok = stats.failed.empty() and ok;
+        for ( auto i(0u); i < files.size(); ++i )
+        {
+            auto got = slurp( files[i].output );
+            if ( expected.size() < files.size() ) expected.push_back( got );
+            else if ( got != expected[i] ) ok = false;
+        }
+        return elapsed; };
+
+    double sequential = run( 1, whole );
+    std::cout << std::setw( 12 ) << "workers" << std::setw( 16 ) << "whole files" << std::setw( 16 ) << "split"
+              << std::setw( 12 ) << "speedup" << "\n" << std::fixed << std::setprecision( 2 );
+    for ( size_t workers = 1; workers <= max_workers; workers *= 2 )
+    {
+        auto unsplit = run( workers, whole );
+        auto split = run( workers, default_split_size );
+        std::cout << std::setw( 12 ) << workers << std::setw( 13 ) << unsplit << " ms" << std::setw( 13 ) << split
+                  << " ms" << std::setw( 11 ) << sequential / split << "x\n";
+    }
+
+    for ( const auto & f : files )
+    {
+        unlink( f.input.c_str() );
+        unlink( f.output.c_str() );
+    }
+    rmdir( dir.c_str() );
+
+    if ( not ok )
+    {
+        std::cerr << "Outputs differ from the sequential run!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file gzip_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Gzip Benchmark
+ * @brief Throughput of plain and gzip files, read alone and read while evaluating.
+ *
+ * Usage: gzip_bench [lines] [corpus file]
+ *
+ * Without a corpus, `lines` random expressions are generated. The text is
+ * written plain and gzip-compressed to temporary files, then read back
+ * with std::ifstream, with GzipReader decompressing inline, and with
+ * GzipReader decompressing on its own thread; every reader has to give
+ * the same lines. Rates are of uncompressed text. The answers are then
+ * written plain and compressed at a few levels.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h> // stat
+#include <unistd.h>   // unlink
+
+#include "../include/gzip_stream.hpp"
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+
+using seconds = std::chrono::duration< double >;
+
+//! @brief Size of the file at `path_`.
+double file_size( const std::string & path_ )
+{
+    struct stat st;
+    return stat( path_.c_str(), &st ) == 0 ? double( st.st_size ) : 0;
+}
+
+//! @brief Reads every line of `is_`, evaluating them if `evaluate_`. @return A checksum of the lines.
+size_t consume( std::istream & is_, bool evaluate_, std::string & answers_ )
+{
+    Parser parser;
+    size_t sum = 0;
+    answers_.clear();
+    for ( std::string line; std::getline( is_, line ); )
+    {
+        sum = sum * 31 + line.size() + ( line.empty() ? 0 : line.back() );
+        if ( not evaluate_ ) continue;
+
+        if ( parser.parse( line ).type != Parser::ResultType::OK )
+        {
+            answers_ += "error\n";
+            continue;
+        }
+        auto depth = parser.get_stack_depth();
+        auto answer = evaluate_postfix( infix2postfix( parser.get_tokens(), depth ), depth );
+        answers_ += answer.second == 0 ? std::to_string( answer.first ) : "error";
+        answers_ += '\n';
+    }
+    return sum;
+}
+
+int main( int argc, char **argv )
+{
+    size_t lines = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 1000000;
+
+    std::string text;
+    if ( argc > 2 )
+    {
+        std::ifstream ifs( argv[2] );
+        for ( std::string line; std::getline( ifs, line ); ) text += line + "\n";
+    }
+    else
+    {
+        std::mt19937 rng( 2018 );
+        const char ops[] = "+-*/%";
+        for ( auto i(0u); i < lines; ++i )
+        {
+            text += std::to_string( rng() % 1000 );
+            for ( auto t = rng() % 10; t > 0; --t )
+                text += std::string( " " ) + ops[ rng() % 5 ] + " " + std::to_string( rng() % 1000 );
+            text += "\n";
+        }
+    }
+
+    const std::string plain = "/tmp/bares_gzip_bench.dat", packed = plain + ".gz", out = plain + ".out";
+    {
+        std::ofstream ofs( plain.c_str() );
+        ofs << text;
+        GzipWriter gz;
+        if ( not gz.open( packed ) ) return EXIT_FAILURE;
+        std::ostream os( &gz );
+        os << text;
+        if ( not gz.close() ) return EXIT_FAILURE;
+    }
+
+    const double megabytes = text.size() / 1e6;
+    std::cout << std::fixed << std::setprecision( 1 ) << megabytes << " MB of text, " << file_size( packed ) / 1e6
+              << " MB compressed\n\n";
+
+    bool ok = true;
+    size_t expected_sum = 0;
+    std::string expected_answers, answers;
+    std::cout << std::setw( 26 ) << "reader" << std::setw( 16 ) << "read MB/s" << std::setw( 22 ) << "read + eval MB/s" << "\n";
+
+    for ( int reader = 0; reader < 3; ++reader )
+    {
+        const char * names[] = { "plain std::ifstream", "gzip, inline", "gzip, own thread" };
+        double rates[2];
+        for ( int evaluate = 0; evaluate < 2; ++evaluate )
+        {
+            std::ifstream ifs;
+            GzipReader gz( default_gzip_block, reader == 2 );
+            std::istream is( nullptr );
+            if ( reader == 0 )
+            {
+                ifs.open( plain.c_str() );
+                is.rdbuf( ifs.rdbuf() );
+            }
+            else
+            {
+                gz.open( packed );
+                is.rdbuf( &gz );
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            auto sum = consume( is, evaluate == 1, answers );
+            rates[ evaluate ] = megabytes / seconds( std::chrono::steady_clock::now() - start ).count();
+
+            if ( reader == 0 and evaluate == 1 ) expected_answers = answers;
+            if ( reader == 0 and evaluate == 0 ) expected_sum = sum;
+            ok = ok and sum == expected_sum and not gz.failed() and ( evaluate == 0 or answers == expected_answers );
+        }
+        std::cout << std::setw( 26 ) << names[ reader ] << std::setw( 16 ) << rates[0] << std::setw( 22 ) << rates[1] << "\n";
+    }
+
+    std::cout << "\n" << std::setw( 26 ) << "writer" << std::setw( 16 ) << "write MB/s" << std::setw( 22 ) << "output MB" << "\n";
+    const double answer_mb = expected_answers.size() / 1e6;
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::ofstream ofs( out.c_str() );
+        ofs << expected_answers;
+        ofs.close();
+        std::cout << std::setw( 26 ) << "plain std::ofstream" << std::setw( 16 )
+                  << answer_mb / seconds( std::chrono::steady_clock::now() - start ).count()
+                  << std::setw( 22 ) << std::setprecision( 2 ) << file_size( out ) / 1e6 << std::setprecision( 1 ) << "\n";
+    }
+    for ( int level : { 1, 6, 9 } )
+    {
+        auto start = std::chrono::steady_clock::now();
+        GzipWriter gz;
+        ok = gz.open( out, level ) and ok;
+        std::ostream os( &gz );
+        os << expected_answers;
+        ok = gz.close() and ok;
+        std::cout << std::setw( 25 ) << "gzip, level " << level << std::setw( 16 )
+                  << answer_mb / seconds( std::chrono::steady_clock::now() - start ).count()
+                  << std::setw( 22 ) << std::setprecision( 2 ) << file_size( out ) / 1e6 << std::setprecision( 1 ) << "\n";
+    }
+
+    // The last output, read back, has to be the answers.
+    {
+        GzipReader gz;
+        gz.open( out );
+        std::istream is( &gz );
+        std::string back( ( std::istreambuf_iterator< char >( is ) ), std::istreambuf_iterator< char >() );
+        ok = ok and back == expected_answers;
+    }
+
+    unlink( plain.c_str() );
+    unlink( packed.c_str() );
+    unlink( out.c_str() );
+
+    if ( not ok )
+    {
+        std::cerr << "The readers or writers disagree!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
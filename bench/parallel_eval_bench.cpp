@@ -0,0 +1,78 @@
+/**
+ * @file parallel_eval_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Parallel Evaluation Benchmark
+ * @brief Scaling of evaluate_postfix_parallel() with the number of workers.
+ *
+ * Usage: parallel_eval_bench [products] [factors] [max_workers]
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+#include "../include/parallel_eval.hpp"
+#include "bench_util.hpp"
+
+//! @brief Builds `products_` products of `factors_` operands, alternately added and subtracted.
+/*!
+ * Parentheses are avoided on purpose: the parser recurses once per
+ * parenthesized term, so precedence alone shapes the tree here.
+ */
+std::string wide_expression( size_t products_, size_t factors_ )
+{
+    std::string product( "1" );
+    for ( auto i(1u); i < factors_; ++i )
+        product += "*1";
+
+    std::string expr( product );
+    for ( auto i(1u); i < products_; ++i )
+        expr += ( i % 2 ? "+" : "-" ) + product;
+
+    return expr;
+}
+
+int main( int argc, char **argv )
+{
+    size_t products = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 250;
+    size_t factors = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 1000;
+    size_t max_workers = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : std::thread::hardware_concurrency();
+    if ( max_workers == 0 ) max_workers = 1;
+
+    Parser parser;
+    auto result = parser.parse( wide_expression( products, factors ) );
+    if ( result.type != Parser::ResultType::OK )
+    {
+        std::cerr << "Benchmark expression did not parse!\n";
+        return EXIT_FAILURE;
+    }
+    auto postfix = infix2postfix( parser.get_tokens() );
+
+    std::pair< value_type,int > expected;
+    auto sequential = best_time( [&](){ expected = evaluate_postfix( postfix ); } );
+
+    std::cout << "Postfix entries: " << postfix.size() << "\n";
+    std::cout << std::setw( 10 ) << "workers" << std::setw( 14 ) << "time (ms)" << std::setw( 10 ) << "speedup\n";
+    std::cout << std::setw( 10 ) << "seq" << std::setw( 14 ) << sequential << std::setw( 10 ) << 1.0 << "\n";
+
+    for ( size_t workers = 1; workers <= max_workers; workers *= 2 )
+    {
+        ThreadPool pool( workers );
+        std::pair< value_type,int > answer;
+        auto elapsed = best_time( [&](){ answer = evaluate_postfix_parallel( postfix, pool ); } );
+
+        if ( answer != expected )
+        {
+            std::cerr << "Parallel result differs from the sequential one!\n";
+            return EXIT_FAILURE;
+        }
+        std::cout << std::setw( 10 ) << workers << std::setw( 14 ) << elapsed
+                  << std::setw( 10 ) << sequential / elapsed << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file range_analysis_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Range Analysis Benchmark
+ * @brief Compiled programs run with every check against programs marked by mark_unchecked().
+ *
+ * Usage: range_analysis_bench [repetitions] [corpus files...]
+ *
+ * Without corpus files, a generated corpus of short expressions like the
+ * ones in data/ is used.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/range_analysis.hpp"
+#include "bench_util.hpp"
+
+//! @brief `count_` expressions of 2 to 24 small operands, some parenthesized, a few failing.
+std::vector< std::string > generated_corpus( size_t count_ )
+{
+    std::mt19937 gen( 2018 );
+    std::uniform_int_distribution< int > operands( 2, 24 ), literal( -99, 999 ), coin( 0, 9 );
+    const char ops[] = "+-*/%^";
+    std::uniform_int_distribution< int > op( 0, 5 );
+
+    std::vector< std::string > corpus;
+    for ( auto i(0u); i < count_; ++i )
+    {
+        std::string expr;
+        int open = 0;
+        for ( int n = operands( gen ), k = 0; k < n; ++k )
+        {
+            if ( k > 0 )
+            {
+                char o = ops[ op( gen ) ];
+                // Keep most powers small, so most lines evaluate.
+                if ( o == '^' and coin( gen ) > 1 ) o = '+';
+                expr += ' '; expr += o; expr += ' ';
+            }
+            if ( coin( gen ) == 0 ) { expr += '('; ++open; }
+            expr += std::to_string( literal( gen ) );
+            if ( open > 0 and coin( gen ) < 3 ) { expr += ')'; --open; }
+        }
+        expr.append( open, ')' );
+        corpus.push_back( expr );
+    }
+    return corpus;
+}
+
+//! @brief Times one corpus. @return false if the marked programs give other answers.
+bool measure( const Corpus & corpus_, size_t repetitions_ )
+{
+    std::vector< Program > checked, marked;
+    RangeAnalysis analysis;
+
+    for ( const auto & postfix : corpus_.postfixes )
+    {
+        checked.push_back( compile_postfix( postfix ) );
+        marked.push_back( checked.back() );
+
+        auto outcome = mark_unchecked( marked.back() );
+        analysis.operations += outcome.operations;
+        analysis.unchecked += outcome.unchecked;
+    }
+
+    for ( auto i(0u); i < checked.size(); ++i )
+        if ( execute_program( checked[i] ) != execute_program( marked[i] ) )
+            return false;
+
+    auto run = [&]( const std::vector< Program > & programs_, CheckCounters & counters_ )
+    {
+        counters_ = CheckCounters();
+        value_type sink = 0;
+        for ( auto r(0u); r < repetitions_; ++r )
+            for ( const auto & p : programs_ )
+                sink += execute_program( p, &counters_ ).first;
+        return sink;
+    };
+
+    CheckCounters c1, c2;
+    volatile value_type sink;
+    auto t_checked = best_time( [&](){ sink = run( checked, c1 ); } );
+    auto t_marked = best_time( [&](){ sink = run( marked, c2 ); } );
+    (void) sink;
+
+    std::cout << std::setw( 12 ) << corpus_.name << std::setw( 8 ) << checked.size()
+              << std::setw( 10 ) << analysis.unchecked << "/" << std::left << std::setw( 8 ) << analysis.operations << std::right
+              << std::setw( 12 ) << c2.skipped << std::setw( 12 ) << c2.performed
+              << std::setw( 12 ) << t_checked << std::setw( 12 ) << t_marked
+              << std::setw( 10 ) << t_checked / t_marked << "\n";
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    size_t repetitions = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 200;
+
+    std::cout << std::setw( 12 ) << "corpus" << std::setw( 8 ) << "lines" << std::setw( 19 ) << "safe/ops"
+              << std::setw( 12 ) << "skipped" << std::setw( 12 ) << "performed"
+              << std::setw( 12 ) << "checked ms" << std::setw( 12 ) << "marked ms" << std::setw( 10 ) << "speedup\n";
+
+    bool ok = run_corpus( "generated", generated_corpus( 5000 ), measure, repetitions );
+    ok = run_corpus_files( 2, argc, argv, measure, repetitions ) and ok;
+
+    if ( not ok )
+    {
+        std::cerr << "Marked programs gave different answers!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file sheet_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Sheet Benchmark
+ * @brief Full and incremental recomputation of a Sheet, sequential and on a pool.
+ *
+ * Usage: sheet_bench [definitions] [width] [edits] [max_workers]
+ *
+ * The sheet has levels of `width` definitions; each one refers to the
+ * three nearest definitions of the level before. Edits change a random
+ * definition and recompute; their results are checked against a sheet
+ * built from scratch.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/sheet.hpp"
+
+using ms = std::chrono::duration< double, std::milli >;
+
+//! @brief Name of definition `i_`.
+std::string name_of( size_t i_ ) { return "v" + std::to_string( i_ ); }
+
+//! @brief The definition of `i_`, which stays within range for any values of its references.
+std::string definition( size_t i_, size_t width_, std::mt19937 & rng_ )
+{
+    if ( i_ < width_ )
+        return std::to_string( rng_() % 2000 ) + " - 1000";
+
+    // Like a column of a spreadsheet: the cells above, to the left and to the right.
+    auto level = i_ / width_, column = i_ % width_;
+    auto above = [&]( size_t shift_ ){ return name_of( ( level - 1 ) * width_ + ( column + shift_ ) % width_ ); };
+    return "(" + above( width_ - 1 ) + " + " + above( 0 ) + " * 3) % 1000 - " + above( 1 ) + " / 7 + " +
+           std::to_string( rng_() % 13 );
+}
+
+//! @brief Defines every name of `sheet_` from `definitions_`.
+void fill( Sheet & sheet_, const std::vector< std::string > & definitions_ )
+{
+    for ( auto i(0u); i < definitions_.size(); ++i )
+        sheet_.define( name_of( i ), definitions_[i] );
+}
+
+//! @brief Says if both sheets have the same answers for every name of `definitions_`.
+bool same_answers( const Sheet & a_, const Sheet & b_, size_t definitions_ )
+{
+    for ( auto i(0u); i < definitions_; ++i )
+    {
+        const auto & x = a_.cell( a_.find( name_of( i ) ) );
+        const auto & y = b_.cell( b_.find( name_of( i ) ) );
+        if ( x.status != y.status or x.answer != y.answer ) return false;
+    }
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    size_t definitions = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 100000;
+    size_t width = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 1000;
+    size_t edits = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 100;
+    size_t max_workers = argc > 4 ? std::strtoul( argv[4], nullptr, 10 ) : std::thread::hardware_concurrency();
+    if ( definitions == 0 or width == 0 ) return EXIT_FAILURE;
+    if ( max_workers == 0 ) max_workers = 1;
+
+    std::mt19937 rng( 2018 );
+    std::vector< std::string > defs;
+    for ( auto i(0u); i < definitions; ++i )
+        defs.push_back( definition( i, width, rng ) );
+
+    std::cout << definitions << " definitions in " << ( definitions + width - 1 ) / width << " levels\n\n";
+    std::cout << std::setw( 24 ) << "full recompute" << std::setw( 12 ) << "ms" << std::setw( 12 ) << "speedup" << "\n";
+
+    // Parsing is left out: it is the same for every run.
+    double sequential = 0;
+    Sheet reference;
+    fill( reference, defs );
+    {
+        auto start = std::chrono::steady_clock::now();
+        reference.recompute();
+        sequential = ms( std::chrono::steady_clock::now() - start ).count();
+    }
+    std::cout << std::setw( 24 ) << "sequential" << std::fixed << std::setprecision( 2 )
+              << std::setw( 12 ) << sequential << std::setw( 12 ) << 1.0 << "\n";
+
+    bool ok = true;
+    for ( size_t workers = 1; workers <= max_workers; workers *= 2 )
+    {
+        ThreadPool pool( workers );
+        Sheet sheet( &pool );
+        fill( sheet, defs );
+
+        auto start = std::chrono::steady_clock::now();
+        sheet.recompute();
+        double elapsed = ms( std::chrono::steady_clock::now() - start ).count();
+        ok = same_answers( sheet, reference, definitions ) and ok;
+
+        std::cout << std::setw( 16 ) << workers << " workers" << std::setw( 12 ) << elapsed
+                  << std::setw( 12 ) << sequential / elapsed << "\n";
+    }
+
+    // Edits, each followed by a recompute of what depends on it.
+    size_t evaluated = 0;
+    double incremental = 0;
+    for ( auto e(0u); e < edits; ++e )
+    {
+        auto i = rng() % definitions;
+        defs[i] = definition( i, width, rng );
+        reference.define( name_of( i ), defs[i] );
+
+        auto start = std::chrono::steady_clock::now();
+        evaluated += reference.recompute();
+        incremental += ms( std::chrono::steady_clock::now() - start ).count();
+    }
+
+    if ( edits > 0 )
+    {
+        Sheet fresh;
+        fill( fresh, defs );
+        fresh.recompute();
+        ok = same_answers( reference, fresh, definitions ) and ok;
+
+        std::cout << "\n" << edits << " edits: " << std::setprecision( 3 ) << incremental / edits << " ms and "
+                  << std::setprecision( 0 ) << double( evaluated ) / edits << " definitions evaluated per edit"
+                  << std::setprecision( 1 ) << " (" << sequential * edits / incremental << "x faster than a full recompute)\n";
+    }
+
+    if ( not ok )
+    {
+        std::cerr << "Answers differ from the sequential full recompute!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
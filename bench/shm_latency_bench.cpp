@@ -0,0 +1,239 @@
+/**
+ * @file shm_latency_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shared Memory Latency Benchmark
+ * @brief Round trips to a ShmServer against the same requests over a pair of pipes.
+ *
+ * Usage: shm_latency_bench [round trips] [batch size]
+ *
+ * Both servers run in a child process and evaluate with Parser,
+ * infix2postfix() and evaluate_postfix(). Single requests measure the
+ * latency of a round trip; batches measure the throughput.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+#include "../include/shm_ipc.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+//! @brief A few expressions like the ones in data/.
+const std::vector< std::string > expressions = {
+    "1 + 3 * ( 9/2 - 3 * 2 ^3 )", "1+2-3*4%2  ^2", "10 + 5/5 + 8 * 3", "(30000/(10+10)) * 12",
+    "-5-4-4-(-1-4)", "3/(1-1)", "20*20000", "2 ** 3" };
+
+//! @brief What the pipe server does with one request; the same as the shared memory server.
+ShmResult evaluate_one( Parser & parser_, std::uint64_t id_, const std::string & expression_ )
+{
+    ShmResult out{ id_, 0, 0, 0, 0 };
+    auto result = parser_.parse( expression_ );
+    out.code = result.type;
+    if ( result.type != Parser::ResultType::OK )
+    {
+        out.at_col = result.at_col;
+        return out;
+    }
+
+    auto depth = parser_.get_stack_depth();
+    auto answer = evaluate_postfix( infix2postfix( parser_.get_tokens(), depth ), depth );
+    out.eval = answer.second;
+    out.value = answer.first;
+    return out;
+}
+
+//! @brief Reads or writes exactly `n_` bytes. @return false at the end of the pipe.
+bool read_all( int fd_, void * buf_, size_t n_ )
+{
+    auto p = static_cast< char * >( buf_ );
+    while ( n_ > 0 )
+    {
+        auto r = read( fd_, p, n_ );
+        if ( r <= 0 ) return false;
+        p += r; n_ -= static_cast< size_t >( r );
+    }
+    return true;
+}
+
+bool write_all( int fd_, const void * buf_, size_t n_ )
+{
+    auto p = static_cast< const char * >( buf_ );
+    while ( n_ > 0 )
+    {
+        auto w = write( fd_, p, n_ );
+        if ( w <= 0 ) return false;
+        p += w; n_ -= static_cast< size_t >( w );
+    }
+    return true;
+}
+
+//! @brief Pipe server: length-prefixed expressions in, ShmResult out, until the pipe closes.
+void pipe_server( int in_, int out_ )
+{
+    Parser parser;
+    std::uint32_t length;
+    std::string expression;
+    std::uint64_t id = 0;
+    while ( read_all( in_, &length, sizeof( length ) ) )
+    {
+        expression.resize( length );
+        if ( not read_all( in_, &expression[0], length ) ) break;
+
+        auto result = evaluate_one( parser, id++, expression );
+        if ( not write_all( out_, &result, sizeof( result ) ) ) break;
+    }
+}
+
+//! @brief Prints the percentiles of `samples_`, in microseconds, and the request rate.
+void report( const std::string & name_, std::vector< double > samples_, double requests_per_s_ )
+{
+    std::sort( samples_.begin(), samples_.end() );
+    auto at = [&]( double q ){ return samples_[ std::min( samples_.size() - 1, size_t( q * samples_.size() ) ) ]; };
+
+    std::cout << std::setw( 22 ) << name_ << std::fixed << std::setprecision( 2 )
+              << std::setw( 10 ) << at( 0.5 ) << std::setw( 10 ) << at( 0.99 ) << std::setw( 10 ) << at( 0.999 )
+              << std::setw( 14 ) << std::setprecision( 0 ) << requests_per_s_ << "\n";
+}
+
+//! @brief Times `round_trips_` single requests and then batches of `batch_`, through `send_` and `receive_`.
+template < typename Send, typename Receive >
+void measure( const std::string & name_, size_t round_trips_, size_t batch_, Send send_, Receive receive_ )
+{
+    std::vector< double > samples;
+    samples.reserve( round_trips_ );
+
+    for ( auto i(0u); i < round_trips_; ++i )
+    {
+        auto start = bench_clock::now();
+        send_( &expressions[ i % expressions.size() ], 1 );
+        receive_( 1 );
+        std::chrono::duration< double, std::micro > elapsed = bench_clock::now() - start;
+        samples.push_back( elapsed.count() );
+    }
+
+    std::vector< std::string > batch;
+    for ( auto i(0u); i < batch_; ++i ) batch.push_back( expressions[ i % expressions.size() ] );
+
+    auto batches = std::max< size_t >( 1, round_trips_ / batch_ );
+    auto start = bench_clock::now();
+    for ( auto i(0u); i < batches; ++i )
+    {
+        send_( batch.data(), batch.size() );
+        receive_( batch.size() );
+    }
+    std::chrono::duration< double > elapsed = bench_clock::now() - start;
+
+    report( name_, samples, batches * batch_ / elapsed.count() );
+}
+
+int main( int argc, char **argv )
+{
+    size_t round_trips = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 100000;
+    size_t batch = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 64;
+    if ( round_trips == 0 or batch == 0 ) return EXIT_FAILURE;
+
+    std::cout << std::setw( 22 ) << "transport" << std::setw( 10 ) << "p50 us" << std::setw( 10 ) << "p99 us"
+              << std::setw( 10 ) << "p99.9 us" << std::setw( 14 ) << "batched req/s" << "\n";
+
+    //--- Shared memory, with the server in a child process, as `bares serve` runs it.
+    std::string name = "/bares-bench-" + std::to_string( getpid() );
+    pid_t server = fork();
+    if ( server == 0 )
+    {
+        sigset_t signals;
+        sigemptyset( &signals );
+        sigaddset( &signals, SIGTERM );
+        pthread_sigmask( SIG_BLOCK, &signals, nullptr );
+
+        {
+            // Destroyed before _exit(), so the object is unlinked.
+            ShmServer shm;
+            if ( not shm.start( name ) ) _exit( EXIT_FAILURE );
+            int received;
+            sigwait( &signals, &received );
+        }
+        _exit( EXIT_SUCCESS );
+    }
+
+    bool ok = true;
+    for ( bool blocking : { true, false } )
+    {
+        ShmClient client( blocking );
+        for ( int tries = 0; not client.connect( name ); ++tries )
+        {
+            if ( tries == 1000 ) { ok = false; break; }
+            usleep( 1000 );
+        }
+        if ( not ok ) break;
+
+        std::uint64_t id = 0;
+        ShmResult r;
+        measure( blocking ? "shm (futex)" : "shm (spin)", round_trips, batch,
+                 [&]( const std::string * e_, size_t n_ ){
+                     for ( auto i(0u); i < n_; ++i ) client.submit( e_[i], id++ );
+                     client.flush(); },
+                 [&]( size_t n_ ){ for ( auto i(0u); i < n_; ++i ) ok = client.wait( r ) and ok; } );
+        client.disconnect();
+    }
+
+    kill( server, SIGTERM );
+    waitpid( server, nullptr, 0 );
+
+    //--- Pipes, with the same work on the other side.
+    int to_server[2], from_server[2];
+    if ( pipe( to_server ) != 0 or pipe( from_server ) != 0 ) return EXIT_FAILURE;
+
+    pid_t piper = fork();
+    if ( piper == 0 )
+    {
+        close( to_server[1] );
+        close( from_server[0] );
+        pipe_server( to_server[0], from_server[1] );
+        _exit( EXIT_SUCCESS );
+    }
+    close( to_server[0] );
+    close( from_server[1] );
+
+    std::vector< char > out;
+    std::vector< ShmResult > in;
+    measure( "pipe", round_trips, batch,
+             [&]( const std::string * e_, size_t n_ ){
+                 // One write per batch, as the shared memory client publishes once.
+                 out.clear();
+                 for ( auto i(0u); i < n_; ++i )
+                 {
+                     auto length = static_cast< std::uint32_t >( e_[i].size() );
+                     out.insert( out.end(), reinterpret_cast< char * >( &length ), reinterpret_cast< char * >( &length ) + 4 );
+                     out.insert( out.end(), e_[i].begin(), e_[i].end() );
+                 }
+                 ok = write_all( to_server[1], out.data(), out.size() ) and ok; },
+             [&]( size_t n_ ){
+                 in.resize( n_ );
+                 ok = read_all( from_server[0], in.data(), n_ * sizeof( ShmResult ) ) and ok; } );
+
+    close( to_server[1] );
+    close( from_server[0] );
+    waitpid( piper, nullptr, 0 );
+
+    if ( not ok )
+    {
+        std::cerr << "A transport failed!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
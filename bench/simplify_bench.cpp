@@ -0,0 +1,155 @@
+/**
+ * @file simplify_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Simplify Benchmark
+ * @brief Differential check and timing of simplify_program() against the programs as compiled.
+ *
+ * Usage: simplify_bench [expressions] [repetitions] [corpus files...]
+ *
+ * Every expression is evaluated by evaluate_postfix() and, simplified or
+ * not, by execute_program() (with and without mark_unchecked()) and by
+ * execute_threaded(). Any answer that differs, error code or value, is
+ * printed and fails the run. The generated expressions favour what the
+ * pass rewrites: powers of two, 0, 1 and -1, "-(", "^2" and the ends of
+ * the `short int` range.
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/range_analysis.hpp"
+#include "../include/simplify.hpp"
+#include "../include/threaded_eval.hpp"
+#include "bench_util.hpp"
+
+//! @brief Random expressions, `depth_` levels of operators deep at most.
+class Generator
+{
+    public:
+        explicit Generator( unsigned seed_ ) : gen( seed_ ) { /* empty */ }
+
+        std::string expression( int depth_ )
+        {
+            if ( depth_ == 0 or pick( 4 ) == 0 )
+                return literal();
+
+            // Unary minus in front of parentheses, sometimes twice.
+            if ( pick( 6 ) == 0 )
+                return std::string( pick( 3 ) == 0 ? "-(-(" : "-(" ) + expression( depth_ - 1 ) +
+                       ( pick( 3 ) == 0 ? "))" : ")" );
+
+            const char ops[] = "+-*/%^";
+            char op = ops[ pick( 6 ) ];
+            std::string right = op == '^' ? std::to_string( pick( 4 ) ) : expression( depth_ - 1 );
+            return "(" + expression( depth_ - 1 ) + " " + op + " " + right + ")";
+        }
+
+    private:
+        std::mt19937 gen;
+
+        int pick( int n_ ) { return std::uniform_int_distribution< int >( 0, n_ - 1 )( gen ); }
+
+        std::string literal( void )
+        {
+            static const int special[] = { 0, 1, -1, 2, -2, 4, 8, 64, 1024, 16384, -16384, 32767, -32768, 181, 182 };
+            switch ( pick( 3 ) )
+            {
+                case 0: return std::to_string( special[ pick( sizeof( special ) / sizeof( special[0] ) ) ] );
+                case 1: return std::to_string( 1 << pick( 15 ) );
+                default: return std::to_string( pick( 2001 ) - 1000 );
+            }
+        }
+};
+
+//! @brief Checks and times one corpus. @return false if any answer differs.
+bool measure( const Corpus & corpus_, size_t repetitions_ )
+{
+    std::vector< Program > plain, simplified;
+    SimplifyStats stats;
+    size_t mismatches = 0, before = 0, after = 0;
+
+    for ( auto i(0u); i < corpus_.postfixes.size(); ++i )
+    {
+        const auto & postfix = corpus_.postfixes[i];
+        auto expected = evaluate_postfix( postfix );
+
+        plain.push_back( compile_postfix( postfix ) );
+        simplified.push_back( plain.back() );
+        auto done = simplify_program( simplified.back() );
+        stats.removed += done.removed;
+        stats.negations += done.negations;
+        stats.reduced += done.reduced;
+        stats.folded += done.folded;
+        before += plain.back().size();
+        after += simplified.back().size();
+
+        auto marked = simplified.back();
+        mark_unchecked( marked );
+
+        std::pair< value_type,int > answers[] = {
+            execute_program( plain.back() ), execute_program( simplified.back() ), execute_program( marked ),
+            execute_threaded( decode_program( simplified.back() ) ) };
+        for ( const auto & answer : answers )
+        {
+            if ( answer == expected ) continue;
+            if ( ++mismatches <= 10 )
+                std::cerr << "\"" << corpus_.lines[i] << "\": expected (" << expected.first << ", " << expected.second
+                          << "), got (" << answer.first << ", " << answer.second << ")\n";
+            break;
+        }
+    }
+
+    volatile value_type sink = 0;
+    auto run_all = [&]( const std::vector< Program > & programs_ ){
+        return best_time( [&](){
+            for ( auto r(0u); r < repetitions_; ++r )
+                for ( const auto & p : programs_ ) sink = sink + execute_program( p ).first; } ); };
+
+    std::vector< ThreadedProgram > plain_threaded, simplified_threaded;
+    for ( const auto & p : plain ) plain_threaded.push_back( decode_program( p ) );
+    for ( const auto & p : simplified ) simplified_threaded.push_back( decode_program( p ) );
+    auto run_threaded = [&]( const std::vector< ThreadedProgram > & programs_ ){
+        return best_time( [&](){
+            for ( auto r(0u); r < repetitions_; ++r )
+                for ( const auto & p : programs_ ) sink = sink + execute_threaded( p ).first; } ); };
+
+    auto program_plain = run_all( plain ), program_simplified = run_all( simplified );
+    auto threaded_plain = run_threaded( plain_threaded ), threaded_simplified = run_threaded( simplified_threaded );
+
+    std::cout << corpus_.name << ": " << plain.size() << " expressions, " << mismatches << " mismatches\n"
+              << "  instructions " << before << " -> " << after << "; removed " << stats.removed
+              << ", negations " << stats.negations << ", reduced " << stats.reduced << ", folded " << stats.folded << "\n"
+              << std::fixed << std::setprecision( 2 )
+              << "  execute_program  " << std::setw( 9 ) << program_plain << " ms -> " << std::setw( 9 ) << program_simplified
+              << " ms (" << program_plain / program_simplified << "x)\n"
+              << "  execute_threaded " << std::setw( 9 ) << threaded_plain << " ms -> " << std::setw( 9 ) << threaded_simplified
+              << " ms (" << threaded_plain / threaded_simplified << "x)\n";
+
+    return mismatches == 0;
+}
+
+int main( int argc, char **argv )
+{
+    size_t count = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 200000;
+    size_t repetitions = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 5;
+    if ( repetitions == 0 ) return EXIT_FAILURE;
+
+    bool ok = true;
+    Generator generator( 2018 );
+    std::vector< std::string > corpus;
+    for ( auto i(0u); i < count; ++i )
+        corpus.push_back( generator.expression( 1 + i % 6 ) );
+    ok = run_corpus( "generated", corpus, measure, repetitions ) and ok;
+    ok = run_corpus_files( 3, argc, argv, measure, repetitions ) and ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
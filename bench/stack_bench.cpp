@@ -0,0 +1,148 @@
+/**
+ * @file stack_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Stack Benchmark
+ * @brief sc::stack against its previous version and std::vector.
+ *
+ * Usage: stack_bench [rounds]
+ *
+ * Each workload builds a new stack per round, as infix2postfix() and
+ * evaluate_postfix() do per expression, pushes `depth` elements, reads the
+ * top and pops them all.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../include/stack.hpp"
+#include "../include/token.hpp"
+
+namespace legacy
+{
+    //! @brief sc::stack before it moved to raw storage: `new T[]`, copy on grow, top() by value.
+    //! Its checks are assertions, as in the current one.
+    template < typename T >
+    class stack
+    {
+        private:
+            T *storage;
+            size_t size_;
+            size_t top_;
+
+            void double_storage( void )
+            {
+                T* temp = new T[ 2*size_ ];
+                for ( auto i(0u); i < top_; i++ )
+                    temp[i] = storage[i];
+                delete [] storage;
+                storage = temp;
+                size_ *= 2;
+            }
+
+        public:
+            stack( void ) : storage( new T[1] ), size_( 1 ), top_( 0 ) {}
+            ~stack( void ) { delete [] storage; }
+
+            void push( const T & value )
+            {
+                if ( size_ == top_ ) double_storage();
+                storage[ top_++ ] = value;
+            }
+            void pop( void ) { assert( not empty() ); --top_; }
+            T top( void ) const { assert( not empty() ); return storage[ top_-1 ]; }
+            bool empty( void ) const { return top_ == 0; }
+    };
+}
+
+//! @brief std::vector used as a stack.
+template < typename T >
+class vector_stack
+{
+    public:
+        void push( const T & value_ ) { v.push_back( value_ ); }
+        void pop( void ) { v.pop_back(); }
+        const T & top( void ) const { return v.back(); }
+        bool empty( void ) const { return v.empty(); }
+
+    private:
+        std::vector< T > v;
+};
+
+//! @brief sc::fixed_stack, which is told the depth up front.
+template < typename T >
+class fixed_adapter : public sc::fixed_stack< T >
+{
+    public:
+        fixed_adapter( void ) : sc::fixed_stack< T >( depth ) {}
+        static size_t depth;
+};
+template < typename T > size_t fixed_adapter< T >::depth = 0;
+
+//! @brief Milliseconds taken by `rounds_` rounds of push, top and pop on a new `Stack`.
+template < typename Stack, typename T >
+double run( size_t rounds_, size_t depth_, const T & value_, size_t & checksum_ )
+{
+    auto start = std::chrono::steady_clock::now();
+    for ( auto r(0u); r < rounds_; ++r )
+    {
+        Stack s;
+        for ( auto i(0u); i < depth_; ++i )
+            s.push( value_ );
+        while ( not s.empty() )
+        {
+            checksum_ += sizeof( s.top() ); // Reads the top, as the conversion loops do.
+            s.pop();
+        }
+    }
+    std::chrono::duration< double, std::milli > elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+//! @brief One line of the table: every container on the same workload.
+template < typename T >
+void workload( const std::string & name_, size_t rounds_, size_t depth_, const T & value_ )
+{
+    size_t checksum = 0;
+    fixed_adapter< T >::depth = depth_;
+
+    auto t_legacy = run< legacy::stack< T > >( rounds_, depth_, value_, checksum );
+    auto t_new = run< sc::stack< T > >( rounds_, depth_, value_, checksum );
+    auto t_vector = run< vector_stack< T > >( rounds_, depth_, value_, checksum );
+    auto t_fixed = run< fixed_adapter< T > >( rounds_, depth_, value_, checksum );
+
+    std::cout << std::setw( 18 ) << name_ << std::setw( 8 ) << depth_
+              << std::setw( 12 ) << t_legacy << std::setw( 12 ) << t_new
+              << std::setw( 12 ) << t_vector << std::setw( 12 ) << t_fixed
+              << std::setw( 10 ) << t_legacy / t_new << "\n";
+
+    if ( checksum == 0 ) std::cout << ""; // Keeps the loops alive.
+}
+
+int main( int argc, char **argv )
+{
+    size_t rounds = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 200000;
+
+    std::cout << std::setw( 18 ) << "workload" << std::setw( 8 ) << "depth"
+              << std::setw( 12 ) << "legacy ms" << std::setw( 12 ) << "sc ms"
+              << std::setw( 12 ) << "vector ms" << std::setw( 12 ) << "fixed ms"
+              << std::setw( 10 ) << "speedup\n";
+
+    // Typical expressions keep a few values and operators pending.
+    workload( "long int", rounds, 4, 42L );
+    workload( "long int", rounds, 16, 42L );
+    workload( "long int", rounds / 100, 4096, 42L );
+
+    Token op( "+", Token::token_t::OPERATOR, 2 );
+    Token operand( "a rather long operand that defeats SSO", Token::token_t::OPERAND );
+    workload( "Token", rounds, 4, op );
+    workload( "Token", rounds, 16, op );
+    workload( "Token (long str)", rounds / 10, 16, operand );
+    workload( "Token", rounds / 100, 4096, op );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file threaded_eval_bench.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Threaded Interpreter Benchmark
+ * @brief evaluate_postfix() against execute_program() and execute_threaded().
+ *
+ * Usage: threaded_eval_bench [repetitions] [depth] [width]
+ *
+ * Three generated corpora: short expressions like the ones in data/, deeply
+ * nested ones (`depth` parentheses) and wide flat ones (`width` operands).
+ */
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "../include/parser.hpp"
+#include "../include/infix2postfix.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/threaded_eval.hpp"
+#include "bench_util.hpp"
+
+//! @brief `count_` expressions of 2 to 24 small operands, some parenthesized.
+std::vector< std::string > short_corpus( size_t count_ )
+{
+    std::mt19937 gen( 2018 );
+    std::uniform_int_distribution< int > operands( 2, 24 ), literal( -99, 999 ), coin( 0, 9 ), op( 0, 4 );
+    const char ops[] = "+-*/%";
+
+    std::vector< std::string > corpus;
+    for ( auto i(0u); i < count_; ++i )
+    {
+        std::string expr;
+        int open = 0;
+        for ( int n = operands( gen ), k = 0; k < n; ++k )
+        {
+            if ( k > 0 ) { expr += ' '; expr += ops[ op( gen ) ]; expr += ' '; }
+            if ( coin( gen ) == 0 ) { expr += '('; ++open; }
+            expr += std::to_string( literal( gen ) );
+            if ( open > 0 and coin( gen ) < 3 ) { expr += ')'; --open; }
+        }
+        expr.append( open, ')' );
+        corpus.push_back( expr );
+    }
+    return corpus;
+}
+
+//! @brief `count_` expressions nested `depth_` times, as in "3 - (1 * (7 + (...)))".
+std::vector< std::string > deep_corpus( size_t count_, size_t depth_ )
+{
+    std::mt19937 gen( 2019 );
+    std::uniform_int_distribution< int > digit( 0, 9 ), op( 0, 2 );
+
+    std::vector< std::string > corpus;
+    for ( auto i(0u); i < count_; ++i )
+    {
+        // Each level adds at most 9 to the magnitude, so the value stays small.
+        std::string expr;
+        for ( auto d(0u); d < depth_; ++d )
+        {
+            switch ( op( gen ) )
+            {
+                case 0: expr += std::to_string( digit( gen ) ) + " - ("; break;
+                case 1: expr += std::to_string( digit( gen ) ) + " + ("; break;
+                default: expr += "1 * ("; break;
+            }
+        }
+        expr += std::to_string( digit( gen ) );
+        expr.append( depth_, ')' );
+        corpus.push_back( expr );
+    }
+    return corpus;
+}
+
+//! @brief `count_` flat sums of `width_` products, as in "3 * 4 - 7 * 2 + 5 * 9".
+std::vector< std::string > wide_corpus( size_t count_, size_t width_ )
+{
+    std::mt19937 gen( 2020 );
+    std::uniform_int_distribution< int > digit( 1, 9 );
+
+    std::vector< std::string > corpus;
+    for ( auto i(0u); i < count_; ++i )
+    {
+        // Each term is added or subtracted so the running sum goes back towards zero.
+        std::string expr;
+        long sum = 0;
+        for ( auto k(0u); k < width_; ++k )
+        {
+            int a = digit( gen ), b = digit( gen );
+            if ( k > 0 ) expr += sum > 0 ? " - " : " + ";
+            sum += ( k == 0 or sum <= 0 ) ? a * b : -a * b;
+            expr += std::to_string( a ) + " * " + std::to_string( b );
+        }
+        corpus.push_back( expr );
+    }
+    return corpus;
+}
+
+//! @brief Times one corpus on the three evaluators. @return false if they disagree.
+bool measure( const Corpus & corpus_, size_t repetitions_ )
+{
+    const auto & postfixes = corpus_.postfixes;
+    std::vector< Program > programs;
+    std::vector< ThreadedProgram > threaded;
+    size_t instructions = 0, decoded = 0;
+
+    for ( const auto & postfix : postfixes )
+    {
+        programs.push_back( compile_postfix( postfix ) );
+        threaded.push_back( decode_program( programs.back() ) );
+
+        instructions += programs.back().size();
+        decoded += threaded.back().code.size() - 1; // Without the HALT.
+    }
+
+    for ( auto i(0u); i < postfixes.size(); ++i )
+    {
+        auto expected = evaluate_postfix( postfixes[i] );
+        if ( execute_program( programs[i] ) != expected or execute_threaded( threaded[i] ) != expected )
+            return false;
+    }
+
+    volatile value_type sink;
+    auto t_classic = best_time( [&](){
+        value_type s = 0;
+        for ( auto r(0u); r < repetitions_; ++r )
+            for ( const auto & p : postfixes ) s += evaluate_postfix( p ).first;
+        sink = s; } );
+    auto t_bytecode = best_time( [&](){
+        value_type s = 0;
+        for ( auto r(0u); r < repetitions_; ++r )
+            for ( const auto & p : programs ) s += execute_program( p ).first;
+        sink = s; } );
+    auto t_threaded = best_time( [&](){
+        value_type s = 0;
+        for ( auto r(0u); r < repetitions_; ++r )
+            for ( const auto & p : threaded ) s += execute_threaded( p ).first;
+        sink = s; } );
+    (void) sink;
+
+    std::cout << std::setw( 10 ) << corpus_.name << std::setw( 8 ) << postfixes.size()
+              << std::setw( 10 ) << instructions << std::setw( 10 ) << decoded
+              << std::setw( 12 ) << t_classic << std::setw( 12 ) << t_bytecode << std::setw( 12 ) << t_threaded
+              << std::setw( 10 ) << t_classic / t_threaded << std::setw( 10 ) << t_bytecode / t_threaded << "\n";
+    return true;
+}
+
+int main( int argc, char **argv )
+{
+    size_t repetitions = argc > 1 ? std::strtoul( argv[1], nullptr, 10 ) : 20;
+    size_t depth = argc > 2 ? std::strtoul( argv[2], nullptr, 10 ) : 500;
+    size_t width = argc > 3 ? std::strtoul( argv[3], nullptr, 10 ) : 500;
+
+    std::cout << ( BARES_COMPUTED_GOTO ? "dispatch: computed goto\n" : "dispatch: switch\n" );
+    std::cout << std::setw( 10 ) << "corpus" << std::setw( 8 ) << "lines"
+              << std::setw( 10 ) << "instrs" << std::setw( 10 ) << "decoded"
+              << std::setw( 12 ) << "classic ms" << std::setw( 12 ) << "bytecode ms" << std::setw( 12 ) << "threaded ms"
+              << std::setw( 10 ) << "vs clas." << std::setw( 10 ) << "vs byte.\n";
+
+    bool ok = run_corpus( "short", short_corpus( 5000 ), measure, repetitions );
+    ok = run_corpus( "deep", deep_corpus( 200, depth ), measure, repetitions ) and ok;
+    ok = run_corpus( "wide", wide_corpus( 200, width ), measure, repetitions ) and ok;
+
+    if ( not ok )
+    {
+        std::cerr << "The evaluators gave different answers!\n";
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+// Generated by `bares header data/pdf_in.dat build/check/pdf_in.hpp`. Do not edit.
+
+#ifndef _PDF_IN_HPP_
+#define _PDF_IN_HPP_
+
+#include "bares_constexpr.hpp"
+
+namespace pdf_in
+{
+    //! Results of the lines of "data/pdf_in.dat", in order.
+    constexpr bares::Result results[] =
+    {
+        bares::evaluate( "10000000 - 2" ),
+        bares::evaluate( "2+" ),
+        bares::evaluate( "3 * d" ),
+        bares::evaluate( "2 = 3" ),
+        bares::evaluate( "2.3 + 4" ),
+        bares::evaluate( "2 * 3 4" ),
+        bares::evaluate( "2 ** 3" ),
+        bares::evaluate( "%5 * 10" ),
+        bares::evaluate( "*5 * 10" ),
+        bares::evaluate( "(2+3)*/(1-4)" ),
+        bares::evaluate( "(-3*4)(10*5)" ),
+        bares::evaluate( "2 - 4)" ),
+        bares::evaluate( "2) - 4" ),
+        bares::evaluate( ")2 - 4" ),
+        bares::evaluate( "((2%3) * 8" ),
+        bares::evaluate( "3/(1-1)" ),
+        bares::evaluate( "10/(3*3^-2)" ),
+        bares::evaluate( "20*20000" ),
+        bares::evaluate( "25   /  5 + 4 *   8" ),
+        bares::evaluate( "(2+3) * 8" ),
+        bares::evaluate( "5 % 2 ^4" ),
+        bares::evaluate( "(5 % 3) ^4" ),
+        bares::evaluate( "-----3" ),
+    };
+
+    constexpr std::size_t size = 23;
+
+    // Same results as the runtime engine.
+    static_assert( results[0].code == bares::code_t( 5 ) and results[0].at_col == 0 and results[0].eval == 0 and ( not results[0].ok() or results[0].value == 0 ), "line 1" );
+    static_assert( results[1].code == bares::code_t( 3 ) and results[1].at_col == 2 and results[1].eval == 0 and ( not results[1].ok() or results[1].value == 0 ), "line 2" );
+    static_assert( results[2].code == bares::code_t( 2 ) and results[2].at_col == 4 and results[2].eval == 0 and ( not results[2].ok() or results[2].value == 0 ), "line 3" );
+    static_assert( results[3].code == bares::code_t( 4 ) and results[3].at_col == 2 and results[3].eval == 0 and ( not results[3].ok() or results[3].value == 0 ), "line 4" );
+    static_assert( results[4].code == bares::code_t( 4 ) and results[4].at_col == 1 and results[4].eval == 0 and ( not results[4].ok() or results[4].value == 0 ), "line 5" );
+    static_assert( results[5].code == bares::code_t( 4 ) and results[5].at_col == 6 and results[5].eval == 0 and ( not results[5].ok() or results[5].value == 0 ), "line 6" );
+    static_assert( results[6].code == bares::code_t( 2 ) and results[6].at_col == 3 and results[6].eval == 0 and ( not results[6].ok() or results[6].value == 0 ), "line 7" );
+    static_assert( results[7].code == bares::code_t( 2 ) and results[7].at_col == 0 and results[7].eval == 0 and ( not results[7].ok() or results[7].value == 0 ), "line 8" );
+    static_assert( results[8].code == bares::code_t( 2 ) and results[8].at_col == 0 and results[8].eval == 0 and ( not results[8].ok() or results[8].value == 0 ), "line 9" );
+    static_assert( results[9].code == bares::code_t( 2 ) and results[9].at_col == 6 and results[9].eval == 0 and ( not results[9].ok() or results[9].value == 0 ), "line 10" );
+    static_assert( results[10].code == bares::code_t( 4 ) and results[10].at_col == 6 and results[10].eval == 0 and ( not results[10].ok() or results[10].value == 0 ), "line 11" );
+    static_assert( results[11].code == bares::code_t( 4 ) and results[11].at_col == 5 and results[11].eval == 0 and ( not results[11].ok() or results[11].value == 0 ), "line 12" );
+    static_assert( results[12].code == bares::code_t( 4 ) and results[12].at_col == 1 and results[12].eval == 0 and ( not results[12].ok() or results[12].value == 0 ), "line 13" );
+    static_assert( results[13].code == bares::code_t( 2 ) and results[13].at_col == 0 and results[13].eval == 0 and ( not results[13].ok() or results[13].value == 0 ), "line 14" );
+    static_assert( results[14].code == bares::code_t( 6 ) and results[14].at_col == 10 and results[14].eval == 0 and ( not results[14].ok() or results[14].value == 0 ), "line 15" );
+    static_assert( results[15].code == bares::code_t( 0 ) and results[15].at_col == 0 and results[15].eval == -10 and ( not results[15].ok() or results[15].value == 0 ), "line 16" );
+    static_assert( results[16].code == bares::code_t( 0 ) and results[16].at_col == 0 and results[16].eval == -10 and ( not results[16].ok() or results[16].value == 0 ), "line 17" );
+    static_assert( results[17].code == bares::code_t( 0 ) and results[17].at_col == 0 and results[17].eval == 10 and ( not results[17].ok() or results[17].value == 0 ), "line 18" );
+    static_assert( results[18].code == bares::code_t( 0 ) and results[18].at_col == 0 and results[18].eval == 0 and ( not results[18].ok() or results[18].value == 37 ), "line 19" );
+    static_assert( results[19].code == bares::code_t( 0 ) and results[19].at_col == 0 and results[19].eval == 0 and ( not results[19].ok() or results[19].value == 40 ), "line 20" );
+    static_assert( results[20].code == bares::code_t( 0 ) and results[20].at_col == 0 and results[20].eval == 0 and ( not results[20].ok() or results[20].value == 5 ), "line 21" );
+    static_assert( results[21].code == bares::code_t( 0 ) and results[21].at_col == 0 and results[21].eval == 0 and ( not results[21].ok() or results[21].value == 16 ), "line 22" );
+    static_assert( results[22].code == bares::code_t( 0 ) and results[22].at_col == 0 and results[22].eval == 0 and ( not results[22].ok() or results[22].value == -3 ), "line 23" );
+}
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file bares_constexpr_check.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Compile-time BARES Check
+ * @brief Edge cases the constexpr evaluator must answer as the runtime engine does.
+ *
+ * Only compiled, by `make check`: every expected value below is what
+ * `bares` prints for the same line. Nothing here runs.
+ */
+
+#include "bares_constexpr.hpp"
+
+namespace
+{
+    //! @brief `expr_` parses at `code_`, column `at_col_`, and evaluates to `value_` with `eval_`.
+    template < size_t N >
+    constexpr bool gives( const char ( &expr_ )[ N ], bares::code_t code_, long long at_col_, bares::value_type value_, int eval_ )
+    {
+        auto r = bares::evaluate( expr_ );
+        return r.code == code_ and r.at_col == at_col_ and r.eval == eval_ and ( not r.ok() or r.value == value_ );
+    }
+
+    constexpr auto OK = bares::code_t::OK;
+    constexpr int overflow = 10;
+    constexpr int division_by_zero = -10;
+}
+
+//=== The short int range: results must fit, literals too.
+static_assert( bares::eval( "32767" ) == 32767, "largest literal" );
+static_assert( bares::eval( "-32768" ) == -32768, "smallest literal" );
+static_assert( bares::eval( "-32767 - 1" ) == -32768, "smallest result" );
+static_assert( gives( "32767 + 1", OK, 0, 0, overflow ), "sum over the range" );
+static_assert( gives( "-32767 - 2", OK, 0, 0, overflow ), "difference under the range" );
+static_assert( gives( "20*20000", OK, 0, 0, overflow ), "product over the range" );
+static_assert( gives( "2^15", OK, 0, 0, overflow ), "power over the range" );
+static_assert( bares::eval( "2^14" ) == 16384, "largest power of two" );
+static_assert( bares::eval( "(-2)^15" ) == -32768, "negative power at the bottom of the range" );
+static_assert( gives( "10000000 - 2", bares::code_t::INTEGER_OUT_OF_RANGE, 0, 0, 0 ), "literal out of range" );
+
+//=== Division by zero, and what "/" and "%" truncate to.
+static_assert( gives( "3/(1-1)", OK, 0, 0, division_by_zero ), "division by zero" );
+static_assert( gives( "5 % 0", OK, 0, 0, division_by_zero ), "remainder by zero" );
+static_assert( gives( "0^-1", OK, 0, 0, overflow ), "zero to a negative power is infinite" );
+static_assert( bares::eval( "-7 / 2" ) == -3, "division truncates toward zero" );
+static_assert( bares::eval( "-5 % 3" ) == -2, "remainder has the sign of the dividend" );
+
+//=== "-(" becomes "-1 * (".
+static_assert( bares::eval( "-(2+3)" ) == -5, "negated scope" );
+static_assert( bares::eval( "-(-(3))" ) == 3, "nested negated scopes" );
+static_assert( bares::eval( "2 - -(3)" ) == 5, "negated scope after an operator" );
+static_assert( bares::eval( "--(1)" ) == 1, "two signs before a scope" );
+static_assert( bares::eval( "-(1)^2" ) == -1, "the power binds tighter than the -1 *" );
+
+//=== "^" is right-associative; negative exponents truncate.
+static_assert( bares::eval( "2^3^2" ) == 512, "2^(3^2)" );
+static_assert( bares::eval( "(2^3)^2" ) == 64, "scopes override it" );
+static_assert( bares::eval( "2 ^ 2 ^ 0" ) == 2, "2^(2^0)" );
+static_assert( bares::eval( "2^-1" ) == 0, "negative exponent" );
+static_assert( bares::eval( "(-1)^-3" ) == -1, "negative exponent of -1" );
+
+//=== Syntax errors and their columns.
+static_assert( gives( "2 +", bares::code_t::MISSING_TERM, 3, 0, 0 ), "missing term" );
+static_assert( gives( "((1)", bares::code_t::MISSING_CLOSING_SCOPE, 4, 0, 0 ), "missing closing scope" );
+static_assert( gives( "(1))", bares::code_t::ILL_FORMED_INTEGER, 3, 0, 0 ), "extra closing scope" );
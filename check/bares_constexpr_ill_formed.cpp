@@ -0,0 +1,14 @@
+/**
+ * @file bares_constexpr_ill_formed.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Compile-time BARES Negative Check
+ * @brief An ill-formed expression in bares::eval() must stop the compilation.
+ *
+ * `make check` expects this file to fail, naming missing_term() as the reason.
+ */
+
+#include "bares_constexpr.hpp"
+
+constexpr auto value = bares::eval( "2 +" );
@@ -0,0 +1,406 @@
+/**
+ * @file bares_constexpr.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Compile-time BARES
+ * @brief Header-only, constexpr lexer, parser and evaluator for BARES expressions.
+ *
+ * ```
+ * constexpr auto v = bares::eval( "1 + 3 * (9/2 - 3)" ); // 4, computed by the compiler.
+ * constexpr auto r = bares::evaluate( "2 +" );          // r.code == bares::code_t::MISSING_TERM
+ * ```
+ * It accepts the same grammar as Parser, with the same error codes and
+ * columns, and evaluates like evaluate_postfix(). This header depends on
+ * nothing else from the project.
+ */
+
+#ifndef _BARES_CONSTEXPR_HPP_
+#define _BARES_CONSTEXPR_HPP_
+
+#include <cstddef> // size_t
+#include <cstdlib> // std::abort
+
+namespace bares
+{
+    using value_type = long int; //!< Same as the runtime value_type.
+
+    /// @brief Same values as Parser::ResultType::code_t.
+    enum class code_t : int
+    {
+        OK = 0,
+        UNEXPECTED_END_OF_EXPRESSION,
+        ILL_FORMED_INTEGER,
+        MISSING_TERM,
+        EXTRANEOUS_SYMBOL,
+        INTEGER_OUT_OF_RANGE,
+        MISSING_CLOSING_SCOPE
+    };
+
+    /// @brief Everything the runtime engine would report for one expression.
+    struct Result
+    {
+        code_t code = code_t::OK; //!< Parsing result.
+        long long at_col = 0;     //!< Column of the parsing error (0-based).
+        value_type value = 0;     //!< The value, if parsed and evaluated successfully.
+        int eval = 0;             //!< Same as evaluate_postfix(): 0, -10 (division by zero) or 10 (overflow).
+
+        constexpr bool ok( void ) const { return code == code_t::OK and eval == 0; }
+    };
+
+    namespace detail
+    {
+        constexpr value_type short_min = -32768; //!< Range of Parser::required_int_type.
+        constexpr value_type short_max = 32767;
+
+        //! @brief Same weights the parser gives to the tokens.
+        constexpr int precedence( char op_ )
+        {
+            return op_ == '^' ? 4 : ( op_ == '*' or op_ == '/' or op_ == '%' ) ? 3 : ( op_ == '+' or op_ == '-' ) ? 2 : 1;
+        }
+
+        /// @brief execute_operator(), without its floating point pow(): second is -1 or 1 on error.
+        struct Step { value_type value; int error; };
+
+        constexpr Step execute_operator( value_type n1, value_type n2, char opr )
+        {
+            value_type r = 0;
+
+            if ( opr == '^' )
+            {
+                // pow() on doubles gives the exact integer for every result that fits a short.
+                if ( n2 < 0 )
+                {
+                    if ( n1 == 0 ) return Step{ 0, 1 }; // pow(0, -n) is infinite, out of range.
+                    r = n1 == 1 ? 1 : n1 == -1 ? ( n2 % 2 == 0 ? 1 : -1 ) : 0;
+                }
+                else
+                {
+                    r = 1;
+                    for ( value_type i = 0; i < n2; ++i )
+                    {
+                        r *= n1;
+                        if ( r < short_min or r > short_max ) return Step{ r, 1 };
+                        if ( r == 0 or r == 1 ) break;
+                        if ( r == -1 ) { r = ( n2 - i - 1 ) % 2 == 0 ? -1 : 1; break; }
+                    }
+                }
+            }
+            else if ( opr == '*' ) r = n1 * n2;
+            else if ( opr == '/' or opr == '%' )
+            {
+                if ( n2 == 0 ) return Step{ 0, -1 };
+                r = opr == '/' ? n1 / n2 : n1 % n2;
+            }
+            else if ( opr == '+' ) r = n1 + n2;
+            else r = n1 - n2;
+
+            return Step{ r, ( r < short_min or r > short_max ) ? 1 : 0 };
+        }
+
+        /*!
+         * @brief The parser and evaluator for an expression of at most `N` characters.
+         *
+         * It is StreamParser on a string: the grammar is walked iteratively,
+         * and every token goes straight into an infix to postfix conversion
+         * whose output is evaluated at once.
+         */
+        template < size_t N >
+        class Machine
+        {
+            public:
+                constexpr Machine( const char * expr_, size_t length_ ) : expr( expr_ ), length( length_ ) {}
+
+                constexpr Result run( void )
+                {
+                    Result out;
+
+                    skip_ws();
+                    if ( at_end() )
+                        return error( code_t::UNEXPECTED_END_OF_EXPRESSION );
+
+                    out = expression();
+                    if ( out.code == code_t::OK and scope_opening > scope_closing )
+                        out = error( code_t::MISSING_CLOSING_SCOPE );
+                    if ( out.code != code_t::OK )
+                        return out;
+
+                    while ( n_ops > 0 )
+                        apply_top();
+
+                    if ( not failed ) answer = Result{ code_t::OK, 0, values[ n_values - 1 ], 0 };
+                    return answer;
+                }
+
+            private:
+                // Each character makes at most one token, but "-(" makes three.
+                static constexpr size_t capacity = 2 * N + 2;
+
+                enum class kind_t { NONE, OPERAND, OPERATOR, OPENING, CLOSING };
+
+                const char * expr;
+                size_t length;
+                size_t pos = 0;
+
+                char ops[ capacity ] = {};
+                size_t n_ops = 0;
+                value_type values[ capacity ] = {};
+                size_t n_values = 0;
+
+                int scope_opening = 0;
+                int scope_closing = 0;
+                kind_t last_token = kind_t::NONE;
+                bool failed = false;
+                Result answer;
+
+                constexpr bool at_end( void ) const { return pos >= length or expr[pos] == '\0'; }
+                constexpr char current( void ) const { return at_end() ? '\0' : expr[pos]; }
+
+                constexpr void skip_ws( void )
+                {
+                    while ( current() == ' ' or current() == '\t' ) ++pos;
+                }
+
+                constexpr bool accept( char c_ )
+                {
+                    if ( at_end() or current() != c_ ) return false;
+                    ++pos;
+                    return true;
+                }
+
+                constexpr Result error( code_t code_, long long delta_ = 0 ) const
+                {
+                    return Result{ code_, static_cast< long long >( pos ) + delta_, 0, 0 };
+                }
+
+                constexpr Result expression( void )
+                {
+                    while ( true )
+                    {
+                        //--- <term>
+                        int minus = 0;
+                        while ( current() == '-' )
+                        {
+                            ++minus;
+                            ++pos;
+                        }
+                        bool has_signs = minus > 0;
+                        minus = minus % 2;
+                        skip_ws();
+
+                        if ( current() == '(' and minus != 0 )
+                        {
+                            push_operand( -1 );
+                            push_operator( '*' );
+                        }
+                        else if ( minus != 0 )
+                        {
+                            --pos;
+                        }
+                        skip_ws();
+
+                        if ( has_signs and at_end() )
+                            return error( code_t::MISSING_TERM );
+
+                        if ( accept( '(' ) )
+                        {
+                            ++scope_opening;
+                            push_opening();
+                            continue;
+                        }
+
+                        Result result;
+                        if ( current() != ')' and not at_end() )
+                        {
+                            auto begin = static_cast< long long >( pos );
+                            value_type value = 0;
+
+                            result = integer( value );
+                            if ( result.code == code_t::OK )
+                            {
+                                if ( value < short_min or value > short_max )
+                                    return Result{ code_t::INTEGER_OUT_OF_RANGE, begin, 0, 0 };
+
+                                push_operand( value );
+                            }
+                            skip_ws();
+                        }
+
+                        // It consumes sequential closing parentheses.
+                        while ( accept( ')' ) )
+                        {
+                            ++scope_closing;
+                            if ( scope_opening - scope_closing < 0 )
+                                return error( last_token == kind_t::OPERAND ? code_t::EXTRANEOUS_SYMBOL
+                                                                            : code_t::ILL_FORMED_INTEGER, -1 );
+
+                            if ( result.code == code_t::OK and
+                                 ( last_token == kind_t::OPERATOR or last_token == kind_t::OPENING ) )
+                                return error( code_t::ILL_FORMED_INTEGER, -1 );
+
+                            if ( result.code == code_t::OK )
+                                push_closing();
+                            else
+                                last_token = kind_t::CLOSING;
+
+                            skip_ws();
+                        }
+
+                        if ( result.code != code_t::OK )
+                            return result;
+
+                        //--- { operator, <term> }
+                        skip_ws();
+                        if ( at_end() )
+                            return result;
+
+                        char op = current();
+                        if ( op != '^' and op != '*' and op != '/' and op != '%' and op != '+' and op != '-' )
+                            return error( code_t::EXTRANEOUS_SYMBOL );
+
+                        ++pos;
+                        push_operator( op );
+
+                        skip_ws();
+                        if ( at_end() )
+                            return error( code_t::MISSING_TERM );
+                    }
+                }
+
+                constexpr Result integer( value_type & value_ )
+                {
+                    value_ = 0;
+                    if ( accept( '0' ) )
+                        return Result();
+
+                    bool negative = accept( '-' );
+
+                    if ( current() < '1' or current() > '9' )
+                        return error( code_t::ILL_FORMED_INTEGER );
+
+                    // Saturates just past the range: the exact value of a longer number is never needed.
+                    while ( current() >= '0' and current() <= '9' )
+                    {
+                        if ( value_ < short_max + 2 )
+                            value_ = value_ * 10 + ( current() - '0' );
+                        ++pos;
+                    }
+
+                    if ( negative ) value_ = -value_;
+                    return Result();
+                }
+
+                constexpr void push_operand( value_type value_ )
+                {
+                    last_token = kind_t::OPERAND;
+                    if ( failed ) return;
+                    values[ n_values++ ] = value_;
+                }
+
+                constexpr void push_operator( char op_ )
+                {
+                    last_token = kind_t::OPERATOR;
+                    if ( failed ) return;
+
+                    auto p = precedence( op_ );
+                    while ( n_ops > 0 )
+                    {
+                        auto top = ops[ n_ops - 1 ];
+                        auto p_top = precedence( top );
+                        if ( ( p_top == p and top == '^' ) or p_top < p ) break;
+                        apply_top();
+                    }
+                    ops[ n_ops++ ] = op_;
+                }
+
+                constexpr void push_opening( void )
+                {
+                    last_token = kind_t::OPENING;
+                    if ( failed ) return;
+                    ops[ n_ops++ ] = '(';
+                }
+
+                constexpr void push_closing( void )
+                {
+                    last_token = kind_t::CLOSING;
+                    if ( failed ) return;
+
+                    while ( ops[ n_ops - 1 ] != '(' )
+                        apply_top();
+                    --n_ops;
+                }
+
+                constexpr void apply_top( void )
+                {
+                    auto op = ops[ --n_ops ];
+                    if ( failed ) return;
+
+                    auto op2 = values[ --n_values ];
+                    auto op1 = values[ --n_values ];
+
+                    auto step = execute_operator( op1, op2, op );
+                    values[ n_values++ ] = step.value;
+
+                    if ( step.error != 0 )
+                    {
+                        failed = true;
+                        answer = Result{ code_t::OK, 0, step.value, step.error < 0 ? -10 : 10 };
+                    }
+                }
+        };
+
+        // Not constexpr on purpose: reaching one of these during constant
+        // evaluation stops the compilation, and its name tells why.
+        inline void unexpected_end_of_expression( void ) { std::abort(); }
+        inline void ill_formed_integer( void ) { std::abort(); }
+        inline void missing_term( void ) { std::abort(); }
+        inline void extraneous_symbol( void ) { std::abort(); }
+        inline void integer_out_of_range( void ) { std::abort(); }
+        inline void missing_closing_scope( void ) { std::abort(); }
+        inline void division_by_zero( void ) { std::abort(); }
+        inline void numeric_overflow( void ) { std::abort(); }
+    }
+
+    /// @brief Parses and evaluates `expr_` of `length_` characters, reporting errors in the Result.
+    template < size_t N >
+    constexpr Result evaluate( const char * expr_, size_t length_ )
+    {
+        return detail::Machine< N >( expr_, length_ < N ? length_ : N ).run();
+    }
+
+    /// @brief Parses and evaluates a string literal, reporting errors in the Result.
+    template < size_t N >
+    constexpr Result evaluate( const char ( &expr_ )[ N ] )
+    {
+        return evaluate< N >( expr_, N - 1 );
+    }
+
+    /*!
+     * @brief The value of a string literal expression.
+     *
+     * In a constant expression any parsing or evaluation error is a
+     * compilation error, naming the error. At run time it aborts instead.
+     */
+    template < size_t N >
+    constexpr value_type eval( const char ( &expr_ )[ N ] )
+    {
+        auto r = evaluate( expr_ );
+
+        switch ( r.code )
+        {
+            case code_t::UNEXPECTED_END_OF_EXPRESSION: detail::unexpected_end_of_expression(); break;
+            case code_t::ILL_FORMED_INTEGER: detail::ill_formed_integer(); break;
+            case code_t::MISSING_TERM: detail::missing_term(); break;
+            case code_t::EXTRANEOUS_SYMBOL: detail::extraneous_symbol(); break;
+            case code_t::INTEGER_OUT_OF_RANGE: detail::integer_out_of_range(); break;
+            case code_t::MISSING_CLOSING_SCOPE: detail::missing_closing_scope(); break;
+            case code_t::OK: break;
+        }
+        if ( r.eval < 0 ) detail::division_by_zero();
+        if ( r.eval > 0 ) detail::numeric_overflow();
+
+        return r.value;
+    }
+}
+
+#endif
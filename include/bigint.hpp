@@ -0,0 +1,78 @@
+/**
+ * @file bigint.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Big Integer Lib
+ * @brief Arbitrary-precision signed integers.
+ */
+
+#ifndef _BIGINT_HPP_
+#define _BIGINT_HPP_
+
+#include <cstdint> // std::uint32_t
+#include <string>  // std::string
+#include <vector>  // std::vector
+
+/*!
+ * @brief A signed integer of any size.
+ *
+ * The magnitude is kept in base 2^32, least significant limb first and
+ * without leading zero limbs (zero has no limbs). Division truncates
+ * toward zero and the remainder takes the sign of the dividend, like the
+ * built-in `/` and `%`. Multiplication switches to Karatsuba on long operands.
+ */
+class BigInt
+{
+    public:
+        //==== Aliases
+        typedef std::uint32_t limb_type;          //!< One digit in base 2^32.
+        typedef std::vector< limb_type > mag_type; //!< A magnitude.
+
+        //==== Special methods
+        /// @brief Zero.
+        BigInt() = default;
+
+        /// @brief Converts a built-in integer.
+        explicit BigInt( long long value_ );
+
+        //==== Queries
+        bool is_zero( void ) const { return mag.empty(); }
+        bool is_negative( void ) const { return negative; }
+
+        /// @return The number of bits of the magnitude (0 for zero).
+        size_t bit_length( void ) const;
+
+        /// @return true if the value fits a `long long`.
+        bool fits_int64( void ) const;
+
+        /// @return The value as a `long long`; it must fit (see fits_int64()).
+        long long to_int64( void ) const;
+
+        /// @return The exact value in decimal.
+        std::string to_string( void ) const;
+
+        //==== Arithmetic
+        BigInt operator-( void ) const;
+        friend BigInt operator+( const BigInt & a_, const BigInt & b_ );
+        friend BigInt operator-( const BigInt & a_, const BigInt & b_ );
+        friend BigInt operator*( const BigInt & a_, const BigInt & b_ );
+
+        /// @brief Truncating division: `q_ = a_ / b_` and `r_ = a_ % b_`. `b_` must not be zero.
+        static void divmod( const BigInt & a_, const BigInt & b_, BigInt & q_, BigInt & r_ );
+
+        /// @return This value raised to `exponent_`, by repeated squaring.
+        BigInt pow( unsigned long long exponent_ ) const;
+
+        /// @return <0, 0 or >0 as `a_` is smaller, equal or greater than `b_`.
+        friend int compare( const BigInt & a_, const BigInt & b_ );
+
+    private:
+        bool negative = false; //!< Sign; zero is never negative.
+        mag_type mag;          //!< Magnitude.
+
+        //! @brief Builds a value from a sign and a magnitude, fixing the sign of zero.
+        BigInt( bool negative_, mag_type && mag_ );
+};
+
+#endif
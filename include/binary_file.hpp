@@ -0,0 +1,135 @@
+/**
+ * @file binary_file.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Binary Expression File Lib
+ * @brief Pre-compiled expression files, read back through mmap.
+ *
+ * Layout (host byte order, every section aligned to 8 bytes):
+ * ```
+ *   BinaryHeader
+ *   record 0: RecordHeader, source text, program (Instruction[])
+ *   record 1: ...
+ *   index: std::uint64_t offset of each record
+ * ```
+ * A record keeps the parse result of one input line. Its program is empty
+ * unless the line parsed successfully.
+ */
+
+#ifndef _BINARY_FILE_HPP_
+#define _BINARY_FILE_HPP_
+
+#include <cstddef>  // size_t
+#include <cstdint>  // std::uint64_t ...
+#include <fstream>  // std::ofstream
+#include <string>   // std::string
+#include <vector>   // std::vector
+
+#include "bytecode.hpp"
+#include "parser.hpp"
+
+//! @brief First bytes of every binary expression file.
+constexpr char binary_magic[8] = { 'B', 'A', 'R', 'E', 'S', 'B', 'I', 'N' };
+
+//! @brief Bumped whenever the layout changes. Version 2 programs may hold the unary opcodes;
+//! from version 3 on, unchecked_flag is only set where mark_unchecked() proves it. Version 4
+//! records keep the counts of Parser::Limits.
+constexpr std::uint32_t binary_version = 4;
+
+//! @brief Oldest version still read: earlier records are shorter, and lack their LineCounts.
+constexpr std::uint32_t binary_min_version = 4;
+
+/// @brief Start of a binary expression file.
+struct BinaryHeader
+{
+    char magic[8];               //!< Always binary_magic.
+    std::uint32_t version;       //!< Layout version, see binary_version.
+    std::uint32_t reserved;      //!< Always 0.
+    std::uint64_t record_count;  //!< Number of records (input lines).
+    std::uint64_t index_offset;  //!< Where the record offsets start.
+};
+
+/// @brief What Parser::Limits measure of a line, so its record is held to the same budgets.
+struct LineCounts
+{
+    std::uint64_t tokens = 0;       //!< Tokens, the ones added for "-(" included (max_tokens).
+    std::uint64_t steps = 0;        //!< Operator tokens (max_steps).
+    std::uint64_t depth = 0;        //!< Most parentheses open at once (max_depth).
+};
+
+/// @brief Start of a record.
+struct RecordHeader
+{
+    std::int64_t at_col;            //!< Column of the parsing error, if any.
+    std::uint32_t source_length;    //!< Bytes of source text that follow.
+    std::uint32_t program_length;   //!< Instructions that follow the text.
+    LineCounts counts;              //!< Counts of the line, as far as it was parsed.
+    std::uint8_t code;              //!< A Parser::ResultType::code_t.
+    std::uint8_t reserved[7];       //!< Always 0.
+};
+
+/// @brief A record, pointing into the mapped file.
+struct BinaryRecord
+{
+    Parser::ResultType result;   //!< Parse result of the line.
+    LineCounts counts;           //!< Counts of the line, as far as it was parsed.
+    const char * source;         //!< The line, not null terminated.
+    size_t source_length;        //!< Length of `source`.
+    const Instruction * program; //!< Compiled expression.
+    size_t program_length;       //!< Instructions in `program`.
+};
+
+/// @brief Writes a binary expression file, one record at a time.
+class BinaryWriter
+{
+    public:
+        /// @brief Creates the file and reserves room for its header.
+        bool open( const std::string & path_ );
+
+        /// @brief Appends the record of one input line. @return false, writing nothing, if its lengths don't fit the record.
+        bool append( const Parser::ResultType & result_, const std::string & source_, const Program & program_,
+                     const LineCounts & counts_ = LineCounts() );
+
+        /// @brief Writes the index and the header. @return true if every write succeeded.
+        bool close( void );
+
+    private:
+        std::ofstream ofs;                     //!< The file being written.
+        std::vector< std::uint64_t > offsets;  //!< Where each record starts.
+        std::uint64_t position = 0;            //!< Bytes written so far.
+
+        //! @brief Writes zeros until `position` is a multiple of 8.
+        void pad( void );
+};
+
+/// @brief Maps a binary expression file and gives random access to its records.
+class BinaryReader
+{
+    public:
+        BinaryReader() = default;
+        ~BinaryReader();
+
+        BinaryReader( const BinaryReader & ) = delete;
+        BinaryReader & operator=( const BinaryReader & ) = delete;
+
+        /// @brief Maps the file and checks its header, index and programs. @return false on any problem.
+        bool open( const std::string & path_ );
+
+        /// @return The number of records.
+        size_t size( void ) const { return count; }
+
+        /// @return The record `i_` (which must be smaller than size()).
+        BinaryRecord record( size_t i_ ) const;
+
+    private:
+        const char * data = nullptr;          //!< Start of the mapping.
+        size_t length = 0;                    //!< Size of the mapping.
+        const std::uint64_t * index = nullptr; //!< Offsets of the records.
+        size_t count = 0;                     //!< Number of records.
+};
+
+/// @return true if the file `path_` starts with binary_magic.
+bool is_binary_file( const std::string & path_ );
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ * @file bytecode.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Bytecode Lib
+ * @brief Compiled form of a postfix expression.
+ */
+
+#ifndef _BYTECODE_HPP_
+#define _BYTECODE_HPP_
+
+#include <cstdint>     // std::uint8_t, std::int16_t
+#include <limits>      // std::numeric_limits
+#include <string>      // std::string
+#include <type_traits> // std::make_unsigned
+#include <utility>     // std::pair
+#include <vector>      // std::vector
+
+#include "infix2postfix.hpp"
+
+/// @brief Operations of a compiled postfix expression.
+enum class opcode_t : std::uint8_t
+{
+    PUSH = 0, //!< Pushes the instruction operand.
+    ADD,      //!< "+"
+    SUB,      //!< "-"
+    MUL,      //!< "*"
+    DIV,      //!< "/"
+    MOD,      //!< "%"
+    POW,      //!< "^"
+
+    // Operations on the top value only, made by simplify_program(); `operand` is their k.
+    NEG,      //!< Negates it.
+    SHL,      //!< Multiplies it by 2^k.
+    DIV2,     //!< Divides it by 2^k, truncating as "/" does.
+    MOD2,     //!< Remainder of its division by 2^k, with its sign, as "%" gives.
+    SQR       //!< Squares it.
+};
+
+/// @return true for the operations that take a single value, from opcode_t::NEG on.
+inline bool is_unary( opcode_t op_ )
+{
+    return op_ >= opcode_t::NEG;
+}
+
+/*!
+ * Values are `short int` results, so these shifts can't lose bits. They
+ * are made on the unsigned type, where shifting negative values is defined.
+ */
+/// @brief `value_ * 2^k_`.
+inline value_type shift_left( value_type value_, int k_ )
+{
+    return static_cast< value_type >( static_cast< std::make_unsigned< value_type >::type >( value_ ) << k_ );
+}
+
+/// @brief `value_ / 2^k_`, truncating: negative dividends are biased by 2^k - 1 before the arithmetic shift.
+inline value_type divide_pow2( value_type value_, int k_ )
+{
+    value_type bias = ( value_ >> std::numeric_limits< value_type >::digits ) & ( ( value_type( 1 ) << k_ ) - 1 );
+    return ( value_ + bias ) >> k_;
+}
+
+/// @brief `value_ % 2^k_`, with the sign of `value_`.
+inline value_type remainder_pow2( value_type value_, int k_ )
+{
+    return value_ - shift_left( divide_pow2( value_, k_ ), k_ );
+}
+
+/*!
+ * @brief One step of a compiled postfix expression.
+ *
+ * Operands always fit in a `short int`, since the parser rejects anything
+ * else, so an instruction takes four bytes. This is also its layout in the
+ * binary expression files.
+ */
+struct Instruction
+{
+    opcode_t op;          //!< What to do.
+    std::uint8_t flags;   //!< Bit set of instruction flags, such as unchecked_flag.
+    std::int16_t operand; //!< Value pushed by opcode_t::PUSH.
+};
+
+static_assert( sizeof( Instruction ) == 4, "Instruction is stored as is in binary files." );
+
+//! The operation is known never to overflow nor divide by zero, so it runs without checks.
+constexpr std::uint8_t unchecked_flag = 1u << 0;
+
+/// @brief How many operations a program ran with and without their range checks.
+struct CheckCounters
+{
+    std::uint64_t performed = 0; //!< Operations checked for overflow and division by zero.
+    std::uint64_t skipped = 0;   //!< Operations run unchecked (see unchecked_flag).
+};
+
+using Program = std::vector< Instruction >; //!< A compiled postfix expression.
+
+/// @return The operator symbol ("+-*/%^") of a binary opcode.
+char symbol_of( opcode_t op_ );
+
+/// @brief Translates a postfix expression, as built by infix2postfix(), into a program.
+Program compile_postfix( const std::vector< std::string > & postfix_ );
+
+/// @brief Says if the program in [first_, last_) can be run, as read from a file that may be corrupt.
+/*!
+ * Every opcode must be known, the shifts of the unary operations between
+ * 0 and 15, other operations without operand, and the stack must never
+ * run short and end with exactly one value.
+ */
+bool is_valid_program( const Instruction * first_, const Instruction * last_ );
+
+/// @brief Applies the unary operation `ins_` to `value_`, without any range check.
+value_type execute_unary( value_type value_, const Instruction & ins_ );
+
+/// @brief Runs the program in [first_, last_). Gives the same result as evaluate_postfix().
+/*!
+ * Operations with unchecked_flag skip the range and zero divisor checks.
+ * If `counters_` is given, the checks performed and skipped are added to it.
+ */
+std::pair< value_type,int > execute_program( const Instruction * first_, const Instruction * last_,
+                                             CheckCounters * counters_ = nullptr );
+
+/// @brief Runs a whole program. Gives the same result as evaluate_postfix().
+std::pair< value_type,int > execute_program( const Program & program_, CheckCounters * counters_ = nullptr );
+
+#endif
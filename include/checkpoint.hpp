@@ -0,0 +1,79 @@
+/**
+ * @file checkpoint.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Checkpoint Lib
+ * @brief Progress of a run, saved so an interrupted run can resume.
+ */
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <cstddef> // size_t
+#include <cstdint> // std::uint64_t
+#include <string>  // std::string
+
+//! @brief First bytes of every checkpoint file.
+constexpr char checkpoint_magic[8] = { 'B', 'A', 'R', 'E', 'S', 'C', 'K', 'P' };
+
+//! @brief Bumped whenever the layout changes.
+constexpr std::uint32_t checkpoint_version = 1;
+
+/*!
+ * @brief Everything needed to pick a run up where it stopped.
+ *
+ * The first fields say which run it is: a checkpoint is only used by a
+ * run with the same arguments and the same input file. The others say how
+ * far it got; they are saved at line boundaries only.
+ */
+struct Checkpoint
+{
+    char magic[8];                   //!< Always checkpoint_magic.
+    std::uint32_t version;           //!< Always checkpoint_version.
+    std::uint32_t reserved;          //!< Always 0.
+
+    //=== Which run.
+    std::uint64_t args_hash;         //!< fnv1a() of the command line arguments.
+    std::uint64_t input_size;        //!< Size of the input file.
+    std::uint64_t input_mtime;       //!< Its modification time, in nanoseconds.
+
+    //=== How far it got.
+    std::uint64_t line;              //!< Lines done.
+    std::uint64_t input_offset;      //!< Where the next line starts.
+    std::uint64_t output_offset;     //!< Bytes of output written for the lines done.
+    std::uint64_t rejected;          //!< `--stats` counters, so far.
+    std::uint64_t checks_performed;
+    std::uint64_t checks_skipped;
+
+    std::uint64_t checksum;          //!< FNV-1a of all the fields above.
+};
+
+/// @brief A checkpoint of no progress for the run with `args_hash_` on the input `in_file_`.
+/// @return false if the input file can't be inspected.
+bool new_checkpoint( std::uint64_t args_hash_, const std::string & in_file_, Checkpoint & ckp_ );
+
+/// @brief FNV-1a hash of a range of bytes, continuing from `hash_`.
+std::uint64_t fnv1a( const void * data_, size_t length_, std::uint64_t hash_ = 0xcbf29ce484222325ull );
+
+/// @brief Reads the checkpoint at `path_`. @return false if there is none or it is damaged.
+bool load_checkpoint( const std::string & path_, Checkpoint & ckp_ );
+
+/// @brief Replaces the checkpoint at `path_` atomically, once `ckp_` is on disk. @return false on any error.
+bool save_checkpoint( const std::string & path_, Checkpoint ckp_ );
+
+/// @brief Says if `saved_` was made by the run that `current_` describes.
+bool same_run( const Checkpoint & saved_, const Checkpoint & current_ );
+
+/// @brief Resumes from the checkpoint at `path_` if it belongs to the run `current_` describes.
+/*!
+ * The output file `out_file_` is cut back to the size it had at the
+ * checkpoint, and `current_` takes the saved progress.
+ * @return false if the run has to start over.
+ */
+bool resume_checkpoint( const std::string & path_, const std::string & out_file_, Checkpoint & current_ );
+
+/// @brief Flushes the file at `path_` from the page cache to the disk. @return false on any error.
+bool sync_file( const std::string & path_ );
+
+#endif
@@ -0,0 +1,71 @@
+/**
+ * @file exact_eval.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Exact Evaluation Lib
+ * @brief Evaluates postfix expressions without the `short int` range limit.
+ */
+
+#ifndef _EXACT_EVAL_HPP_
+#define _EXACT_EVAL_HPP_
+
+#include <ostream> // std::ostream
+#include <string>  // std::string
+#include <utility> // std::pair
+#include <vector>  // std::vector
+
+#include "bigint.hpp"
+#include "infix2postfix.hpp"
+
+//! Results longer than this many bits are reported as a numeric overflow.
+constexpr size_t max_exact_bits = 1u << 20;
+
+/*!
+ * @brief An exact integer: a `long long` while it fits, a BigInt after that.
+ *
+ * Arithmetic is done on the machine word with checked operations, and only
+ * the operations that overflow it are redone on BigInt. A result that fits
+ * the word again goes back to it.
+ */
+class ExactValue
+{
+    public:
+        /// @brief A machine-word value.
+        ExactValue( long long value_ = 0 ) : word( value_ ) { /* empty */ }
+
+        /// @brief A value of any size; it is kept as a word if it fits one.
+        explicit ExactValue( BigInt value_ );
+
+        bool is_word( void ) const { return not is_big; }
+        long long to_word( void ) const { return word; }
+
+        /// @return The value as a BigInt, whatever its size.
+        BigInt to_big( void ) const { return is_big ? big : BigInt( word ); }
+
+        /// @return The exact value in decimal.
+        std::string to_string( void ) const { return is_big ? big.to_string() : std::to_string( word ); }
+
+    private:
+        bool is_big = false; //!< Which of the members below holds the value.
+        long long word;      //!< The value, while it fits a word.
+        BigInt big;          //!< The value, once it does not.
+};
+
+inline std::ostream & operator<<( std::ostream & os_, const ExactValue & value_ )
+{
+    return os_ << value_.to_string();
+}
+
+/// @brief Exact version of execute_operator(): second is -1 on division by zero, 1 past max_exact_bits.
+/*!
+ * `/` and `%` truncate toward zero. For `^` a negative exponent gives the
+ * integer part of the power: 1 or -1 for a base of 1 or -1, 0 for any other
+ * base but 0, for which it is a division by zero.
+ */
+std::pair< ExactValue,int > execute_operator_exact( const ExactValue & n1, const ExactValue & n2, char opr );
+
+/// @brief Exact version of evaluate_postfix(), with the same error codes.
+std::pair< ExactValue,int > evaluate_postfix_exact( const std::vector< std::string > & postfix_ );
+
+#endif
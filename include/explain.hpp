@@ -0,0 +1,86 @@
+/**
+ * @file explain.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Explain Lib
+ * @brief Cost profile of a single expression: its shape, and the time of each phase and engine.
+ */
+
+#ifndef _EXPLAIN_HPP_
+#define _EXPLAIN_HPP_
+
+#include <cstddef> // size_t
+#include <string>  // std::string
+#include <utility> // std::pair
+
+#include "parser.hpp"
+#include "infix2postfix.hpp"
+
+//! @brief Runs of each phase timed by `--explain`, by default.
+constexpr size_t default_explain_repetitions = 101;
+
+/// @brief Time of a phase, in nanoseconds per run.
+struct PhaseTime
+{
+    double median = 0; //!< Middle of the repeated runs.
+    double best = 0;   //!< Fastest of them.
+};
+
+/// @brief The engines an expression can be evaluated with.
+enum class engine_t
+{
+    CLASSIC,  //!< Parser, infix2postfix() and evaluate_postfix().
+    FUSED,    //!< StreamParser: parsing, conversion and evaluation in one pass.
+    COMPILED  //!< Parser, infix2postfix(), a simplified program and execute_threaded().
+};
+
+/// @return The name of `engine_`, as `--explain` prints it.
+const char * engine_name( engine_t engine_ );
+
+/*!
+ * @brief What explain_expression() found out about an expression.
+ *
+ * The counts come from the parser, which knows the stacks' peaks before
+ * they are used. If the expression has a syntax error only `result`,
+ * `bytes`, `tokens` (so far) and `parse` are filled in.
+ */
+struct Explanation
+{
+    Parser::ResultType result;        //!< Parsing result.
+    size_t bytes = 0;                 //!< Length of the line.
+    size_t tokens = 0;                //!< Tokens, the ones added for "-(" included.
+    size_t nesting = 0;               //!< Most parentheses open at once.
+    size_t unary_rewrites = 0;        //!< "-(" turned into "-1 * (".
+    size_t postfix_length = 0;        //!< Entries of the postfix expression.
+    StackDepth stack_peak;            //!< Peaks of the infix2postfix() and evaluate_postfix() stacks.
+    size_t instructions = 0;          //!< Instructions of the simplified program.
+    std::pair< value_type,int > answer; //!< The result, the same for every engine.
+    bool engines_agree = true;        //!< Whether the three engines gave that same answer.
+
+    PhaseTime parse;                  //!< Parser::parse().
+    PhaseTime infix2postfix;          //!< infix2postfix().
+    PhaseTime evaluate;               //!< evaluate_postfix().
+    PhaseTime fused;                  //!< StreamParser::parse(), from the text to the answer.
+    PhaseTime compile;                //!< compile_postfix(), simplify_program() and decode_program().
+    PhaseTime execute;                //!< execute_threaded().
+
+    engine_t fastest = engine_t::CLASSIC;        //!< Quickest from the text to the answer, once.
+    engine_t fastest_reused = engine_t::CLASSIC; //!< Quickest to evaluate again, keeping what each engine can keep.
+
+    /// @return Median nanoseconds of `engine_` from the text to the answer.
+    double engine_time( engine_t engine_ ) const;
+
+    /// @return Median nanoseconds of `engine_` evaluating again: postfix and program are kept, the fused engine keeps nothing.
+    double reused_time( engine_t engine_ ) const;
+};
+
+/*!
+ * @brief Profiles `expression_`, timing each phase over `repetitions_` runs.
+ *
+ * Fast phases are run in batches, so each timed sample is long enough
+ * for the clock; times are per run.
+ */
+Explanation explain_expression( const std::string & expression_, const Parser::Limits & limits_, size_t repetitions_ );
+
+#endif
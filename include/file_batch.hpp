@@ -0,0 +1,76 @@
+/**
+ * @file file_batch.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title File Batch Lib
+ * @brief Many input files evaluated at once, in chunks, on a work-stealing pool.
+ */
+
+#ifndef _FILE_BATCH_HPP_
+#define _FILE_BATCH_HPP_
+
+#include <cstddef>    // size_t
+#include <cstdint>    // std::uint64_t
+#include <functional> // std::function
+#include <string>     // std::string
+#include <vector>     // std::vector
+
+#include "parser.hpp"
+#include "thread_pool.hpp"
+
+//! @brief Files larger than this are split into chunks of about this size, by default.
+constexpr size_t default_split_size = 1u << 20;
+
+//! @brief An input file and the output file of its answers.
+struct BatchFile
+{
+    std::string input;
+    std::string output;
+};
+
+//! @brief What process_files() did.
+struct BatchStats
+{
+    size_t files = 0;                 //!< Files whose output was written completely.
+    size_t chunks = 0;                //!< Pieces those files were evaluated in.
+    size_t lines = 0;                 //!< Expressions evaluated.
+    std::vector< std::string > failed; //!< Inputs that could not be read, or whose output could not be written.
+};
+
+/*!
+ * @brief Appends the output of the expression `line_` to `out_`, newline included.
+ *
+ * Called by several workers at once, each with its own parser.
+ */
+typedef std::function< void( Parser & parser_, const std::string & line_, std::string & out_ ) > line_evaluator;
+
+/// @brief Reads a manifest: one `<input> [<output>]` per line, blank lines skipped.
+/*!
+ * A file without an output goes to `<out_dir_>/<name of the input>`.
+ * @return false if the manifest can't be read or two files share an output.
+ */
+bool read_manifest( const std::string & path_, const std::string & out_dir_, std::vector< BatchFile > & files_ );
+
+/// @brief Lists the regular files of the directory `dir_`, by name, each going to `<out_dir_>/<name>`.
+/// @return false if the directory can't be read.
+bool list_directory( const std::string & dir_, const std::string & out_dir_, std::vector< BatchFile > & files_ );
+
+/*!
+ * @brief Evaluates every line of every file of `files_` on `pool_`.
+ *
+ * Files over `split_size_` bytes are split into chunks at line
+ * boundaries, so the workers that run out of files steal the chunks of
+ * the large ones instead of waiting for them. The largest files start
+ * first. The output of each file is written in the order of its lines,
+ * whatever order its chunks finish in. Gzip files are decompressed and
+ * evaluated by a single task each, since they can't be split.
+ *
+ * A file is opened once, when its first task runs, and closed after its
+ * last chunk is written; the parsers and the buffers of a chunk go back
+ * to a free list and are reused by the next one.
+ */
+BatchStats process_files( const std::vector< BatchFile > & files_, ThreadPool & pool_, const Parser::Limits & limits_,
+                          const line_evaluator & evaluate_, size_t split_size_ = default_split_size );
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * @file gzip_stream.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Gzip Stream Lib
+ * @brief Stream buffers that read and write gzip files through zlib.
+ */
+
+#ifndef _GZIP_STREAM_HPP_
+#define _GZIP_STREAM_HPP_
+
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // size_t
+#include <mutex>              // std::mutex
+#include <streambuf>          // std::streambuf
+#include <string>             // std::string
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+#include <zlib.h>
+
+//! @brief Bytes of decompressed text handed to the reader at a time.
+constexpr size_t default_gzip_block = 1u << 18;
+
+//! @brief Blocks decompressed ahead of the reader, at most.
+constexpr size_t gzip_blocks_ahead = 4;
+
+/// @brief Says if the file at `path_` starts with the gzip magic bytes.
+bool is_gzip_file( const std::string & path_ );
+
+/*!
+ * @brief Input stream buffer over a gzip file.
+ *
+ * A thread of its own decompresses blocks ahead of the reader, into a
+ * ring of gzip_blocks_ahead buffers, so decompression overlaps with
+ * whatever the reader does with the text. Files made of several gzip
+ * members, as `cat a.gz b.gz` gives, are read as one; zeros padding the
+ * end of the file are skipped.
+ * ```
+ * GzipReader gz;
+ * gz.open( "in.dat.gz" );
+ * std::istream is( &gz );
+ * ```
+ */
+class GzipReader : public std::streambuf
+{
+    public:
+        /// @brief A reader that decompresses `block_size_` bytes at a time, on its own thread if `threaded_`.
+        explicit GzipReader( size_t block_size_ = default_gzip_block, bool threaded_ = true );
+
+        /// @brief Stops the decompression thread and closes the file.
+        ~GzipReader();
+
+        GzipReader( const GzipReader & ) = delete;
+        GzipReader & operator=( const GzipReader & ) = delete;
+
+        /// @brief Opens the gzip file at `path_` and starts decompressing. @return false if it can't be opened.
+        bool open( const std::string & path_ );
+
+        /// @brief Says if the input turned out unreadable, corrupt or truncated; the text ends where that was found.
+        bool failed( void ) const { return error; }
+
+    protected:
+        int_type underflow( void ) override;
+
+    private:
+        //! @brief A buffer of decompressed text.
+        struct Block
+        {
+            std::vector< char > data;
+            size_t size = 0;
+        };
+
+        int fd = -1;
+        z_stream zs;
+        bool zs_ready = false;                 //!< Whether inflateInit2() was called.
+        std::vector< char > compressed;        //!< Bytes read from the file, not inflated yet.
+        bool input_end = false;                //!< The file was read to its end.
+        bool in_member = false;                //!< Inside a gzip member that has not ended yet.
+        bool padding = false;                  //!< Past the last member, in zeros that pad the file.
+        std::atomic< bool > error{ false };
+
+        size_t block_size;
+        bool threaded;
+        std::vector< Block > blocks;           //!< A ring, or a single buffer without the thread.
+        std::thread worker;
+
+        std::mutex lock;                       //!< Guards the ring state below.
+        std::condition_variable not_empty;     //!< A block was filled, or decompression ended.
+        std::condition_variable not_full;      //!< A block was given back, or the reader is closing.
+        size_t head = 0;                       //!< Next block to fill.
+        size_t tail = 0;                       //!< Oldest filled block.
+        size_t count = 0;                      //!< Filled blocks, the one being read included.
+        bool holding = false;                  //!< The reader is on blocks[tail].
+        bool done = false;                     //!< Nothing more will be filled.
+        bool stopping = false;                 //!< Set by the destructor.
+
+        /// @brief Decompresses up to block_size bytes into `out_`. @return Bytes made; 0 at the end or on error.
+        size_t inflate_block( char * out_ );
+
+        /// @brief Main loop of the decompression thread.
+        void decompress_ahead( void );
+};
+
+/*!
+ * @brief Output stream buffer that writes a gzip file.
+ *
+ * Text is compressed a buffer at a time; close() ends the gzip stream.
+ */
+class GzipWriter : public std::streambuf
+{
+    public:
+        /// @brief A writer that compresses `buffer_size_` bytes at a time.
+        explicit GzipWriter( size_t buffer_size_ = default_gzip_block );
+
+        /// @brief Ends the gzip stream if close() was not called.
+        ~GzipWriter();
+
+        GzipWriter( const GzipWriter & ) = delete;
+        GzipWriter & operator=( const GzipWriter & ) = delete;
+
+        /// @brief Creates the gzip file at `path_`, compressed at `level_` (1 to 9). @return false on any error.
+        bool open( const std::string & path_, int level_ = Z_DEFAULT_COMPRESSION );
+
+        /// @brief Compresses what is left, ends the gzip stream and closes the file. @return false on any error.
+        bool close( void );
+
+    protected:
+        int_type overflow( int_type c_ ) override;
+        int sync( void ) override;
+
+    private:
+        int fd = -1;
+        z_stream zs;
+        bool zs_ready = false;             //!< Whether deflateInit2() was called.
+        std::vector< char > buffer;        //!< Text not compressed yet.
+        std::vector< char > compressed;    //!< Output of deflate().
+        bool error = false;
+
+        /// @brief Compresses the buffered text with `flush_` and writes the result. @return false on any error.
+        bool deflate_buffer( int flush_ );
+};
+
+#endif
@@ -18,6 +18,14 @@
 #include "token.hpp"
 
 using value_type = long int; //!< To change type. (Optional)
+using postfix_iterator = std::vector< std::string >::const_iterator; //!< Walks a postfix expression.
+
+/// @brief The largest sizes the conversion and evaluation stacks reach for one expression.
+struct StackDepth
+{
+    size_t operators = 0; //!< Operators and "(" waiting in infix2postfix().
+    size_t values = 0;    //!< Operands waiting in evaluate_postfix().
+};
 
 /// @brief Sees if you are looking at '^' operator.
 bool is_right_association( const Token & op );
@@ -25,14 +33,29 @@ bool is_right_association( const Token & op );
 /// @brief Says if the first operator is bigger than the second operator.
 bool has_higher_precedence( const Token & op1, const Token & op2 );
 
+/// @brief Tells operators apart from (possibly negative) operands in a postfix expression.
+bool is_operator_entry( const std::string & entry_ );
+
 /// @brief Converts a expression in infix notation to a corresponding profix representation.
 std::vector< std::string > infix2postfix( std::vector< Token > infix_ );
 
+/// @brief Same conversion, on a stack allocated once with the exact depth the expression needs.
+std::vector< std::string > infix2postfix( const std::vector< Token > & infix_, const StackDepth & depth_ );
+
 /// @brief Execute the binary operator on two operands and return the result.
 std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std::string opr );
 
+/// @brief Execute the binary operator, given by its symbol, on two operands and return the result.
+std::pair< value_type,int > execute_operator( value_type n1, value_type n2, char opr );
+
 /// @brief Change an infix expression into its corresponding postfix representation.
 std::pair< value_type,int > evaluate_postfix( std::vector< std::string > postfix_ );
 
+/// @brief Same evaluation, on a stack allocated once with the exact depth the expression needs.
+std::pair< value_type,int > evaluate_postfix( const std::vector< std::string > & postfix_, const StackDepth & depth_ );
+
+/// @brief Evaluates the postfix entries in [first_, last_), which must form a whole subexpression.
+std::pair< value_type,int > evaluate_postfix( postfix_iterator first_, postfix_iterator last_ );
+
 #endif
 
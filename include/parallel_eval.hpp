@@ -0,0 +1,39 @@
+/**
+ * @file parallel_eval.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Parallel Evaluation Lib
+ * @brief Evaluates one large postfix expression on a thread pool.
+ */
+
+#ifndef _PARALLEL_EVAL_HPP_
+#define _PARALLEL_EVAL_HPP_
+
+#include <string>  // std::string
+#include <utility> // std::pair
+#include <vector>  // std::vector
+
+#include "infix2postfix.hpp"
+#include "thread_pool.hpp"
+
+//! Postfix expressions shorter than this stay on the sequential path.
+constexpr size_t default_parallel_threshold = 1u << 16;
+
+/// @brief Evaluates a postfix expression splitting it into independent subtrees.
+/*!
+ * The expression tree is cut into maximal subtrees that are small enough
+ * to be evaluated sequentially. Those run on `pool_`, and the operators left
+ * above them are applied afterwards in postfix order. The reported error is
+ * the same one evaluate_postfix() would find first, from left to right.
+ *
+ * @param postfix_ The postfix expression, as produced by infix2postfix().
+ * @param pool_ Where the subtrees are evaluated.
+ * @param threshold_ Expressions with fewer entries are evaluated sequentially.
+ * @return The same pair that evaluate_postfix() returns.
+ */
+std::pair< value_type,int > evaluate_postfix_parallel( const std::vector< std::string > & postfix_,
+                                                       ThreadPool & pool_,
+                                                       size_t threshold_ = default_parallel_threshold );
+
+#endif
@@ -14,10 +14,12 @@
 #include <vector>   // std::vector
 #include <sstream>  // std::istringstream
 #include <cstddef>  // std::ptrdiff_t
+#include <cstdint>  // std::int64_t
 #include <limits>   // std::numeric_limits, para validar a faixa de um inteiro.
 #include <algorithm>// std::copy, para copiar substrings.
 
 #include "token.hpp"// struct Token.
+#include "infix2postfix.hpp"// struct StackDepth.
 
 /*!
  * @brief Implements a recursive descendent parser for a EBNF grammar.
@@ -33,6 +35,14 @@
  *   <digit_excl_zero> := "1" | "2" | "3" | "4" | "5" | "6" | "7" | "8" | "9";
  *   <digit>           := "0"| <digit_excl_zero>;
  * ```
+ *
+ * With names enabled (see set_names()), a term may also be a name, which
+ * becomes an operand token holding the name, with its sign:
+ * ```
+ *   <term>            := "(",<expr>,")" | <integer> | <name>;
+ *   <name>            := ["-"],<letter>,{<letter>|<digit>};
+ *   <letter>          := "a"->"z" | "A"->"Z" | "_";
+ * ```
  */
 
 class Parser
@@ -42,7 +52,7 @@ class Parser
         struct ResultType
         {
             //=== Alias
-            typedef std::ptrdiff_t size_type; //!< Used for column location determination.
+            typedef std::int64_t size_type; //!< Used for column location determination (an absolute offset, even on huge lines).
 
             /// @brief List of possible syntax errors.
             enum code_t {
@@ -52,7 +62,8 @@ class Parser
                     MISSING_TERM,
                     EXTRANEOUS_SYMBOL,
                     INTEGER_OUT_OF_RANGE,
-					MISSING_CLOSING_SCOPE
+					MISSING_CLOSING_SCOPE,
+                    LIMIT_EXCEEDED //!< The expression is larger than one of the Limits.
             };
 
             //=== Members (public).
@@ -66,6 +77,17 @@ class Parser
             { /* empty */ }
         };
 
+        /// @brief Budgets a single expression must fit in; the default is no limit at all.
+        struct Limits
+        {
+            static constexpr size_t unlimited = std::numeric_limits< size_t >::max();
+
+            size_t max_bytes = unlimited;  //!< Length of the line.
+            size_t max_tokens = unlimited; //!< Tokens produced, including the ones added for "-(".
+            size_t max_depth = unlimited;  //!< Parentheses open at the same time.
+            size_t max_steps = unlimited;  //!< Operations to evaluate, that is, operator tokens.
+        };
+
         //==== Aliases
         typedef short int required_int_type; //!< The interger type we accept as valid for an expression.
         typedef long long int input_int_type; //!< The integer type that we read from the input (larger thatn the required int).
@@ -77,12 +99,36 @@ class Parser
         /// @brief Retrieves the list of tokens created during the partins process.
         std::vector< Token > get_tokens( void ) const;
 		
+        /// @brief The stack depths infix2postfix() and evaluate_postfix() need for the last expression parsed.
+        /// Only meaningful if it was parsed successfully.
+        StackDepth get_stack_depth( void ) const { return stack_depth; }
+
+        /// @brief Most parentheses open at the same time in the last expression parsed.
+        size_t get_nesting( void ) const { return nesting; }
+
+        /// @brief Times a "-(" of the last expression parsed became "-1 * (".
+        size_t get_unary_rewrites( void ) const { return unary_rewrites; }
+
+        /// @brief Operator tokens of the last expression parsed, the steps Limits::max_steps counts.
+        size_t get_steps( void ) const { return operator_count; }
+
         /// @brief Tokenizes the precedence of a certain operator.
 		int get_precedence( std::string token_value );
 
+        /// @brief The limits enforced on the following expressions.
+        void set_limits( const Limits & limits_ ) { limits = limits_; }
+        const Limits & get_limits( void ) const { return limits; }
+
+        /// @brief Whether the following expressions may refer to names, as the definitions of a Sheet do.
+        void set_names( bool names_ ) { names = names_; }
+        bool get_names( void ) const { return names; }
+
         //==== Special methods
         /// @brief Default constructor
         Parser() = default;
+
+        /// @brief A parser that rejects expressions over `limits_` with ResultType::LIMIT_EXCEEDED.
+        explicit Parser( const Limits & limits_ ) : limits( limits_ ) { /* empty */ }
         
         /// @brief Default destructor
         ~Parser() = default;
@@ -112,6 +158,16 @@ class Parser
         std::string expr;					//!< The source expression to be parsed
         std::string::iterator it_curr_symb;	//!< Pointer to the current char inside the expression.
         std::vector< Token > token_list;	//!< Resulting list of tokens extracted from the expression.
+        Limits limits;						//!< Budgets of each expression.
+        size_t operator_count = 0;			//!< Operator tokens so far, the evaluation steps.
+        std::vector< int > pending;			//!< Precedences on the conversion stack, while it is simulated.
+        size_t pending_values = 0;			//!< Size of the evaluation stack, while it is simulated.
+        StackDepth stack_depth;				//!< Largest sizes found for both stacks.
+        size_t nesting = 0;					//!< Largest number of open parentheses.
+        size_t unary_rewrites = 0;			//!< "-(" turned into "-1 * (".
+        int scope_opening = 0;				//!< Opening parentheses so far.
+        int scope_closing = 0;				//!< Closing parentheses so far.
+        bool names = false;					//!< Accepts <name> terms.
 
         terminal_symbol_t lexer( char c_ ) const;
         //std::string token_str( terminal_symbol_t s_ ) const;
@@ -136,6 +192,15 @@ class Parser
         //! @brief Checks whether we reached the end of the expression string.
         bool end_input( void ) const;            
 
+        //! @brief Appends a token to the list. @return false if that goes over the token or step limit.
+        bool push_token( Token && token_ );
+
+        //! @brief Follows `token_` through the infix to postfix conversion and the evaluation, updating stack_depth.
+        void simulate_stacks( const Token & token_ );
+
+        //! @brief The LIMIT_EXCEEDED result at the current symbol.
+        ResultType limit_exceeded( void ) const;
+
         //=== NTS methods.
 
         //! @brief Validates (i.e. returns true or false) and consumes an expression from the input string.
@@ -149,6 +214,12 @@ class Parser
         //! @return true if an integer has been successfuly parsed from the input; false otherwise.
         ResultType integer();
 
+        //! @brief Says if a <name> starts at the current symbol, when names are enabled.
+        bool at_name( void ) const;
+
+        //! @brief Validates and consumes a name from the input string, adding it to the token list.
+        ResultType name();
+
         //! @brief Validates (i.e. returns true or false) and consumes a natural number from the input string.
         //! @return true if a natural number has been successfuly parsed from the input; false otherwise.
         ResultType natural_number();
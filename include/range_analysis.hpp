@@ -0,0 +1,62 @@
+/**
+ * @file range_analysis.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Range Analysis Lib
+ * @brief Bounds the values of a compiled expression before running it.
+ */
+
+#ifndef _RANGE_ANALYSIS_HPP_
+#define _RANGE_ANALYSIS_HPP_
+
+#include <cstddef> // size_t
+#include <vector>  // std::vector
+
+#include "bytecode.hpp"
+
+/// @brief The closed range [lo, hi] of values an instruction may produce.
+struct Interval
+{
+    value_type lo;
+    value_type hi;
+
+    bool is_point( void ) const { return lo == hi; }
+};
+
+/// @brief What the analysis knows about the value produced by one instruction.
+struct RangeInfo
+{
+    Interval range; //!< Every value it may produce, if evaluation gets past it.
+    bool safe;      //!< It can neither overflow nor divide by zero.
+};
+
+/// @brief Outcome of mark_unchecked().
+struct RangeAnalysis
+{
+    size_t operations = 0; //!< Operations in the program.
+    size_t unchecked = 0;  //!< Operations marked with unchecked_flag.
+};
+
+/// @brief Interval analysis of the program in [first_, last_), one RangeInfo per instruction.
+/*!
+ * Literals give single-value intervals and every operator combines the
+ * intervals of its operands. An operation that may fail still bounds its
+ * result by the `short int` range, since evaluation stops otherwise.
+ */
+std::vector< RangeInfo > analyze_ranges( const Instruction * first_, const Instruction * last_ );
+
+/// @brief Sets unchecked_flag on every operation that provably neither overflows nor divides by zero.
+RangeAnalysis mark_unchecked( Instruction * first_, Instruction * last_ );
+
+/// @brief Sets unchecked_flag on the safe operations of a whole program.
+RangeAnalysis mark_unchecked( Program & program_ );
+
+/// @brief Says if mark_unchecked() would have set every flag found in [first_, last_), and no other flag is set.
+/*!
+ * For programs read from files, where a forged unchecked_flag would run a
+ * division by zero or an overflow without its check.
+ */
+bool flags_proved( const Instruction * first_, const Instruction * last_ );
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file shape_batch.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shape Batch Lib
+ * @brief Evaluates together the expressions that differ only in their literals.
+ */
+
+#ifndef _SHAPE_BATCH_HPP_
+#define _SHAPE_BATCH_HPP_
+
+#include <cstdint>        // std::uint32_t
+#include <string>         // std::string
+#include <unordered_map>  // std::unordered_map
+#include <utility>        // std::pair
+#include <vector>         // std::vector
+
+#include "bytecode.hpp"
+#include "infix2postfix.hpp"
+#include "token.hpp"
+
+/*!
+ * @brief Groups parsed expressions by shape and evaluates each group column by column.
+ *
+ * The shape of an expression is its token stream with the operands
+ * blanked out, so "2 * (3 - 1)" and "7 * (0 - 9)" share one. A shape is
+ * converted to postfix once, for the first expression that has it; the
+ * operands of every later expression are its literals, in order, stored
+ * as columns. Each postfix step then runs over a whole column at a time,
+ * which turns the evaluation into tight loops over arrays.
+ *
+ * Results, including the first error of each expression, are the same as
+ * evaluate_postfix() gives. Shapes are kept across batches.
+ */
+class ShapeBatch
+{
+    public:
+        using answer_type = std::pair< value_type,int >; //!< Same as evaluate_postfix().
+
+        /// @brief Adds the tokens of a successfully parsed expression to the batch.
+        void add( const std::vector< Token > & tokens_ );
+
+        /// @return The results of the expressions added since the last call, in the order they were added.
+        std::vector< answer_type > evaluate( void );
+
+        /// @return Distinct shapes seen so far.
+        size_t shapes( void ) const { return catalog.size(); }
+
+        /// @return The postfix program of shape `i_`: the operand of each PUSH is a column number.
+        const Program & program( size_t i_ ) const { return catalog[i_].program; }
+
+    private:
+        /// @brief A shape, compiled once.
+        struct Shape
+        {
+            Program program;      //!< PUSH operands are column numbers.
+            size_t operands = 0;  //!< Columns.
+            size_t depth = 0;     //!< Deepest the value stack gets.
+        };
+
+        /// @brief The expressions of the current batch that share a shape.
+        struct Group
+        {
+            std::vector< std::vector< value_type > > columns; //!< One literal column per operand.
+            std::vector< size_t > lines;                      //!< Position of each row in the batch.
+        };
+
+        std::unordered_map< std::string, std::uint32_t > index; //!< Shape key to shape number.
+        std::vector< Shape > catalog;                           //!< Every shape seen.
+        std::unordered_map< std::uint32_t, Group > groups;      //!< Groups of the current batch.
+        std::vector< std::pair< size_t, answer_type > > solo;   //!< Rows with too many operands, already evaluated.
+        size_t added = 0;                                       //!< Expressions in the current batch.
+        std::string key;                                        //!< Reused to build shape keys.
+
+        // Work areas, reused from group to group.
+        std::vector< value_type > stack;  //!< `depth` columns of values.
+        std::vector< int > codes;         //!< First error of each row.
+        std::vector< value_type > failed; //!< Value left by that error.
+
+        /// @brief Compiles a new shape from the expression that first has it.
+        Shape compile( const std::vector< Token > & tokens_ ) const;
+
+        /// @brief Runs shape `shape_` over the rows of `group_`, writing their results into `out_`.
+        void run( const Shape & shape_, const Group & group_, std::vector< answer_type > & out_ );
+};
+
+#endif
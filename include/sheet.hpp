@@ -0,0 +1,124 @@
+/**
+ * @file sheet.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Sheet Lib
+ * @brief Named expressions that refer to each other, recomputed incrementally.
+ */
+
+#ifndef _SHEET_HPP_
+#define _SHEET_HPP_
+
+#include <cstdint>       // std::uint32_t
+#include <string>        // std::string
+#include <unordered_map> // std::unordered_map
+#include <utility>       // std::pair
+#include <vector>        // std::vector
+
+#include "bytecode.hpp"
+#include "parser.hpp"
+#include "thread_pool.hpp"
+
+/// @brief Splits "<name> = <expression>". @return false if `line_` is not a definition.
+/*!
+ * `column_` receives where the expression starts in the line, or where
+ * the line stops being a definition if it is not one.
+ */
+bool parse_definition( const std::string & line_, std::string & name_, std::string & expression_, size_t & column_ );
+
+/*!
+ * @brief A set of definitions `name = expression`, where the expressions may use the names.
+ *
+ * Definitions are compiled once, with the operands that are names left as
+ * slots. recompute() evaluates only the definitions that changed since the
+ * last call and the ones that depend on them, level by level: a level
+ * holds the definitions whose dependencies are all in earlier levels, so
+ * its definitions are independent and run in parallel on the pool, if
+ * there is one. Definitions on a cycle are reported, not evaluated.
+ */
+class Sheet
+{
+    public:
+        using answer_type = std::pair< value_type,int >; //!< Same as evaluate_postfix().
+        using id_type = std::uint32_t;                   //!< Number of a name.
+
+        /// @brief What became of a definition at the last recompute().
+        enum class status_t
+        {
+            OK = 0,          //!< Evaluated; `answer` may still hold an evaluation error.
+            UNDEFINED,       //!< The name has no definition.
+            SYNTAX_ERROR,    //!< The expression does not parse; see `parsed`.
+            CYCLE,           //!< On a cycle of definitions; see cycle_of().
+            BAD_REFERENCE    //!< Uses `blame`, which has no value.
+        };
+
+        /// @brief A name and its definition.
+        struct Cell
+        {
+            bool defined = false;         //!< Whether the name has a definition at all.
+            std::string expression;       //!< As given to define().
+            Parser::ResultType parsed;     //!< Result of parsing `expression`.
+            Program program;              //!< Names are PUSH 0, patched before each run.
+            std::vector< id_type > refs;  //!< Name of each slot, in the order of `slots`.
+            std::vector< size_t > slots;  //!< Instructions that push a name.
+            std::vector< bool > negated;  //!< Slots written "-name".
+            status_t status = status_t::UNDEFINED;
+            answer_type answer{ 0, 0 };
+            id_type blame = 0;            //!< The reference at fault, for BAD_REFERENCE.
+
+            /// @brief Whether other definitions can use this one.
+            bool has_value( void ) const { return status == status_t::OK and answer.second == 0; }
+        };
+
+        /// @brief A sheet that evaluates levels of at least `grain_` definitions on `pool_`, if given.
+        explicit Sheet( ThreadPool * pool_ = nullptr, size_t grain_ = 64 );
+
+        /// @brief The limits enforced on the following definitions.
+        void set_limits( const Parser::Limits & limits_ ) { parser.set_limits( limits_ ); }
+
+        /// @brief Defines `name_`, or changes its definition. @return The result of parsing `expression_`.
+        Parser::ResultType define( const std::string & name_, const std::string & expression_ );
+
+        /// @brief Removes the definition of `name_`, if any.
+        void undefine( const std::string & name_ );
+
+        /// @brief Brings every definition up to date. @return The definitions evaluated.
+        size_t recompute( void );
+
+        /// @return The number of `name_`, creating it if needed.
+        id_type intern( const std::string & name_ );
+
+        /// @return The number of `name_`, or size() if it was never seen.
+        id_type find( const std::string & name_ ) const;
+
+        /// @return Names seen so far, defined or only referred to.
+        size_t size( void ) const { return cells.size(); }
+
+        const std::string & name( id_type id_ ) const { return names[id_]; }
+        const Cell & cell( id_type id_ ) const { return cells[id_]; }
+
+        /// @return The names on the cycle that `id_` is on, starting and ending with `id_`.
+        std::vector< id_type > cycle_of( id_type id_ ) const;
+
+    private:
+        std::unordered_map< std::string, id_type > ids; //!< Name to number.
+        std::vector< std::string > names;               //!< Number to name.
+        std::vector< Cell > cells;                      //!< Definition of each name.
+        std::vector< std::vector< id_type > > users;    //!< Names whose definitions refer to each name.
+        std::vector< id_type > dirty;                   //!< Redefined since the last recompute().
+        ThreadPool * pool;                              //!< Runs the large levels; may be null.
+        size_t grain;                                   //!< Definitions per task.
+        Parser parser;                                  //!< Parses with names enabled.
+
+        /// @brief Replaces the references of `id_` in `users`, from its old ones to its new ones.
+        void relink( id_type id_, const std::vector< id_type > & old_refs_ );
+
+        /// @brief Evaluates the definition of `id_`, whose references are all up to date.
+        void evaluate( id_type id_ );
+
+        /// @brief Marks the cycles among the definitions in `stuck_` and what depends on them.
+        void report_cycles( const std::vector< id_type > & stuck_ );
+};
+
+#endif
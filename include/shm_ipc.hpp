@@ -0,0 +1,201 @@
+/**
+ * @file shm_ipc.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shared Memory Front End Lib
+ * @brief Serves BARES to clients on the same host through shared memory rings.
+ *
+ * The server creates a POSIX shared memory object with a fixed number of
+ * client slots. A client claims a free slot, writes expressions into the
+ * slot's request ring and reads their results from its response ring;
+ * each slot has a server thread of its own. No system call is made per
+ * request: a futex is only touched when the other side is asleep.
+ */
+
+#ifndef _SHM_IPC_HPP_
+#define _SHM_IPC_HPP_
+
+#include <atomic>   // std::atomic
+#include <cstdint>  // std::uint64_t ...
+#include <deque>    // std::deque
+#include <string>   // std::string
+#include <thread>   // std::thread
+#include <vector>   // std::vector
+
+#include "parser.hpp"
+#include "shm_ring.hpp"
+
+//! @brief First bytes of the shared memory object.
+constexpr std::uint64_t shm_magic = 0x4d48535345524142ull; // "BARESSHM"
+
+//! @brief Bumped whenever the layout changes.
+constexpr std::uint32_t shm_version = 2;
+
+/// @brief The result of one expression, as the server sends it back.
+struct ShmResult
+{
+    std::uint64_t id;     //!< Chosen by the client when it submitted the expression.
+    std::int32_t code;    //!< A Parser::ResultType::code_t.
+    std::int32_t eval;    //!< Same as evaluate_postfix(): 0, -10 (division by zero) or 10 (overflow).
+    std::int64_t at_col;  //!< Column of the parsing error, if any.
+    std::int64_t value;   //!< The value, if `code` and `eval` are both 0.
+};
+
+/// @brief Sizes of a server's shared memory object.
+struct ShmConfig
+{
+    std::uint32_t slots = 4;               //!< Clients served at the same time.
+    std::uint64_t ring_bytes = 1u << 20;   //!< Bytes of each ring; rounded up to a power of two.
+    bool blocking = true;                  //!< Server threads sleep on a futex when idle, instead of yielding.
+};
+
+/// @brief Start of the shared memory object; the slots and then the ring data follow.
+struct ShmHeader
+{
+    std::uint64_t magic;                 //!< Always shm_magic.
+    std::uint32_t version;               //!< Always shm_version.
+    std::uint32_t slots;                 //!< Number of ShmSlot.
+    std::uint64_t ring_bytes;            //!< Bytes of data of each ring.
+    std::atomic< std::uint32_t > stop;   //!< Set when the server shuts down.
+    std::atomic< std::uint32_t > ready;  //!< Set once the server threads run.
+    std::int32_t server_pid;             //!< Process that created the object; it is stale once that one is gone.
+};
+
+//! @brief Values of ShmSlot::claimed.
+enum shm_slot_t : std::uint32_t
+{
+    SLOT_FREE = 0,      //!< No client.
+    SLOT_CLAIMED = 1,   //!< A client owns the slot.
+    SLOT_ABANDONED = 2 //!< Its client died or broke its ring; the server thread empties the rings and frees it.
+};
+
+/// @brief One client's rings.
+struct ShmSlot
+{
+    alignas( 64 ) std::atomic< std::uint32_t > claimed; //!< A shm_slot_t.
+    std::atomic< std::int32_t > owner;                  //!< Process of the client, 0 while there is none.
+    std::atomic< std::uint32_t > interrupt;             //!< Non-zero wakes the server thread up: the server stops or the slot is abandoned.
+    RingControl requests;                               //!< Client to server: id and expression.
+    RingControl responses;                              //!< Server to client: ShmResult.
+};
+
+/// @brief The shared memory object, mapped by the server or by a client.
+class ShmSegment
+{
+    public:
+        ShmSegment( void ) = default;
+        ShmSegment( const ShmSegment & ) = delete;
+        ShmSegment & operator=( const ShmSegment & ) = delete;
+        ~ShmSegment();
+
+        /// @brief Creates the object `name_` and maps it. @return false on any problem, or if a live server has it.
+        bool create( const std::string & name_, const ShmConfig & config_ );
+
+        /// @brief Maps an object made by create(). @return false if it is missing or not valid.
+        bool attach( const std::string & name_ );
+
+        ShmHeader * header( void ) const { return static_cast< ShmHeader * >( base ); }
+        ShmSlot & slot( std::uint32_t i_ ) const;
+        SpscRing request_ring( std::uint32_t i_ ) const;
+        SpscRing response_ring( std::uint32_t i_ ) const;
+
+    private:
+        void * base = nullptr; //!< Start of the mapping.
+        size_t length = 0;     //!< Bytes mapped.
+        std::string owned;     //!< Name to unlink on destruction; only the creator owns it.
+};
+
+/*!
+ * @brief Evaluates the expressions of every client slot of a shared memory object.
+ *
+ * Expressions go through Parser, infix2postfix() and evaluate_postfix(),
+ * like the lines of an input file, under the same Parser::Limits.
+ */
+class ShmServer
+{
+    public:
+        explicit ShmServer( const Parser::Limits & limits_ = Parser::Limits() ) : limits( limits_ ) { /* empty */ }
+        ShmServer( const ShmServer & ) = delete;
+        ShmServer & operator=( const ShmServer & ) = delete;
+
+        /// @brief Stops the server, if it runs.
+        ~ShmServer() { stop(); }
+
+        /// @brief Creates the shared memory object `name_` and starts one thread per slot. @return false on any problem.
+        bool start( const std::string & name_, const ShmConfig & config_ = ShmConfig() );
+
+        /// @brief Tells the clients and the threads to stop, then joins the threads.
+        void stop( void );
+
+    private:
+        Parser::Limits limits;              //!< Budgets of each expression.
+        ShmSegment segment;                 //!< The shared memory object.
+        std::vector< std::thread > workers; //!< One per slot.
+        bool blocking = true;               //!< See ShmConfig::blocking.
+
+        /// @brief Serves slot `i_` until the server stops.
+        void serve( std::uint32_t i_ );
+
+        /// @brief Empties the rings of slot `i_`, whose client died or sent a corrupt record, and frees it.
+        void reclaim( std::uint32_t i_ );
+};
+
+/*!
+ * @brief A process-local connection to a ShmServer.
+ *
+ * submit() stages expressions and flush() sends them together; results
+ * come back in the order the expressions were submitted. A client must be
+ * used by one thread at a time.
+ */
+class ShmClient
+{
+    public:
+        /// @brief `blocking_` says whether wait() sleeps on a futex or keeps polling.
+        explicit ShmClient( bool blocking_ = true ) : blocking( blocking_ ) { /* empty */ }
+        ShmClient( const ShmClient & ) = delete;
+        ShmClient & operator=( const ShmClient & ) = delete;
+        ~ShmClient() { disconnect(); }
+
+        /// @brief Maps the server's object and claims a free slot, or one whose client died. @return false if there is none.
+        bool connect( const std::string & name_ );
+
+        /// @brief Waits for the outstanding results and gives the slot back.
+        void disconnect( void );
+
+        /// @brief Stages an expression; it is sent by flush(), or sooner if the ring fills up.
+        /// @return false if the expression is longer than the ring takes or the server stopped.
+        bool submit( const std::string & expression_, std::uint64_t id_ );
+
+        /// @brief Sends the staged expressions.
+        void flush( void );
+
+        /// @brief Takes a result if one is ready. @return false if none is.
+        bool poll( ShmResult & result_ );
+
+        /// @brief Waits for the next result. @return false if none is outstanding or the server stopped.
+        bool wait( ShmResult & result_ );
+
+        /// @brief Submits a batch and waits for all of its results, in order.
+        std::vector< ShmResult > evaluate( const std::vector< std::string > & expressions_ );
+
+        /// @return Results not received yet.
+        size_t outstanding( void ) const { return submitted - received; }
+
+    private:
+        bool blocking;                   //!< See the constructor.
+        ShmSegment segment;              //!< The server's object.
+        std::uint32_t index = 0;         //!< Our slot.
+        bool connected = false;          //!< A slot is claimed.
+        SpscRing requests;               //!< Our side: producer.
+        SpscRing responses;              //!< Our side: consumer.
+        std::vector< char > record;      //!< Reused request buffer.
+        std::deque< ShmResult > early;   //!< Results drained while the request ring was full.
+        std::uint64_t submitted = 0;     //!< Expressions sent.
+        std::uint64_t received = 0;      //!< Results taken.
+
+        /// @brief Moves the results already published into `early`.
+        void drain( void );
+};
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * @file shm_ring.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shared Memory Ring Lib
+ * @brief Lock-free single-producer/single-consumer ring of records, for shared memory.
+ */
+
+#ifndef _SHM_RING_HPP_
+#define _SHM_RING_HPP_
+
+#include <atomic>   // std::atomic
+#include <cstddef>  // size_t
+#include <cstdint>  // std::uint32_t, std::uint64_t
+
+/*!
+ * @brief The part of a ring both processes see: its counters and futex words.
+ *
+ * `head` and `tail` only grow; they are byte counts, so the ring is empty
+ * when they are equal. Each counter is written by one side only and sits
+ * on its own cache line.
+ */
+struct RingControl
+{
+    alignas( 64 ) std::atomic< std::uint64_t > head;     //!< Bytes consumed; written by the consumer.
+    alignas( 64 ) std::atomic< std::uint64_t > tail;     //!< Bytes published; written by the producer.
+    alignas( 64 ) std::atomic< std::uint32_t > readable; //!< Futex word the consumer sleeps on.
+    std::atomic< std::uint32_t > consumer_waiting;       //!< The consumer is (about to be) asleep.
+    alignas( 64 ) std::atomic< std::uint32_t > writable; //!< Futex word the producer sleeps on.
+    std::atomic< std::uint32_t > producer_waiting;       //!< The producer is (about to be) asleep.
+};
+
+static_assert( std::atomic< std::uint64_t >::is_always_lock_free and std::atomic< std::uint32_t >::is_always_lock_free,
+               "Atomics in shared memory must not need a lock." );
+
+/// @brief Puts a ring's control block in its initial, empty state.
+void init_ring( RingControl & control_ );
+
+/// @brief Wakes every thread sleeping on `word_`, in any process.
+void futex_wake_all( std::atomic< std::uint32_t > & word_ );
+
+/*!
+ * @brief One side's view of a ring whose control block and data live in shared memory.
+ *
+ * A record is a 4-byte length, its bytes, and padding to 8 bytes; records
+ * never wrap around the end of the data. Writes and reads are staged
+ * locally and made visible in batches by publish() and release(), so a
+ * batch of records costs a couple of atomic stores, and a futex call only
+ * when the other side is asleep.
+ *
+ * Waiting is a short spin followed, if `blocking`, by a futex wait (or
+ * more spinning otherwise). Either side may block or not, independently.
+ */
+class SpscRing
+{
+    public:
+        /// @brief A view of the ring at `control_`, with `capacity_` bytes of data (a power of two) at `data_`.
+        SpscRing( RingControl * control_ = nullptr, char * data_ = nullptr, size_t capacity_ = 0 );
+
+        /// @return The largest record the ring takes.
+        size_t max_record( void ) const { return capacity / 4; }
+
+        //=== Producer side.
+        /// @brief Stages a record. @return false if there is no room for it now.
+        bool try_push( const void * data_, std::uint32_t length_ );
+
+        /// @brief Makes the staged records visible, waking the consumer if it sleeps.
+        void publish( void );
+
+        /// @brief Waits until a record of `length_` bytes fits, or `stop_` becomes non-zero. @return true if it fits.
+        bool wait_writable( std::uint32_t length_, bool blocking_, const std::atomic< std::uint32_t > * stop_ = nullptr );
+
+        //=== Consumer side.
+        /// @brief The next record, if any. @return false if none is published, or if the ring is corrupt().
+        bool peek( const char *& data_, std::uint32_t & length_ );
+
+        /// @return true once peek() found a record that does not fit the ring; nothing more is read.
+        bool corrupt( void ) const { return broken; }
+
+        /// @brief Drops the record returned by peek().
+        void pop( void );
+
+        /// @brief Gives the room of the popped records back, waking the producer if it sleeps.
+        void release( void );
+
+        /// @brief Waits until a record is published, or `stop_` becomes non-zero. @return true if there is one.
+        bool wait_readable( bool blocking_, const std::atomic< std::uint32_t > * stop_ = nullptr );
+
+    private:
+        RingControl * control; //!< Shared counters.
+        char * data;           //!< Shared records.
+        size_t capacity;       //!< Bytes of `data`.
+
+        std::uint64_t local_tail = 0;  //!< Producer: end of the staged records.
+        std::uint64_t cached_head = 0; //!< Producer: last `head` read.
+        std::uint64_t local_head = 0;  //!< Consumer: start of the next record.
+        std::uint64_t cached_tail = 0; //!< Consumer: last `tail` read.
+        std::uint32_t popped = 0;      //!< Consumer: bytes the next pop() skips.
+        bool broken = false;           //!< Consumer: see corrupt().
+
+        /// @return Bytes a record of `length_` bytes takes, padding included.
+        static std::uint64_t footprint( std::uint32_t length_ ) { return ( 4 + std::uint64_t( length_ ) + 7 ) & ~std::uint64_t( 7 ); }
+
+        /// @return true if a record of `length_` bytes fits after the staged ones, given `head_`.
+        bool fits( std::uint32_t length_, std::uint64_t head_ ) const;
+};
+
+#endif
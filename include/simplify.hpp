@@ -0,0 +1,41 @@
+/**
+ * @file simplify.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Simplify Lib
+ * @brief Algebraic simplification and strength reduction of compiled programs.
+ */
+
+#ifndef _SIMPLIFY_HPP_
+#define _SIMPLIFY_HPP_
+
+#include <cstddef> // size_t
+
+#include "bytecode.hpp"
+
+/// @brief What simplify_program() rewrote.
+struct SimplifyStats
+{
+    size_t removed = 0;   //!< Operations dropped: x*1, x+0, x-0, x/1, x^1 and double negations.
+    size_t negations = 0; //!< Operations turned into a negation: -1*x, x/-1 and 0-x.
+    size_t reduced = 0;   //!< Operations made cheaper: by powers of two, and x^2.
+    size_t folded = 0;    //!< Unary operations on a literal, replaced by their result.
+};
+
+/*!
+ * @brief Rewrites a program into one that does less work for the same results.
+ *
+ * Results include errors: the same first overflow or division by zero,
+ * with the same value. A rewrite is only made where the operation it
+ * removes can't fail (x*1, x+0, ...) or where the new one fails exactly
+ * when the old one did (-1*x and NEG both overflow for -32768 only).
+ * Double negations are only removed where the interval analysis proves
+ * the inner one can't overflow. Division and remainder by powers of two
+ * keep the truncation of "/" and "%".
+ *
+ * Flags are cleared: mark_unchecked() goes after it.
+ */
+SimplifyStats simplify_program( Program & program_ );
+
+#endif
@@ -7,74 +7,221 @@
  * @brief Stack class to handle the operations
  */
 
+#ifndef _STACK_HPP_
+#define _STACK_HPP_
+
 #include <iostream>
-#include <stdexcept>
+#include <cassert>
+#include <cstddef> // std::size_t
+#include <cstring> // std::memcpy
+#include <memory>  // std::allocator, std::allocator_traits, std::unique_ptr
+#include <type_traits> // std::is_trivially_copyable
+#include <utility> // std::move, std::forward
 
 namespace sc
 {	
-	template <typename T>
- 
+	/*!
+	 * @brief A LIFO container on raw storage.
+	 *
+	 * The first `InlineCapacity` elements are kept inside the object itself, so
+	 * short-lived stacks of a few elements never touch the heap. Past that,
+	 * storage comes from `Allocator` and doubles when full, moving the elements.
+	 * Only the slots in use hold constructed elements.
+	 */
+	template < typename T, std::size_t InlineCapacity = 8, typename Allocator = std::allocator< T > >
 	class stack{
-		
+
 		private:
 
-		T *storage; //!< Store the data
-		size_t size_; //!< Capacity size_
-		size_t top_; //!< top_ index
-		
-		/*! @brief Double the store capacity. */
-		void double_storage(void){
-			
-			T* temp = new T[2*size_]; // Reserves a doubled store capacity into a temp ptr
-			
-			for( auto i(0u); i < top_; i++) // Copy the data to the new  area
+		using traits = std::allocator_traits< Allocator >;
+
+		//! Raw room for the inline elements (at least one byte, even for no inline capacity).
+		alignas( T ) unsigned char local[ InlineCapacity > 0 ? InlineCapacity * sizeof( T ) : 1 ];
+
+		Allocator alloc;      //!< Where the heap storage comes from.
+		T *storage;           //!< Store the data: `local` or a heap block.
+		std::size_t size_;    //!< Capacity size_
+		std::size_t top_;     //!< top_ index
+
+		/*! @brief Gives a fresh block back on destruction, unless it was handed over with `block = nullptr`. */
+		struct block_guard{
+
+			Allocator & alloc;
+			T *block;
+			std::size_t capacity;
+
+			~block_guard( void ){ if( block != nullptr ) traits::deallocate( alloc, block, capacity ); }
+		};
+
+		//! Moving never throws when the elements don't, and no heap block has to be allocated for them.
+		static constexpr bool nothrow_move = std::is_nothrow_move_constructible< T >::value and
+		                                     traits::is_always_equal::value;
+
+		T * local_storage( void ){ return reinterpret_cast< T * >( local ); }
+
+		bool is_local( void ) const { return storage == reinterpret_cast< const T * >( local ); }
+
+		/*! @brief Moves the elements to a block of `capacity` elements. */
+		void reallocate( std::size_t capacity ){
+
+			adopt( traits::allocate( alloc, capacity ), capacity );
+		}
+
+		/*! @brief Moves the elements to `temp`, a block of `capacity` elements, which becomes the storage. */
+		void adopt( T *temp, std::size_t capacity ){
+
+			if constexpr ( std::is_trivially_copyable< T >::value )
 			{
-				temp[i] = storage[i];
+				if( top_ > 0 ) std::memcpy( temp, storage, top_ * sizeof( T ) );
+			}
+			else
+			{
+				for( auto i(0u); i < top_; i++ ) // Move the data to the new area
+				{
+					traits::construct( alloc, temp + i, std::move_if_noexcept( storage[i] ) );
+					traits::destroy( alloc, storage + i );
+				}
 			}
-			
-			delete [] storage; // Free the old one
 
-			
+			release();
 			storage = temp; // Redirecting the pointer
+			size_ = capacity;
+		}
 
-			
-			size_ *= 2; 
+		/*! @brief Gives the heap block back, if there is one. The elements must be gone. */
+		void release( void ){
 
+			if( not is_local() )
+				traits::deallocate( alloc, storage, size_ );
+
+			storage = local_storage();
+			size_ = InlineCapacity;
+		}
+
+		/*! @brief Copies the elements of `other`, which fit the current capacity. */
+		void copy_from( const stack & other ){
+
+			reserve( other.top_ );
+			for( ; top_ < other.top_; ++top_ )
+				traits::construct( alloc, storage + top_, other.storage[ top_ ] );
+		}
+
+		/*! @brief Takes the elements of `other`, stealing its heap block if possible. */
+		void move_from( stack & other ){
+
+			if( not other.is_local() and alloc == other.alloc )
+			{
+				storage = other.storage;
+				size_ = other.size_;
+				top_ = other.top_;
+				other.storage = other.local_storage();
+				other.size_ = InlineCapacity;
+				other.top_ = 0;
+				return;
+			}
+
+			reserve( other.top_ );
+			for( ; top_ < other.top_; ++top_ )
+				traits::construct( alloc, storage + top_, std::move( other.storage[ top_ ] ) );
+			other.clear();
 		}
+
 		public:
 			/*! @brief Constructor. */
-			stack(void) : storage(new T[1]), size_(1), top_(0){} // Initializer list
-			
+			explicit stack( const Allocator & alloc_ = Allocator() )
+				: alloc( alloc_ ), storage( local_storage() ), size_( InlineCapacity ), top_( 0 ) {}
+
+			stack( const stack & other )
+				: stack( traits::select_on_container_copy_construction( other.alloc ) )
+			{ copy_from( other ); }
+
+			stack( stack && other ) noexcept( nothrow_move )
+				: stack( other.alloc )
+			{ move_from( other ); }
+
+			stack & operator=( const stack & other ){
+
+				if( this != &other )
+				{
+					clear();
+					copy_from( other );
+				}
+				return *this;
+			}
+
+			stack & operator=( stack && other ) noexcept( nothrow_move ){
+
+				if( this != &other )
+				{
+					clear();
+					release();
+					move_from( other );
+				}
+				return *this;
+			}
+
 			/*! @brief Destructor. */
 			~stack(void){
 
-				delete [] storage;
+				clear();
+				release();
 			}
-	
 
-		/*! @brief Inserts an element into the stack. */
-		void push(const T& value){  
-			
+		/*! @brief Makes room for `capacity` elements, so that many pushes never reallocate. */
+		void reserve( std::size_t capacity ){
+
+			if( capacity > size_ ) reallocate( capacity );
+		}
+
+		/*! @brief Builds an element on top of the stack from `args`. */
+		template < typename... Args >
+		T & emplace( Args &&... args ){
+
 			// If is full double the storage capacity
-			if(size_ == top_)	double_storage();
-			
-			storage[top_++] = value;		
+			if( size_ == top_ )
+			{
+				// The new element is built before the old block goes away: `args` may
+				// refer to an element of the stack, as in `s.push( s.top() )`.
+				auto capacity = size_ > 0 ? 2*size_ : 1;
+				block_guard guard{ alloc, traits::allocate( alloc, capacity ), capacity };
+				traits::construct( alloc, guard.block + top_, std::forward< Args >( args )... );
+
+				T *temp = guard.block;
+				guard.block = nullptr;
+				adopt( temp, capacity );
+			}
+			else
+				traits::construct( alloc, storage + top_, std::forward< Args >( args )... );
+
+			return storage[ top_++ ];
 		}
 
-		/*! @brief Removes the first element from the stack. */
+		/*! @brief Inserts an element into the stack. */
+		void push( const T & value ){ emplace( value ); }
+
+		/*! @brief Inserts an element into the stack, moving it. */
+		void push( T && value ){ emplace( std::move( value ) ); }
+
+		/*! @brief Removes the first element from the stack. The stack must not be empty. */
 		void pop( ){ 
 
-			if( empty() )
-				throw std::runtime_error("You can't access an empty stack!");
+			assert( not empty() && "You can't access an empty stack!" );
 
-			--top_;
+			traits::destroy( alloc, storage + --top_ );
 		}
 
-		/*! @return The element at the top of the stack. */
-		T top( ) const {
+		/*! @return The element at the top of the stack. The stack must not be empty. */
+		T & top( ){
+
+			assert( not empty() && "You can't access an empty stack!" );
+
+			return storage[top_-1];
+		}
+
+		/*! @return The element at the top of the stack. The stack must not be empty. */
+		const T & top( ) const {
 			
-			if( empty() )
-				throw std::runtime_error("You can't access an empty stack!");
+			assert( not empty() && "You can't access an empty stack!" );
 
 			return storage[top_-1];
 		}
@@ -86,15 +233,92 @@ namespace sc
 		}
 
 		/*! @return The stack size_. */
-		size_t size(void ) const{
+		std::size_t size(void ) const{
 			
 			return top_;
 		}
 
-		/*! @brief Clear the stack. */
+		/*! @return How many elements fit before the next reallocation. */
+		std::size_t capacity( void ) const { return size_; }
+
+		/*! @brief Clear the stack. The storage is kept. */
 		void clear(void ){
 			
-			top_ = 0;
+			if constexpr ( std::is_trivially_destructible< T >::value )
+				top_ = 0;
+			else
+				while( top_ > 0 )
+					traits::destroy( alloc, storage + --top_ );
+		}
+	};
+
+	/*!
+	 * @brief A stack whose capacity is fixed when it is built, so it never grows.
+	 *
+	 * Up to `InlineCapacity` elements are kept inside the object itself;
+	 * larger capacities are allocated once, up front. push() and pop() are
+	 * only checked by assertions, so the capacity must be known beforehand,
+	 * such as the depths given by Parser::get_stack_depth().
+	 */
+	template < typename T, size_t InlineCapacity = 32 >
+	class fixed_stack{
+
+		private:
+
+		T local[ InlineCapacity ];  //!< Storage for small capacities.
+		std::unique_ptr< T[] > heap; //!< Storage for large capacities.
+		T *storage;                  //!< Either `local` or `heap`.
+		size_t capacity_;            //!< Maximum number of elements.
+		size_t top_;                 //!< top_ index
+
+		public:
+			/*! @brief A stack that holds up to `capacity` elements. */
+			explicit fixed_stack( size_t capacity )
+				: heap( capacity > InlineCapacity ? new T[ capacity ] : nullptr )
+				, storage( heap ? heap.get() : local )
+				, capacity_( capacity )
+				, top_( 0 )
+			{ /* empty */ }
+
+			fixed_stack( const fixed_stack & ) = delete;
+			fixed_stack & operator=( const fixed_stack & ) = delete;
+
+		/*! @brief Inserts an element into the stack. There must be room for it. */
+		void push( const T & value ){
+
+			assert( top_ < capacity_ && "Stack capacity exceeded!" );
+
+			storage[ top_++ ] = value;
+		}
+
+		/*! @brief Removes the first element from the stack. The stack must not be empty. */
+		void pop( ){
+
+			assert( not empty() && "You can't access an empty stack!" );
+
+			--top_;
 		}
+
+		/*! @return The element at the top of the stack. The stack must not be empty. */
+		const T & top( ) const {
+
+			assert( not empty() && "You can't access an empty stack!" );
+
+			return storage[ top_-1 ];
+		}
+
+		/*! @brief Determines if the stack is empty. */
+		bool empty( void ) const { return top_ == 0; }
+
+		/*! @return The stack size_. */
+		size_t size( void ) const { return top_; }
+
+		/*! @return How many elements it can hold. */
+		size_t capacity( void ) const { return capacity_; }
+
+		/*! @brief Clear the stack. */
+		void clear( void ){ top_ = 0; }
 	};
-}	
+}
+
+#endif
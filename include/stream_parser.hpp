@@ -0,0 +1,151 @@
+/**
+ * @file stream_parser.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Streaming Parser Lib
+ * @brief Parses and evaluates expressions read in fixed-size chunks.
+ */
+
+#ifndef _STREAM_PARSER_HPP_
+#define _STREAM_PARSER_HPP_
+
+#include <cstdint>  // std::uint64_t
+#include <istream>  // std::istream
+#include <utility>  // std::pair
+#include <vector>   // std::vector
+
+#include "infix2postfix.hpp"
+#include "parser.hpp"
+#include "stack.hpp"
+
+//! Bytes read from the input at a time.
+constexpr size_t default_chunk_size = 1u << 16;
+
+/*!
+ * @brief Reads an input stream one chunk at a time, one line (expression) after another.
+ *
+ * The end of a line looks like the end of the input to whoever is reading
+ * it, as it would with an expression read by getline(). One step back is
+ * always possible, even across chunks.
+ */
+class ChunkSource
+{
+    public:
+        /// @brief Reads `is_` in chunks of `chunk_size_` bytes.
+        explicit ChunkSource( std::istream & is_, size_t chunk_size_ = default_chunk_size );
+
+        /// @return true if there is another line to read.
+        bool has_line( void );
+
+        /// @brief Skips what is left of the current line, including its '\n'.
+        /// @return The length of the line, without the '\n'.
+        std::uint64_t finish_line( void );
+
+        /// @brief Makes every line look as if it ended after `limit_` bytes; finish_line() still skips it all.
+        void set_line_limit( std::uint64_t limit_ ) { line_limit = limit_; }
+
+        /// @return true at the end of the line (or of the input), or at the line limit.
+        bool at_end( void );
+
+        /// @return The current character, or '\0' at the end of the line.
+        char current( void ) { return at_end() ? '\0' : buffer[pos]; }
+
+        /// @brief Moves to the next character.
+        void advance( void ) { ++pos; ++column; }
+
+        /// @brief Moves one character back.
+        void back( void ) { --pos; --column; }
+
+        /// @return Offset of the current character from the beginning of the line.
+        std::uint64_t offset( void ) const { return column; }
+
+    private:
+        std::istream & is;           //!< The input.
+        std::vector< char > buffer;  //!< buffer[0] keeps the last character of the previous chunk.
+        size_t pos = 1;              //!< Current character in `buffer`.
+        size_t length = 1;           //!< Valid bytes in `buffer`.
+        std::uint64_t column = 0;    //!< Offset inside the current line.
+        std::uint64_t line_limit = Parser::Limits::unlimited; //!< Where lines are cut short.
+
+        //! @brief Reads the next chunk if the current one is over. @return false at the end of the input.
+        bool fill( void );
+};
+
+/// @brief What happened to a streamed expression.
+struct StreamResult
+{
+    Parser::ResultType result;           //!< Parsing result; evaluation only counts if it is OK.
+    std::pair< value_type,int > answer;  //!< Same as evaluate_postfix() would return.
+};
+
+/*!
+ * @brief Parses one expression from a ChunkSource and evaluates it on the fly.
+ *
+ * It accepts the same grammar as Parser, with the same error codes and
+ * columns, but keeps no copy of the expression nor of its tokens. Each
+ * token goes straight into an infix to postfix conversion whose output
+ * is evaluated at once, so memory grows with the nesting depth of the
+ * expression, not with its length.
+ */
+class StreamParser
+{
+    public:
+        /// @brief A parser that rejects expressions over `limits_` with ResultType::LIMIT_EXCEEDED.
+        explicit StreamParser( const Parser::Limits & limits_ = Parser::Limits() ) : limits( limits_ ) { /* empty */ }
+
+        /// @brief Parses and evaluates the next line of `src_`, which is left at the end of that line.
+        StreamResult parse( ChunkSource & src_ );
+
+    private:
+        Parser::Limits limits;           //!< Budgets of each expression, as in Parser.
+        size_t token_count = 0;          //!< Tokens produced so far.
+        size_t operator_count = 0;       //!< Operator tokens produced so far.
+
+        ChunkSource * src = nullptr;     //!< The input being parsed.
+
+        sc::stack< char > operators;     //!< Pending operators and "(".
+        sc::stack< value_type > values;  //!< Operands of the pending operators.
+
+        int scope_opening = 0;           //!< "(" found so far.
+        int scope_closing = 0;           //!< ")" found so far.
+
+        /// @brief Kinds of token, as far as error reporting cares.
+        enum class token_kind { NONE, OPERAND, OPERATOR, OPENING, CLOSING };
+
+        token_kind last_token = token_kind::NONE; //!< The last token produced.
+        bool failed = false;             //!< An evaluation error already decided the answer.
+        std::pair< value_type,int > answer; //!< The evaluation result.
+
+        //=== Support methods.
+
+        //! @brief Skips any white space or tab.
+        void skip_ws( void );
+
+        //! @brief Consumes the current character if it is `c_`.
+        bool accept( char c_ );
+
+        //! @brief The parsing result `code_` at the current position plus `delta_`.
+        Parser::ResultType error( Parser::ResultType::code_t code_, std::int64_t delta_ = 0 ) const;
+
+        //! @brief The grammar, iteratively: Parser recurses on every "(" but always tail-calls.
+        Parser::ResultType expression( void );
+
+        //! @brief <integer> production; `value_` receives the number.
+        Parser::ResultType integer( value_type & value_ );
+
+        //! @brief Counts a token, as Parser::push_token() does. @return false if that goes over a limit.
+        bool count_token( token_kind kind_ );
+
+        //=== Conversion and evaluation of the produced tokens.
+
+        void push_operand( value_type value_ );
+        void push_operator( char op_ );
+        void push_opening( void );
+        void push_closing( void );
+
+        //! @brief Applies the operator on top of the stack to the top two values.
+        void apply_top( void );
+};
+
+#endif
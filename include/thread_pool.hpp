@@ -0,0 +1,102 @@
+/**
+ * @file thread_pool.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Thread Pool
+ * @brief Work-stealing thread pool used by the parallel modes.
+ */
+
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // size_t
+#include <deque>              // std::deque
+#include <functional>         // std::function
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+/*!
+ * @brief Counts the tasks of one fork-join region.
+ *
+ * Tasks are added with ThreadPool::run() and ThreadPool::wait() returns
+ * only after every task of the group has finished.
+ */
+class TaskGroup
+{
+    friend class ThreadPool;
+
+    private:
+        std::atomic< size_t > pending{ 0 }; //!< Tasks not finished yet.
+};
+
+/*!
+ * @brief Fixed set of workers, each one owning a task deque.
+ *
+ * A worker pops tasks from the back of its own deque and, when it runs
+ * out of work, steals from the front of the other deques. Threads that
+ * wait on a TaskGroup help running tasks, and only block when there is
+ * none left to steal.
+ */
+class ThreadPool
+{
+    public:
+        //==== Aliases
+        typedef std::function< void( void ) > task_type; //!< Unit of work.
+
+        //==== Special methods
+        /// @brief Starts `n_workers_` workers (at least one).
+        explicit ThreadPool( size_t n_workers_ = std::thread::hardware_concurrency() );
+
+        /// @brief Finishes the queued tasks and joins the workers.
+        ~ThreadPool();
+
+        ThreadPool( const ThreadPool & ) = delete;
+        ThreadPool & operator=( const ThreadPool & ) = delete;
+
+        //==== Public interface
+        /// @brief Queues a detached task.
+        void submit( task_type task_ );
+
+        /// @brief Queues a task that belongs to the group `group_`.
+        void run( TaskGroup & group_, task_type task_ );
+
+        /// @brief Runs queued tasks until every task of `group_` is done.
+        void wait( TaskGroup & group_ );
+
+        /// @return The number of workers.
+        size_t size( void ) const { return workers.size(); }
+
+    private:
+        /// @brief A worker deque.
+        struct WorkQueue
+        {
+            std::mutex lock;              //!< Guards `tasks`.
+            std::deque< task_type > tasks; //!< Owner uses the back, thieves the front.
+        };
+
+        std::vector< std::unique_ptr< WorkQueue > > queues; //!< One deque per worker.
+        std::vector< std::thread > workers;                //!< The worker threads.
+
+        std::mutex sleep_lock;                  //!< Guards the sleeping workers and waiters.
+        std::condition_variable wake_up;        //!< Signals new tasks or shutdown.
+        std::condition_variable task_ready;     //!< Signals new tasks or a finished group, to wait().
+        std::atomic< size_t > queued{ 0 };      //!< Tasks pushed but not popped yet.
+        std::atomic< size_t > next_queue{ 0 };  //!< Round robin for outside submissions.
+        bool stopping = false;                  //!< Set by the destructor.
+
+        //! @brief Index of the calling thread deque, or a round robin pick for outsiders.
+        size_t home_queue( void );
+
+        //! @brief Pops from the own deque or steals from another one.
+        bool try_pop( size_t home_, task_type & task_ );
+
+        //! @brief Main loop of the worker `index_`.
+        void worker_loop( size_t index_ );
+};
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file threaded_eval.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Threaded Interpreter Lib
+ * @brief A direct-threaded interpreter for compiled postfix expressions.
+ */
+
+#ifndef _THREADED_EVAL_HPP_
+#define _THREADED_EVAL_HPP_
+
+#include <cstdint>  // std::uint8_t, std::int32_t
+#include <utility>  // std::pair
+#include <vector>   // std::vector
+
+#include "bytecode.hpp"
+
+//! Labels as values (computed goto) are a GCC extension; elsewhere the interpreter uses a switch.
+#if defined( __GNUC__ ) and not defined( BARES_NO_COMPUTED_GOTO )
+#define BARES_COMPUTED_GOTO 1
+#else
+#define BARES_COMPUTED_GOTO 0
+#endif
+
+/// @brief Operations of the threaded interpreter: the opcodes plus the superinstructions.
+enum class threaded_op_t : std::uint8_t
+{
+    PUSH = 0,         //!< Pushes the immediate.
+    ADD, SUB, MUL, DIV, MOD, POW,
+    ADD_K, SUB_K, MUL_K, DIV_K, MOD_K, POW_K, //!< Operator whose right operand is the immediate.
+    MADD,             //!< "a b c * +": a + b * c.
+    MADD_K,           //!< "a b k * +": a + b * k, k being the immediate.
+    NEG, SHL, DIV2, MOD2, SQR, //!< The unary opcodes; the immediate is their k.
+    HALT              //!< End of the program.
+};
+
+/// @brief One pre-decoded instruction.
+struct ThreadedOp
+{
+    const void * handler; //!< Address of the code that runs it, with computed goto; unused otherwise.
+    std::int32_t imm;     //!< Constant operand, for PUSH and the *_K operations.
+    threaded_op_t code;   //!< What to do.
+};
+
+/*!
+ * @brief A compiled program decoded for execute_threaded().
+ *
+ * Each constant that is the right operand of the next operator is folded
+ * into it, and a multiplication followed by an addition becomes a single
+ * instruction. The stack depth is known from the decoding, so the
+ * interpreter never checks it.
+ */
+struct ThreadedProgram
+{
+    std::vector< ThreadedOp > code; //!< Instructions, ending with HALT.
+    size_t max_depth = 0;           //!< Deepest the value stack gets.
+};
+
+/// @brief Decodes the program in [first_, last_), which must form a whole expression.
+ThreadedProgram decode_program( const Instruction * first_, const Instruction * last_ );
+
+/// @brief Decodes a whole program.
+ThreadedProgram decode_program( const Program & program_ );
+
+/// @brief Runs a decoded program. Gives the same result as evaluate_postfix().
+/*!
+ * Every operation is checked, including the ones that carry unchecked_flag:
+ * a check here is a single comparison.
+ */
+std::pair< value_type,int > execute_threaded( const ThreadedProgram & program_ );
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file trace.hpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Trace Lib
+ * @brief Timestamped spans of each expression and phase, exported as Chrome trace events.
+ */
+
+#ifndef _TRACE_HPP_
+#define _TRACE_HPP_
+
+#include <atomic>  // std::atomic
+#include <cstdint> // std::uint64_t
+#include <string>  // std::string
+
+//! Spans kept per thread; older ones are overwritten.
+constexpr size_t default_trace_capacity = 1u << 16;
+
+/// @brief One finished span.
+struct TraceEvent
+{
+    const char * name;       //!< Phase name; must be a string literal.
+    std::uint64_t start;     //!< Nanoseconds since trace_start().
+    std::uint64_t duration;  //!< Nanoseconds.
+    std::uint64_t line;      //!< Input line (1-based), 0 if none.
+};
+
+namespace trace_detail
+{
+    extern bool enabled;                      //!< Set once, by trace_start().
+    extern std::atomic< std::uint64_t > line; //!< Line the driver is working on.
+
+    std::uint64_t now( void );
+    void record( const TraceEvent & event_ );
+}
+
+/// @brief Turns tracing on, with room for `capacity_` spans per thread. Call it before any span.
+/// The calling thread is the first one of the trace.
+void trace_start( size_t capacity_ = default_trace_capacity );
+
+/// @return true if spans are being recorded.
+inline bool trace_enabled( void ) { return trace_detail::enabled; }
+
+/// @brief Sets the line that following spans are tagged with, on every thread.
+inline void trace_set_line( std::uint64_t line_ )
+{
+    if ( trace_enabled() ) trace_detail::line.store( line_, std::memory_order_relaxed );
+}
+
+/// @brief Writes every recorded span as Chrome trace-event JSON. Call it after the workers are done.
+/// @return false if the file could not be written.
+bool trace_write_json( const std::string & path_ );
+
+/*!
+ * @brief Records the time from its construction to its destruction.
+ *
+ * With tracing off it costs one test of a flag that never changes.
+ * Spans go into a ring buffer owned by the calling thread: recording takes
+ * no lock and does not synchronize with other threads.
+ */
+class TraceSpan
+{
+    public:
+        /// @brief Starts the span `name_` (a string literal) for the current line.
+        explicit TraceSpan( const char * name_ )
+            : name( name_ )
+            , active( trace_enabled() )
+        {
+            if ( active ) start = trace_detail::now();
+        }
+
+        ~TraceSpan()
+        {
+            if ( active )
+            {
+                auto end = trace_detail::now();
+                trace_detail::record( TraceEvent{ name, start, end - start,
+                                                  trace_detail::line.load( std::memory_order_relaxed ) } );
+            }
+        }
+
+        TraceSpan( const TraceSpan & ) = delete;
+        TraceSpan & operator=( const TraceSpan & ) = delete;
+
+    private:
+        const char * name;       //!< Phase name.
+        bool active;             //!< Tracing was on when it started.
+        std::uint64_t start = 0; //!< Nanoseconds since trace_start().
+};
+
+/// @brief Runs `f_` inside the span `name_`. @return What `f_` returns.
+template < typename F >
+auto traced( const char * name_, F f_ ) -> decltype( f_() )
+{
+    TraceSpan span( name_ );
+    return f_();
+}
+
+#endif
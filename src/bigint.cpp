@@ -0,0 +1,408 @@
+/**
+ * @file bigint.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Big Integer Code
+ * @brief Arbitrary-precision signed integers.
+ */
+
+#include "../include/bigint.hpp"
+
+#include <algorithm> // std::min, std::reverse
+#include <cassert>   // assert
+
+namespace
+{
+    using limb = BigInt::limb_type;
+    using mag = BigInt::mag_type;
+    using wide = std::uint64_t;
+
+    //! Below this many limbs schoolbook multiplication beats Karatsuba.
+    const size_t karatsuba_threshold = 40;
+
+    //! @brief Removes leading zero limbs.
+    void trim( mag & m_ )
+    {
+        while ( not m_.empty() and m_.back() == 0 )
+            m_.pop_back();
+    }
+
+    //! @brief Compares two magnitudes.
+    int compare_mag( const mag & a_, const mag & b_ )
+    {
+        if ( a_.size() != b_.size() )
+            return a_.size() < b_.size() ? -1 : 1;
+
+        for ( auto i = a_.size(); i-- > 0; )
+            if ( a_[i] != b_[i] )
+                return a_[i] < b_[i] ? -1 : 1;
+
+        return 0;
+    }
+
+    mag add_mag( const mag & a_, const mag & b_ )
+    {
+        const mag & x = a_.size() >= b_.size() ? a_ : b_;
+        const mag & y = a_.size() >= b_.size() ? b_ : a_;
+
+        mag r( x.size() + 1 );
+        wide carry = 0;
+        for ( auto i(0u); i < x.size(); ++i )
+        {
+            wide s = wide( x[i] ) + ( i < y.size() ? y[i] : 0 ) + carry;
+            r[i] = limb( s );
+            carry = s >> 32;
+        }
+        r[ x.size() ] = limb( carry );
+
+        trim( r );
+        return r;
+    }
+
+    //! @brief `a_ - b_`, with `a_ >= b_`.
+    mag sub_mag( const mag & a_, const mag & b_ )
+    {
+        mag r( a_.size() );
+        wide borrow = 0;
+        for ( auto i(0u); i < a_.size(); ++i )
+        {
+            wide d = wide( a_[i] ) - ( i < b_.size() ? b_[i] : 0 ) - borrow;
+            r[i] = limb( d );
+            borrow = ( d >> 32 ) != 0;
+        }
+        assert( borrow == 0 );
+
+        trim( r );
+        return r;
+    }
+
+    //! @brief Adds `x_`, shifted by `offset_` limbs, into `r_`, which must be long enough.
+    void add_into( mag & r_, const mag & x_, size_t offset_ )
+    {
+        wide carry = 0;
+        size_t i = 0;
+        for ( ; i < x_.size(); ++i )
+        {
+            wide s = wide( r_[ offset_ + i ] ) + x_[i] + carry;
+            r_[ offset_ + i ] = limb( s );
+            carry = s >> 32;
+        }
+        for ( ; carry != 0; ++i )
+        {
+            wide s = wide( r_[ offset_ + i ] ) + carry;
+            r_[ offset_ + i ] = limb( s );
+            carry = s >> 32;
+        }
+    }
+
+    //! @brief Limbs [first_, last_) of `m_`, without leading zeros.
+    mag slice( const mag & m_, size_t first_, size_t last_ )
+    {
+        last_ = std::min( last_, m_.size() );
+        mag r( m_.begin() + std::min( first_, last_ ), m_.begin() + last_ );
+        trim( r );
+        return r;
+    }
+
+    mag mul_mag( const mag & a_, const mag & b_ )
+    {
+        if ( a_.empty() or b_.empty() ) return mag();
+
+        const mag & a = a_.size() >= b_.size() ? a_ : b_;
+        const mag & b = a_.size() >= b_.size() ? b_ : a_;
+        const auto na = a.size();
+        const auto nb = b.size();
+
+        mag r( na + nb + 1 );
+
+        if ( nb < karatsuba_threshold )
+        {
+            // Schoolbook.
+            for ( auto i(0u); i < na; ++i )
+            {
+                wide ai = a[i], carry = 0;
+                if ( ai == 0 ) continue;
+
+                for ( auto j(0u); j < nb; ++j )
+                {
+                    wide t = ai * b[j] + r[ i + j ] + carry;
+                    r[ i + j ] = limb( t );
+                    carry = t >> 32;
+                }
+                r[ i + nb ] = limb( carry );
+            }
+        }
+        else if ( na >= 2 * nb )
+        {
+            // Unbalanced: multiply `b` by slices of `a` as long as `b`.
+            for ( size_t offset = 0; offset < na; offset += nb )
+                add_into( r, mul_mag( slice( a, offset, offset + nb ), b ), offset );
+        }
+        else
+        {
+            // Karatsuba: three half-size products instead of four.
+            const auto m = na / 2;
+            auto a0 = slice( a, 0, m ), a1 = slice( a, m, na );
+            auto b0 = slice( b, 0, m ), b1 = slice( b, m, nb );
+
+            auto z0 = mul_mag( a0, b0 );
+            auto z2 = mul_mag( a1, b1 );
+            auto z1 = sub_mag( sub_mag( mul_mag( add_mag( a0, a1 ), add_mag( b0, b1 ) ), z0 ), z2 );
+
+            add_into( r, z0, 0 );
+            add_into( r, z1, m );
+            add_into( r, z2, 2 * m );
+        }
+
+        trim( r );
+        return r;
+    }
+
+    //! @brief Divides `m_` by `d_` in place. @return The remainder.
+    limb divmod_small( mag & m_, limb d_ )
+    {
+        wide rem = 0;
+        for ( auto i = m_.size(); i-- > 0; )
+        {
+            wide cur = ( rem << 32 ) | m_[i];
+            m_[i] = limb( cur / d_ );
+            rem = cur % d_;
+        }
+        trim( m_ );
+        return limb( rem );
+    }
+
+    //! @brief Number of leading zero bits of a non-zero limb.
+    int leading_zeros( limb x_ )
+    {
+        return __builtin_clz( x_ );
+    }
+
+    //! @brief Long division of magnitudes (Knuth's algorithm D). `v_` must not be zero.
+    void divmod_mag( const mag & u_, const mag & v_, mag & q_, mag & r_ )
+    {
+        assert( not v_.empty() );
+
+        if ( compare_mag( u_, v_ ) < 0 )
+        {
+            q_.clear();
+            r_ = u_;
+            return;
+        }
+
+        if ( v_.size() == 1 )
+        {
+            q_ = u_;
+            limb rem = divmod_small( q_, v_[0] );
+            r_.clear();
+            if ( rem != 0 ) r_.push_back( rem );
+            return;
+        }
+
+        const auto m = u_.size(), n = v_.size();
+        const int s = leading_zeros( v_.back() );
+
+        // Normalize, so the top limb of the divisor has its high bit set.
+        mag vn( n ), un( m + 1 );
+        for ( auto i = n - 1; i > 0; --i )
+            vn[i] = ( v_[i] << s ) | ( s ? limb( wide( v_[i - 1] ) >> ( 32 - s ) ) : 0 );
+        vn[0] = v_[0] << s;
+
+        un[m] = s ? limb( wide( u_[m - 1] ) >> ( 32 - s ) ) : 0;
+        for ( auto i = m - 1; i > 0; --i )
+            un[i] = ( u_[i] << s ) | ( s ? limb( wide( u_[i - 1] ) >> ( 32 - s ) ) : 0 );
+        un[0] = u_[0] << s;
+
+        q_.assign( m - n + 1, 0 );
+        const wide base = wide( 1 ) << 32;
+
+        for ( auto j = m - n + 1; j-- > 0; )
+        {
+            // Estimate the quotient limb from the top two limbs.
+            wide num = ( wide( un[ j + n ] ) << 32 ) | un[ j + n - 1 ];
+            wide qhat = num / vn[ n - 1 ];
+            wide rhat = num % vn[ n - 1 ];
+
+            while ( qhat >= base or qhat * vn[ n - 2 ] > ( ( rhat << 32 ) | un[ j + n - 2 ] ) )
+            {
+                --qhat;
+                rhat += vn[ n - 1 ];
+                if ( rhat >= base ) break;
+            }
+
+            // Multiply and subtract.
+            std::int64_t borrow = 0, t = 0;
+            for ( auto i(0u); i < n; ++i )
+            {
+                wide p = qhat * vn[i];
+                t = std::int64_t( un[ i + j ] ) - borrow - std::int64_t( p & 0xFFFFFFFF );
+                un[ i + j ] = limb( t );
+                borrow = std::int64_t( p >> 32 ) - ( t >> 32 );
+            }
+            t = std::int64_t( un[ j + n ] ) - borrow;
+            un[ j + n ] = limb( t );
+
+            q_[j] = limb( qhat );
+            if ( t < 0 )
+            {
+                // The estimate was one too big: add the divisor back.
+                --q_[j];
+                wide carry = 0;
+                for ( auto i(0u); i < n; ++i )
+                {
+                    wide sum = wide( un[ i + j ] ) + vn[i] + carry;
+                    un[ i + j ] = limb( sum );
+                    carry = sum >> 32;
+                }
+                un[ j + n ] = limb( wide( un[ j + n ] ) + carry );
+            }
+        }
+
+        // Unnormalize the remainder.
+        r_.assign( n, 0 );
+        for ( auto i(0u); i < n; ++i )
+            r_[i] = ( un[i] >> s ) | ( s ? limb( wide( un[ i + 1 ] ) << ( 32 - s ) ) : 0 );
+
+        trim( q_ );
+        trim( r_ );
+    }
+}
+
+/// @brief Builds a value from a sign and a magnitude, fixing the sign of zero.
+BigInt::BigInt( bool negative_, mag_type && mag_ )
+    : negative( negative_ )
+    , mag( std::move( mag_ ) )
+{
+    trim( mag );
+    if ( mag.empty() ) negative = false;
+}
+
+/// @brief Converts a built-in integer.
+BigInt::BigInt( long long value_ )
+    : negative( value_ < 0 )
+{
+    unsigned long long m = negative ? 0ull - static_cast< unsigned long long >( value_ )
+                                    : static_cast< unsigned long long >( value_ );
+    while ( m != 0 )
+    {
+        mag.push_back( limb( m ) );
+        m >>= 32;
+    }
+}
+
+/// @return The number of bits of the magnitude (0 for zero).
+size_t BigInt::bit_length( void ) const
+{
+    if ( mag.empty() ) return 0;
+    return ( mag.size() - 1 ) * 32 + ( 32 - leading_zeros( mag.back() ) );
+}
+
+/// @return true if the value fits a `long long`.
+bool BigInt::fits_int64( void ) const
+{
+    auto bits = bit_length();
+    if ( bits < 64 ) return true;
+
+    // Only -2^63 has 64 bits and still fits.
+    return bits == 64 and negative and mag[1] == 0x80000000u and mag[0] == 0;
+}
+
+/// @return The value as a `long long`; it must fit (see fits_int64()).
+long long BigInt::to_int64( void ) const
+{
+    assert( fits_int64() );
+
+    unsigned long long m = 0;
+    for ( auto i = mag.size(); i-- > 0; )
+        m = ( m << 32 ) | mag[i];
+
+    return negative ? static_cast< long long >( 0ull - m ) : static_cast< long long >( m );
+}
+
+/// @return The exact value in decimal.
+std::string BigInt::to_string( void ) const
+{
+    if ( mag.empty() ) return "0";
+
+    // Nine decimal digits at a time, least significant group first.
+    mag_type m( mag );
+    std::vector< limb > groups;
+    while ( not m.empty() )
+        groups.push_back( divmod_small( m, 1000000000u ) );
+
+    std::string out( negative ? "-" : "" );
+    out += std::to_string( groups.back() );
+    for ( auto i = groups.size() - 1; i-- > 0; )
+    {
+        auto g = std::to_string( groups[i] );
+        out.append( 9 - g.size(), '0' );
+        out += g;
+    }
+
+    return out;
+}
+
+BigInt BigInt::operator-( void ) const
+{
+    BigInt r( *this );
+    if ( not r.mag.empty() ) r.negative = not r.negative;
+    return r;
+}
+
+BigInt operator+( const BigInt & a_, const BigInt & b_ )
+{
+    if ( a_.negative == b_.negative )
+        return BigInt( a_.negative, add_mag( a_.mag, b_.mag ) );
+
+    // Different signs: the larger magnitude gives the sign.
+    if ( compare_mag( a_.mag, b_.mag ) >= 0 )
+        return BigInt( a_.negative, sub_mag( a_.mag, b_.mag ) );
+
+    return BigInt( b_.negative, sub_mag( b_.mag, a_.mag ) );
+}
+
+BigInt operator-( const BigInt & a_, const BigInt & b_ )
+{
+    return a_ + ( -b_ );
+}
+
+BigInt operator*( const BigInt & a_, const BigInt & b_ )
+{
+    return BigInt( a_.negative != b_.negative, mul_mag( a_.mag, b_.mag ) );
+}
+
+/// @brief Truncating division: `q_ = a_ / b_` and `r_ = a_ % b_`. `b_` must not be zero.
+void BigInt::divmod( const BigInt & a_, const BigInt & b_, BigInt & q_, BigInt & r_ )
+{
+    mag_type q, r;
+    divmod_mag( a_.mag, b_.mag, q, r );
+
+    q_ = BigInt( a_.negative != b_.negative, std::move( q ) );
+    r_ = BigInt( a_.negative, std::move( r ) );
+}
+
+/// @return This value raised to `exponent_`, by repeated squaring.
+BigInt BigInt::pow( unsigned long long exponent_ ) const
+{
+    BigInt result( 1 ), base( *this );
+
+    while ( exponent_ != 0 )
+    {
+        if ( exponent_ & 1 ) result = result * base;
+        exponent_ >>= 1;
+        if ( exponent_ != 0 ) base = base * base;
+    }
+
+    return result;
+}
+
+/// @return <0, 0 or >0 as `a_` is smaller, equal or greater than `b_`.
+int compare( const BigInt & a_, const BigInt & b_ )
+{
+    if ( a_.negative != b_.negative )
+        return a_.negative ? -1 : 1;
+
+    auto c = compare_mag( a_.mag, b_.mag );
+    return a_.negative ? -c : c;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file binary_file.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Binary Expression File Code
+ * @brief Pre-compiled expression files, read back through mmap.
+ */
+
+#include "../include/binary_file.hpp"
+#include "../include/range_analysis.hpp" // flags_proved
+
+#include <cstring>    // std::memcmp, std::memcpy
+#include <limits>     // std::numeric_limits
+
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+
+namespace
+{
+    //! @return `n_` rounded up to a multiple of 8.
+    std::uint64_t align8( std::uint64_t n_ )
+    {
+        return ( n_ + 7 ) & ~std::uint64_t( 7 );
+    }
+}
+
+//=== BinaryWriter
+
+/// @brief Creates the file and reserves room for its header.
+bool BinaryWriter::open( const std::string & path_ )
+{
+    ofs.open( path_.c_str(), std::ios::binary | std::ios::trunc );
+    offsets.clear();
+
+    BinaryHeader header{};
+    ofs.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+    position = sizeof( header );
+
+    return static_cast< bool >( ofs );
+}
+
+/// @brief Appends the record of one input line. @return false, writing nothing, if its lengths don't fit the record.
+bool BinaryWriter::append( const Parser::ResultType & result_, const std::string & source_, const Program & program_,
+                           const LineCounts & counts_ )
+{
+    const auto max_length = std::numeric_limits< std::uint32_t >::max();
+    if ( source_.size() > max_length or program_.size() > max_length ) return false;
+
+    offsets.push_back( position );
+
+    RecordHeader header{};
+    header.at_col = result_.at_col;
+    header.source_length = static_cast< std::uint32_t >( source_.size() );
+    header.program_length = static_cast< std::uint32_t >( program_.size() );
+    header.counts = counts_;
+    header.code = static_cast< std::uint8_t >( result_.type );
+
+    ofs.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+    ofs.write( source_.data(), source_.size() );
+    position += sizeof( header ) + source_.size();
+    pad();
+
+    ofs.write( reinterpret_cast< const char * >( program_.data() ), program_.size() * sizeof( Instruction ) );
+    position += program_.size() * sizeof( Instruction );
+    pad();
+    return true;
+}
+
+/// @brief Writes the index and the header. @return true if every write succeeded.
+bool BinaryWriter::close( void )
+{
+    BinaryHeader header{};
+    std::memcpy( header.magic, binary_magic, sizeof( header.magic ) );
+    header.version = binary_version;
+    header.record_count = offsets.size();
+    header.index_offset = position;
+
+    ofs.write( reinterpret_cast< const char * >( offsets.data() ), offsets.size() * sizeof( std::uint64_t ) );
+
+    // The header goes last, so a half written file is never taken as valid.
+    ofs.seekp( 0 );
+    ofs.write( reinterpret_cast< const char * >( &header ), sizeof( header ) );
+    ofs.close();
+
+    return not ofs.fail();
+}
+
+/// @brief Writes zeros until `position` is a multiple of 8.
+void BinaryWriter::pad( void )
+{
+    static const char zeros[8] = {};
+
+    auto aligned = align8( position );
+    ofs.write( zeros, aligned - position );
+    position = aligned;
+}
+
+//=== BinaryReader
+
+BinaryReader::~BinaryReader()
+{
+    if ( data != nullptr )
+        munmap( const_cast< char * >( data ), length );
+}
+
+/// @brief Maps the file and checks its header, index and programs. @return false on any problem.
+bool BinaryReader::open( const std::string & path_ )
+{
+    int fd = ::open( path_.c_str(), O_RDONLY );
+    if ( fd < 0 ) return false;
+
+    struct stat info;
+    if ( fstat( fd, &info ) != 0 or static_cast< size_t >( info.st_size ) < sizeof( BinaryHeader ) )
+    {
+        ::close( fd );
+        return false;
+    }
+
+    length = info.st_size;
+    void * map = mmap( nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0 );
+    ::close( fd ); // The mapping stays valid.
+    if ( map == MAP_FAILED ) return false;
+    data = static_cast< const char * >( map );
+
+    // Header.
+    const auto & header = *reinterpret_cast< const BinaryHeader * >( data );
+    if ( std::memcmp( header.magic, binary_magic, sizeof( binary_magic ) ) != 0 or
+         header.version < binary_min_version or header.version > binary_version or
+         header.index_offset % 8 != 0 or
+         header.index_offset > length or
+         header.record_count > ( length - header.index_offset ) / sizeof( std::uint64_t ) )
+        return false;
+
+    index = reinterpret_cast< const std::uint64_t * >( data + header.index_offset );
+    count = header.record_count;
+
+    // Every record must lie before the index.
+    for ( auto i(0u); i < count; ++i )
+    {
+        auto offset = index[i];
+        if ( offset % 8 != 0 or offset > header.index_offset or
+             offset + sizeof( RecordHeader ) > header.index_offset )
+            return false;
+
+        const auto & rec = *reinterpret_cast< const RecordHeader * >( data + offset );
+        auto end = align8( offset + sizeof( RecordHeader ) + rec.source_length )
+                 + std::uint64_t( rec.program_length ) * sizeof( Instruction );
+        if ( end > header.index_offset )
+            return false;
+
+        // Only lines that parsed have a program, and it must run to a single
+        // value; checks are only skipped where the analysis proves them useless.
+        if ( rec.code > Parser::ResultType::LIMIT_EXCEEDED )
+            return false;
+        auto r = record( i );
+        if ( rec.code == Parser::ResultType::OK ?
+                not is_valid_program( r.program, r.program + r.program_length ) or
+                not flags_proved( r.program, r.program + r.program_length ) : r.program_length != 0 )
+            return false;
+    }
+
+    return true;
+}
+
+/// @return The record `i_` (which must be smaller than size()).
+BinaryRecord BinaryReader::record( size_t i_ ) const
+{
+    auto offset = index[i_];
+    const auto & rec = *reinterpret_cast< const RecordHeader * >( data + offset );
+    auto text = offset + sizeof( RecordHeader );
+
+    BinaryRecord r{ Parser::ResultType( static_cast< Parser::ResultType::code_t >( rec.code ), rec.at_col ),
+                    rec.counts, data + text, rec.source_length,
+                    reinterpret_cast< const Instruction * >( data + align8( text + rec.source_length ) ),
+                    rec.program_length };
+    return r;
+}
+
+/// @return true if the file `path_` starts with binary_magic.
+bool is_binary_file( const std::string & path_ )
+{
+    std::ifstream ifs( path_.c_str(), std::ios::binary );
+    char magic[ sizeof( binary_magic ) ] = {};
+
+    ifs.read( magic, sizeof( magic ) );
+    return ifs and std::memcmp( magic, binary_magic, sizeof( magic ) ) == 0;
+}
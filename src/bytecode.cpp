@@ -0,0 +1,220 @@
+/**
+ * @file bytecode.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Bytecode Code
+ * @brief Compiled form of a postfix expression.
+ */
+
+#include "../include/bytecode.hpp"
+#include "../include/stack.hpp" // stack
+
+#include <cassert>  // assert
+#include <charconv> // std::from_chars
+#include <limits>   // std::numeric_limits
+
+/// @return The operator symbol ("+-*/%^") of a binary opcode.
+char symbol_of( opcode_t op_ )
+{
+    switch ( op_ )
+    {
+        case opcode_t::ADD: return '+';
+        case opcode_t::SUB: return '-';
+        case opcode_t::MUL: return '*';
+        case opcode_t::DIV: return '/';
+        case opcode_t::MOD: return '%';
+        case opcode_t::POW: return '^';
+        default: break;
+    }
+
+    assert( false );
+    return '\0';
+}
+
+/// @brief Translates a postfix expression, as built by infix2postfix(), into a program.
+Program compile_postfix( const std::vector< std::string > & postfix_ )
+{
+    Program program;
+    program.reserve( postfix_.size() );
+
+    for ( const auto & entry : postfix_ )
+    {
+        Instruction ins{ opcode_t::PUSH, 0, 0 };
+
+        if ( not is_operator_entry( entry ) )
+        {
+            value_type integer = 0;
+            auto conversion = std::from_chars( entry.data(), entry.data() + entry.size(), integer );
+            assert( conversion.ec == std::errc() );
+            assert( integer >= std::numeric_limits< std::int16_t >::min() and
+                    integer <= std::numeric_limits< std::int16_t >::max() );
+            (void) conversion;
+
+            ins.operand = static_cast< std::int16_t >( integer );
+        }
+        else
+        {
+            switch ( entry[0] )
+            {
+                case '+': ins.op = opcode_t::ADD; break;
+                case '-': ins.op = opcode_t::SUB; break;
+                case '*': ins.op = opcode_t::MUL; break;
+                case '/': ins.op = opcode_t::DIV; break;
+                case '%': ins.op = opcode_t::MOD; break;
+                case '^': ins.op = opcode_t::POW; break;
+            }
+        }
+        program.push_back( ins );
+    }
+
+    return program;
+}
+
+namespace
+{
+    //! @brief Applies an operation already known to be safe: no range nor zero divisor check.
+    value_type execute_unchecked( value_type n1, value_type n2, opcode_t op_ )
+    {
+        switch ( op_ )
+        {
+            case opcode_t::ADD: return n1 + n2;
+            case opcode_t::SUB: return n1 - n2;
+            case opcode_t::MUL: return n1 * n2;
+            case opcode_t::DIV: return n1 / n2;
+            case opcode_t::MOD: return n1 % n2;
+            case opcode_t::POW: return static_cast< value_type >( pow( n1, n2 ) );
+            default: break;
+        }
+
+        assert( false );
+        return 0;
+    }
+}
+
+/// @brief Applies the unary operation `ins_` to `value_`, without any range check.
+value_type execute_unary( value_type value_, const Instruction & ins_ )
+{
+    switch ( ins_.op )
+    {
+        case opcode_t::NEG:  return -value_;
+        case opcode_t::SHL:  return shift_left( value_, ins_.operand );
+        case opcode_t::DIV2: return divide_pow2( value_, ins_.operand );
+        case opcode_t::MOD2: return remainder_pow2( value_, ins_.operand );
+        case opcode_t::SQR:  return value_ * value_;
+        default: break;
+    }
+
+    assert( false );
+    return 0;
+}
+
+/// @brief Says if the program in [first_, last_) can be run, as read from a file that may be corrupt.
+bool is_valid_program( const Instruction * first_, const Instruction * last_ )
+{
+    size_t depth = 0;
+
+    for ( ; first_ != last_; ++first_ )
+    {
+        if ( first_->op > opcode_t::SQR ) return false;
+
+        if ( first_->op == opcode_t::PUSH )
+        {
+            ++depth;
+            continue;
+        }
+
+        // The shifts by 2^k: a short int divisor is at most 2^15.
+        bool shift = first_->op == opcode_t::SHL or first_->op == opcode_t::DIV2 or first_->op == opcode_t::MOD2;
+        if ( shift ? first_->operand < 0 or first_->operand > 15 : first_->operand != 0 )
+            return false;
+
+        if ( is_unary( first_->op ) )
+        {
+            if ( depth < 1 ) return false;
+        }
+        else
+        {
+            if ( depth < 2 ) return false;
+            --depth;
+        }
+    }
+
+    return depth == 1;
+}
+
+/// @brief Runs the program in [first_, last_). Gives the same result as evaluate_postfix().
+std::pair< value_type,int > execute_program( const Instruction * first_, const Instruction * last_,
+                                             CheckCounters * counters_ )
+{
+    sc::stack< value_type > s;
+    std::uint64_t performed = 0, skipped = 0;
+    std::pair< value_type,int > answer( 0, 0 );
+
+    for ( ; first_ != last_; ++first_ )
+    {
+        if ( first_->op == opcode_t::PUSH )
+        {
+            s.push( first_->operand );
+            continue;
+        }
+
+        if ( is_unary( first_->op ) )
+        {
+            auto & top = s.top();
+            top = execute_unary( top, *first_ );
+            if ( first_->flags & unchecked_flag )
+            {
+                ++skipped;
+                continue;
+            }
+
+            ++performed;
+            if ( top < std::numeric_limits< short int >::min() or top > std::numeric_limits< short int >::max() )
+            {
+                answer = std::make_pair( top, 10 );
+                break;
+            }
+            continue;
+        }
+
+        // Recover the two operands in reverse order.
+        auto op2 = s.top(); s.pop();
+        auto op1 = s.top(); s.pop();
+
+        if ( first_->flags & unchecked_flag )
+        {
+            ++skipped;
+            s.push( execute_unchecked( op1, op2, first_->op ) );
+            continue;
+        }
+
+        ++performed;
+        auto result = execute_operator( op1, op2, symbol_of( first_->op ) );
+        s.push( result.first );
+
+        // Same error codes as evaluate_postfix().
+        if ( result.second != 0 )
+        {
+            answer = std::make_pair( s.top(), result.second < 0 ? -10 : 10 );
+            break;
+        }
+    }
+
+    if ( first_ == last_ )
+        answer = std::make_pair( s.top(), 0 );
+
+    if ( counters_ != nullptr )
+    {
+        counters_->performed += performed;
+        counters_->skipped += skipped;
+    }
+
+    return answer;
+}
+
+/// @brief Runs a whole program. Gives the same result as evaluate_postfix().
+std::pair< value_type,int > execute_program( const Program & program_, CheckCounters * counters_ )
+{
+    return execute_program( program_.data(), program_.data() + program_.size(), counters_ );
+}
@@ -0,0 +1,129 @@
+/**
+ * @file checkpoint.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Checkpoint Code
+ * @brief Progress of a run, saved so an interrupted run can resume.
+ */
+
+#include "../include/checkpoint.hpp"
+
+#include <cstddef> // offsetof
+#include <cstdio>  // std::rename
+#include <cstring> // std::memcpy, std::memcmp
+
+#include <fcntl.h>    // open
+#include <sys/stat.h> // stat
+#include <unistd.h>   // write, fsync, close
+
+namespace
+{
+    //! @brief Checksum of every field before `checksum`.
+    std::uint64_t checksum_of( const Checkpoint & ckp_ )
+    {
+        return fnv1a( &ckp_, offsetof( Checkpoint, checksum ) );
+    }
+
+    //! @brief The directory of `path_`, whose entry changes on rename.
+    std::string directory_of( const std::string & path_ )
+    {
+        auto slash = path_.find_last_of( '/' );
+        return slash == std::string::npos ? "." : slash == 0 ? "/" : path_.substr( 0, slash );
+    }
+}
+
+/// @brief A checkpoint of no progress for the run with `args_hash_` on the input `in_file_`.
+/// @return false if the input file can't be inspected.
+bool new_checkpoint( std::uint64_t args_hash_, const std::string & in_file_, Checkpoint & ckp_ )
+{
+    struct stat st;
+    if ( stat( in_file_.c_str(), &st ) != 0 ) return false;
+
+    std::memset( &ckp_, 0, sizeof( ckp_ ) );
+    std::memcpy( ckp_.magic, checkpoint_magic, sizeof( ckp_.magic ) );
+    ckp_.version = checkpoint_version;
+    ckp_.args_hash = args_hash_;
+    ckp_.input_size = static_cast< std::uint64_t >( st.st_size );
+    ckp_.input_mtime = static_cast< std::uint64_t >( st.st_mtim.tv_sec ) * 1000000000ull +
+                       static_cast< std::uint64_t >( st.st_mtim.tv_nsec );
+    return true;
+}
+
+/// @brief FNV-1a hash of a range of bytes, continuing from `hash_`.
+std::uint64_t fnv1a( const void * data_, size_t length_, std::uint64_t hash_ )
+{
+    auto bytes = static_cast< const unsigned char * >( data_ );
+    for ( size_t i = 0; i < length_; ++i )
+        hash_ = ( hash_ ^ bytes[i] ) * 0x100000001b3ull;
+    return hash_;
+}
+
+/// @brief Reads the checkpoint at `path_`. @return false if there is none or it is damaged.
+bool load_checkpoint( const std::string & path_, Checkpoint & ckp_ )
+{
+    int fd = open( path_.c_str(), O_RDONLY );
+    if ( fd < 0 ) return false;
+
+    auto got = read( fd, &ckp_, sizeof( ckp_ ) );
+    close( fd );
+
+    return got == static_cast< ssize_t >( sizeof( ckp_ ) ) and
+           std::memcmp( ckp_.magic, checkpoint_magic, sizeof( ckp_.magic ) ) == 0 and
+           ckp_.version == checkpoint_version and ckp_.checksum == checksum_of( ckp_ );
+}
+
+/*!
+ * The new checkpoint is written next to the old one, synced, and renamed
+ * over it, so a crash at any point leaves one complete checkpoint behind.
+ */
+bool save_checkpoint( const std::string & path_, Checkpoint ckp_ )
+{
+    ckp_.checksum = checksum_of( ckp_ );
+
+    auto tmp = path_ + ".tmp";
+    int fd = open( tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ) return false;
+
+    bool ok = write( fd, &ckp_, sizeof( ckp_ ) ) == static_cast< ssize_t >( sizeof( ckp_ ) ) and fsync( fd ) == 0;
+    ok = close( fd ) == 0 and ok;
+    if ( not ok or std::rename( tmp.c_str(), path_.c_str() ) != 0 )
+        return false;
+
+    // The rename itself is only durable once the directory is.
+    return sync_file( directory_of( path_ ) );
+}
+
+/// @brief Says if `saved_` was made by the run that `current_` describes.
+bool same_run( const Checkpoint & saved_, const Checkpoint & current_ )
+{
+    return saved_.args_hash == current_.args_hash and saved_.input_size == current_.input_size and
+           saved_.input_mtime == current_.input_mtime and saved_.input_offset <= saved_.input_size;
+}
+
+/// @brief Resumes from the checkpoint at `path_` if it belongs to the run `current_` describes.
+bool resume_checkpoint( const std::string & path_, const std::string & out_file_, Checkpoint & current_ )
+{
+    Checkpoint saved;
+    if ( not load_checkpoint( path_, saved ) or not same_run( saved, current_ ) )
+        return false;
+
+    // The output may have grown past the checkpoint before the run stopped, but never shrunk.
+    struct stat st;
+    if ( stat( out_file_.c_str(), &st ) != 0 or static_cast< std::uint64_t >( st.st_size ) < saved.output_offset or
+         truncate( out_file_.c_str(), static_cast< off_t >( saved.output_offset ) ) != 0 )
+        return false;
+
+    current_ = saved;
+    return true;
+}
+
+/// @brief Flushes the file at `path_` from the page cache to the disk. @return false on any error.
+bool sync_file( const std::string & path_ )
+{
+    int fd = open( path_.c_str(), O_RDONLY );
+    if ( fd < 0 ) return false;
+
+    bool ok = fsync( fd ) == 0;
+    return close( fd ) == 0 and ok;
+}
@@ -10,92 +10,1275 @@
 #include <iomanip>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <cstdlib>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <unordered_map>
+
+#include <sys/stat.h> // mkdir
 
 #include "../include/parser.hpp"
 #include "../include/infix2postfix.hpp"
+#include "../include/parallel_eval.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/binary_file.hpp"
+#include "../include/stream_parser.hpp"
+#include "../include/exact_eval.hpp"
+#include "../include/range_analysis.hpp"
+#include "../include/trace.hpp"
+#include "../include/threaded_eval.hpp"
+#include "../include/shm_ipc.hpp"
+#include "../include/shape_batch.hpp"
+#include "../include/checkpoint.hpp"
+#include "../include/sheet.hpp"
+#include "../include/simplify.hpp"
+#include "../include/file_batch.hpp"
+#include "../include/gzip_stream.hpp"
+#include "../include/explain.hpp"
 
-//! @brief Printing the error messages.
-void print_error_msg( const Parser::ResultType & result, std::string str, std::ofstream & ofs_ )
+//! @brief Lines between two checkpoints, by default.
+constexpr size_t default_checkpoint_every = 100000;
+
+//! @brief Settings chosen on the command line.
+struct Options
 {
-    std::string error_indicator( str.size()+1, ' ');
+    std::vector< std::string > files;                  //!< Positional arguments.
+    bool compile = false;                              //!< `bares compile <input> <output.bin>`.
+    bool header = false;                               //!< `bares header <input> <output.hpp>`.
+    bool serve = false;                                //!< `bares serve <name>`.
+    bool batch = false;                                //!< `bares batch <manifest|directory> <output directory>`.
+    ShmConfig shm;                                     //!< Shared memory object of `serve`.
+    bool stream = false;                               //!< Parse in chunks, without whole lines in memory.
+    bool exact = false;                                //!< Evaluate without the `short int` range limit.
+    bool stats = false;                                //!< Print evaluation counters at the end.
+    bool compiled = false;                             //!< `--engine=compiled`: run the threaded interpreter.
+    bool simplify = true;                              //!< Simplify the programs compiled for repeated use.
+    bool shapes = false;                               //!< Evaluate in batches grouped by shape.
+    bool sheet = false;                                //!< Lines are definitions that refer to each other.
+    bool compress = false;                             //!< Write the output as a gzip file.
+    bool explain = false;                              //!< Write a cost profile of each expression instead of its value.
+    size_t explain_repetitions = default_explain_repetitions; //!< Timed runs of each phase.
+    int compress_level = Z_DEFAULT_COMPRESSION;        //!< zlib level of `--compress=<level>`.
+    size_t chunk_size = default_chunk_size;            //!< Bytes read at a time when streaming.
+    size_t split_size = default_split_size;            //!< Files of a batch larger than this are split.
+    size_t parallel_workers = 0;                       //!< 0 means sequential evaluation.
+    size_t parallel_threshold = default_parallel_threshold; //!< Smaller expressions stay sequential.
+    Parser::Limits limits;                             //!< Budgets of each expression.
+    std::string trace_file;                            //!< Where to write the trace; empty means no tracing.
+    std::string checkpoint_file;                       //!< Where to keep the progress; empty means nowhere.
+    size_t checkpoint_every = default_checkpoint_every; //!< Lines between checkpoints.
+    std::uint64_t args_hash = 0;                       //!< Tells the runs apart; see resume_checkpoint().
+};
 
-    // Have we got a parsing error?
-    error_indicator[result.at_col] = '^';
+//! @brief Counters printed by `--stats`.
+struct RunStats
+{
+    size_t lines = 0;           //!< Expressions read.
+    size_t rejected = 0;        //!< Expressions over one of the limits.
+    CheckCounters checks;       //!< Range checks of compiled programs.
+    bool counts_checks = false; //!< Only execute_program() fills `checks`; other engines check every operation.
+};
+
+//! @brief Reads the value of a `--name=value` option as a count.
+bool read_count( const std::string & arg_, size_t & count_ )
+{
+    auto eq = arg_.find( '=' );
+    if ( eq == std::string::npos or eq + 1 == arg_.size() ) return false;
+
+    char * end;
+    count_ = std::strtoul( arg_.c_str() + eq + 1, &end, 10 );
+    return *end == '\0';
+}
+
+//! @brief Splits the command line into options and positional arguments.
+bool parse_options( int argc, char **argv, Options & opt_ )
+{
+    // `serve` only takes the limits and its own options, which no other mode takes.
+    bool serve_options = false, other_options = false;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string arg( argv[i] );
+
+        if ( arg.compare( 0, 10, "--clients=" ) == 0 or arg.compare( 0, 12, "--ring-size=" ) == 0 or arg == "--spin" )
+            serve_options = true;
+        else if ( arg.compare( 0, 2, "--" ) == 0 and arg.compare( 0, 6, "--max-" ) != 0 )
+            other_options = true;
+
+        // How often checkpoints are made does not change the run they belong to.
+        if ( arg.compare( 0, 19, "--checkpoint-every=" ) != 0 )
+            opt_.args_hash = fnv1a( arg.c_str(), arg.size() + 1, opt_.args_hash );
+
+        if ( arg.compare( 0, 2, "--" ) != 0 )
+            opt_.files.push_back( arg );
+        else if ( arg == "--parallel" )
+            opt_.parallel_workers = std::thread::hardware_concurrency();
+        else if ( arg.compare( 0, 11, "--parallel=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.parallel_workers ) ) return false;
+        }
+        else if ( arg.compare( 0, 21, "--parallel-threshold=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.parallel_threshold ) ) return false;
+        }
+        else if ( arg == "--stream" )
+            opt_.stream = true;
+        else if ( arg == "--exact" )
+            opt_.exact = true;
+        else if ( arg == "--stats" )
+            opt_.stats = true;
+        else if ( arg == "--batch-shapes" )
+            opt_.shapes = true;
+        else if ( arg == "--sheet" )
+            opt_.sheet = true;
+        else if ( arg == "--engine=classic" or arg == "--engine=compiled" )
+            opt_.compiled = arg == "--engine=compiled";
+        else if ( arg == "--compress" )
+            opt_.compress = true;
+        else if ( arg.compare( 0, 11, "--compress=" ) == 0 )
+        {
+            size_t level;
+            if ( not read_count( arg, level ) or level < 1 or level > 9 ) return false;
+            opt_.compress = true;
+            opt_.compress_level = static_cast< int >( level );
+        }
+        else if ( arg == "--explain" )
+            opt_.explain = true;
+        else if ( arg.compare( 0, 10, "--explain=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.explain_repetitions ) or opt_.explain_repetitions == 0 ) return false;
+            opt_.explain = true;
+        }
+        else if ( arg == "--no-simplify" )
+            opt_.simplify = false;
+        else if ( arg.compare( 0, 13, "--chunk-size=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.chunk_size ) or opt_.chunk_size == 0 ) return false;
+        }
+        else if ( arg.compare( 0, 13, "--split-size=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.split_size ) or opt_.split_size == 0 ) return false;
+        }
+        else if ( arg.compare( 0, 10, "--clients=" ) == 0 )
+        {
+            size_t clients;
+            if ( not read_count( arg, clients ) or clients == 0 or clients > 1024 ) return false;
+            opt_.shm.slots = static_cast< std::uint32_t >( clients );
+        }
+        else if ( arg.compare( 0, 12, "--ring-size=" ) == 0 )
+        {
+            size_t bytes;
+            if ( not read_count( arg, bytes ) ) return false;
+            opt_.shm.ring_bytes = bytes;
+        }
+        else if ( arg == "--spin" )
+            opt_.shm.blocking = false;
+        else if ( arg.compare( 0, 13, "--checkpoint=" ) == 0 )
+        {
+            opt_.checkpoint_file = arg.substr( 13 );
+            if ( opt_.checkpoint_file.empty() ) return false;
+        }
+        else if ( arg.compare( 0, 19, "--checkpoint-every=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.checkpoint_every ) or opt_.checkpoint_every == 0 ) return false;
+        }
+        else if ( arg.compare( 0, 8, "--trace=" ) == 0 )
+        {
+            opt_.trace_file = arg.substr( 8 );
+            if ( opt_.trace_file.empty() ) return false;
+        }
+        else if ( arg.compare( 0, 12, "--max-bytes=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.limits.max_bytes ) ) return false;
+        }
+        else if ( arg.compare( 0, 13, "--max-tokens=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.limits.max_tokens ) ) return false;
+        }
+        else if ( arg.compare( 0, 12, "--max-depth=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.limits.max_depth ) ) return false;
+        }
+        else if ( arg.compare( 0, 12, "--max-steps=" ) == 0 )
+        {
+            if ( not read_count( arg, opt_.limits.max_steps ) ) return false;
+        }
+        else
+            return false;
+    }
+
+    if ( opt_.files.size() == 3 and opt_.files[0] == "compile" )
+    {
+        opt_.compile = true;
+        opt_.files.erase( opt_.files.begin() );
+    }
+    else if ( opt_.files.size() == 3 and opt_.files[0] == "header" )
+    {
+        opt_.header = true;
+        opt_.files.erase( opt_.files.begin() );
+    }
+    else if ( opt_.files.size() == 3 and opt_.files[0] == "batch" )
+    {
+        opt_.batch = true;
+        opt_.files.erase( opt_.files.begin() );
+    }
+
+    if ( opt_.files.size() == 2 and opt_.files[0] == "serve" )
+    {
+        opt_.serve = true;
+        return not other_options;
+    }
+
+    if ( serve_options ) return false;
+
+    // The streaming evaluator works on words only.
+    if ( opt_.exact and opt_.stream ) return false;
+
+    // The threaded interpreter runs whole programs, on words, in one thread; a batch spreads files, not programs.
+    if ( opt_.compiled and ( opt_.exact or opt_.stream or ( opt_.parallel_workers > 0 and not opt_.batch ) ) ) return false;
+
+    // Checkpoints are made by the line by line loop only.
+    if ( not opt_.checkpoint_file.empty() and ( opt_.stream or opt_.shapes ) ) return false;
+
+    // Shape batches evaluate whole lines, on words, in one thread, with their own evaluator.
+    if ( opt_.shapes and ( opt_.exact or opt_.stream or opt_.parallel_workers > 0 or opt_.compiled ) ) return false;
+
+    // A sheet is evaluated on words, by its own evaluator, in dependency order.
+    if ( opt_.sheet and ( opt_.exact or opt_.stream or opt_.compiled or opt_.shapes or not opt_.checkpoint_file.empty() ) )
+        return false;
+
+    // A batch evaluates whole lines of many files at once, each file by the line by line rules; it keeps no counters or trace.
+    if ( opt_.batch and ( opt_.stream or opt_.shapes or opt_.sheet or not opt_.checkpoint_file.empty() or
+                          opt_.stats or not opt_.trace_file.empty() ) )
+        return false;
+
+    // Explaining runs every engine itself, on words, one line at a time.
+    if ( opt_.explain and ( opt_.exact or opt_.stream or opt_.compiled or opt_.shapes or opt_.sheet or opt_.batch or
+                            opt_.parallel_workers > 0 or not opt_.checkpoint_file.empty() ) )
+        return false;
+
+    // Only the evaluation of a single file writes through a compressed stream.
+    if ( opt_.compress and ( opt_.batch or opt_.compile or opt_.header ) ) return false;
+
+    return opt_.files.size() == 2;
+}
+
+//! @brief The message written for a parsing error.
+std::string error_message( const Parser::ResultType & result )
+{
+    std::ostringstream msg;
     switch ( result.type )
     {
         case Parser::ResultType::UNEXPECTED_END_OF_EXPRESSION:
-			std::cout << ">>> Unexpected end of input at column (" << result.at_col + 1 << ")!\n";
-			ofs_ << "Unexpected end of input at column (" << result.at_col + 1 << ")!\n";
+            msg << "Unexpected end of input at column (" << result.at_col + 1 << ")!";
             break;
         case Parser::ResultType::ILL_FORMED_INTEGER:
-			std::cout << ">>> Ill formed integer at column (" << result.at_col + 1 << ")!\n";
-			ofs_ << "Ill formed integer at column (" << result.at_col + 1 << ")!\n";
+            msg << "Ill formed integer at column (" << result.at_col + 1 << ")!";
             break;
         case Parser::ResultType::MISSING_TERM:
-            std::cout << ">>> Missing <term> at column (" << result.at_col + 1 << ")!\n";
-            ofs_ << "Missing <term> at column (" << result.at_col + 1 << ")!\n";
-			break;
+            msg << "Missing <term> at column (" << result.at_col + 1 << ")!";
+            break;
         case Parser::ResultType::EXTRANEOUS_SYMBOL:
-            std::cout << ">>> Extraneous symbol after valid expression found at column (" << result.at_col + 1 << ")!\n";
-            ofs_ << "Extraneous symbol after valid expression found at column (" << result.at_col + 1 << ")!\n";
+            msg << "Extraneous symbol after valid expression found at column (" << result.at_col + 1 << ")!";
             break;
         case Parser::ResultType::INTEGER_OUT_OF_RANGE:
-            std::cout << ">>> Integer constant out of range beginning at column (" << result.at_col + 1 << ")!\n";
-            ofs_ << "Integer constant out of range beginning at column (" << result.at_col + 1 << ")!\n";
+            msg << "Integer constant out of range beginning at column (" << result.at_col + 1 << ")!";
             break;
-		case Parser::ResultType::MISSING_CLOSING_SCOPE:
-            std::cout << ">>> Missing closing \")\" at column (" << result.at_col + 1 << ")!\n";
-            ofs_ << "Missing closing \")\" at column (" << result.at_col + 1 << ")!\n";
+        case Parser::ResultType::MISSING_CLOSING_SCOPE:
+            msg << "Missing closing \")\" at column (" << result.at_col + 1 << ")!";
             break;
-		default:
-            std::cout << ">>> Unhandled error found!\n";
-            ofs_ << "Unhandled error found!\n";
+        case Parser::ResultType::LIMIT_EXCEEDED:
+            msg << "Expression exceeds a complexity limit at column (" << result.at_col + 1 << ")!";
+            break;
+        default:
+            msg << "Unhandled error found!";
             break;
     }
 
+    return msg.str();
+}
+
+//! @brief Printing the error message `msg`, pointing at column `at_col` of `str`.
+void print_error_msg( const std::string & msg, size_t at_col, const std::string & str, std::ostream & ofs_ )
+{
+    std::string error_indicator( str.size()+1, ' ');
+    error_indicator[at_col] = '^';
+
+    std::cout << ">>> " << msg << "\n";
+    ofs_ << msg << "\n";
+
     std::cout << "\"" << str << "\"\n";
     std::cout << " " << error_indicator << std::endl;
 }
 
+//! @brief Printing the error messages.
+void print_error_msg( const Parser::ResultType & result, std::string str, std::ostream & ofs_ )
+{
+    // Have we got a parsing error?
+    print_error_msg( error_message( result ), result.at_col, str, ofs_ );
+}
+
+//! @brief The text of an answer value.
+inline std::string value_text( value_type value_ ) { return std::to_string( value_ ); }
+
+//! @brief The text of an exact answer value.
+inline std::string value_text( const ExactValue & value_ )
+{
+    std::ostringstream text;
+    text << value_;
+    return text.str();
+}
+
+//! @brief The line written to the output file for an evaluated expression, without the newline.
+template < typename T >
+std::string answer_text( const std::pair< T,int > & answer )
+{
+    if( answer.second < 0) return "Division by zero!";
+    if( answer.second > 0) return "Numeric overflow error!";
+    return value_text( answer.first );
+}
+
+//! @brief Printing the value of an evaluated expression, or its evaluation error.
+template < typename T >
+void print_answer( const std::pair< T,int > & answer, std::ostream & ofs_ )
+{
+    auto text = answer_text( answer );
+    if( answer.second == 0 )
+        std::cout << "Expression results in: ";
+    std::cout << text << "\n";
+    ofs_ << text << "\n";
+}
+
+//! @brief Printing the `--stats` counters and the limits in force.
+void print_stats( const RunStats & stats_, const Parser::Limits & limits_ )
+{
+    auto limit = []( size_t value_ )
+    {
+        return value_ == Parser::Limits::unlimited ? std::string( "none" ) : std::to_string( value_ );
+    };
+
+    std::cout << "\n>>> Expressions: " << stats_.lines << ", rejected by limits: " << stats_.rejected << "\n";
+    std::cout << ">>> Limits: bytes " << limit( limits_.max_bytes ) << ", tokens " << limit( limits_.max_tokens )
+              << ", depth " << limit( limits_.max_depth ) << ", steps " << limit( limits_.max_steps ) << "\n";
+    if ( stats_.counts_checks )
+        std::cout << ">>> Range checks performed: " << stats_.checks.performed
+                  << ", skipped: " << stats_.checks.skipped << "\n";
+}
+
+//! @brief Starts tracing if a trace file was asked for, and writes that file when destroyed.
+struct TraceSession
+{
+    std::string path;
+
+    explicit TraceSession( const std::string & path_ ) : path( path_ )
+    {
+        if( not path.empty() ) trace_start();
+    }
+
+    ~TraceSession()
+    {
+        if( not path.empty() and not trace_write_json( path ) )
+            std::cerr << "Could not write the trace file \"" << path << "\"!\n";
+    }
+};
+
+//! @brief getline(), traced as the "read" phase of line `number_ + 1`, which becomes `number_`.
+bool read_line( std::istream & is_, std::string & line_, std::uint64_t & number_ )
+{
+    trace_set_line( ++number_ );
+    TraceSpan span( "read" );
+    return static_cast< bool >( std::getline( is_, line_ ) );
+}
+
+//! @brief Parses and compiles every line of `in_file_` into the binary file `out_file_`.
+int compile_expressions( const std::string & in_file_, const std::string & out_file_, bool simplify_ )
+{
+    std::ifstream ifs( in_file_.c_str() );
+    BinaryWriter writer;
+
+    if( not ifs or not writer.open( out_file_ ) )
+    {
+        std::cerr << "Could not open the input or the output file!\n";
+        return -1;
+    }
+
+    Parser my_parser;
+    std::string expression;
+    size_t count = 0;
+    RangeAnalysis analysis;
+    SimplifyStats rewrites;
+    while( getline( ifs, expression ) )
+    {
+        auto result = my_parser.parse( expression );
+
+        // Lines with errors are kept too, so the output can be reproduced.
+        // As far as the parser got: a line with an error is over a limit if it went past it first.
+        auto tokens = my_parser.get_tokens();
+        LineCounts counts;
+        counts.tokens = tokens.size();
+        counts.steps = my_parser.get_steps();
+        counts.depth = my_parser.get_nesting();
+
+        Program program;
+        if( result.type == Parser::ResultType::OK )
+        {
+            program = compile_postfix( infix2postfix( std::move( tokens ) ) );
+
+            if( simplify_ )
+            {
+                auto done = simplify_program( program );
+                rewrites.removed += done.removed;
+                rewrites.negations += done.negations;
+                rewrites.reduced += done.reduced;
+                rewrites.folded += done.folded;
+            }
+
+            // The operations proved safe are stored already marked.
+            auto marked = mark_unchecked( program );
+            analysis.operations += marked.operations;
+            analysis.unchecked += marked.unchecked;
+        }
+
+        // Sources and programs are stored with 32-bit lengths.
+        if( not writer.append( result, expression, program, counts ) )
+        {
+            std::cerr << "Line " << count + 1 << " is too long for a binary file!\n";
+            return -1;
+        }
+        ++count;
+    }
+
+    if( not writer.close() )
+    {
+        std::cerr << "Could not write \"" << out_file_ << "\"!\n";
+        return -1;
+    }
+
+    std::cout << ">>> " << count << " expressions compiled into \"" << out_file_ << "\".\n";
+    if( simplify_ )
+        std::cout << ">>> Simplified: " << rewrites.removed << " operations removed, " << rewrites.negations
+                  << " made negations, " << rewrites.reduced << " made cheaper, " << rewrites.folded << " folded.\n";
+    std::cout << ">>> " << analysis.unchecked << " of " << analysis.operations
+              << " operations proved safe; they will run unchecked.\n";
+    return EXIT_SUCCESS;
+}
+
+//! @brief `str_` as a C++ string literal; octal escapes keep any byte intact.
+std::string cpp_literal( const std::string & str_ )
+{
+    std::ostringstream lit;
+    lit << '"';
+    for ( unsigned char c : str_ )
+    {
+        if ( c == '"' or c == '\\' )
+            lit << '\\' << c;
+        else if ( c < ' ' or c > '~' or c == '?' ) // '?' would make trigraphs.
+            lit << '\\' << std::oct << std::setw( 3 ) << std::setfill( '0' ) << int( c ) << std::dec;
+        else
+            lit << c;
+    }
+    lit << '"';
+    return lit.str();
+}
+
+//! @brief Writes a header with every line of `in_file_` evaluated at compile time by bares_constexpr.hpp.
+/*!
+ * Each result is checked with a static_assert against the one this
+ * program finds at run time, so the header does not compile if the two
+ * engines ever disagree.
+ */
+int generate_header( const std::string & in_file_, const std::string & out_file_ )
+{
+    std::ifstream ifs( in_file_.c_str() );
+    std::ofstream ofs( out_file_.c_str() );
+
+    if( not ifs or not ofs )
+    {
+        std::cerr << "Could not open the input or the output file!\n";
+        return -1;
+    }
+
+    // The namespace and the include guard come from the name of the output file.
+    auto stem = out_file_.substr( out_file_.find_last_of( '/' ) + 1 );
+    stem = stem.substr( 0, stem.find( '.' ) );
+    std::string name;
+    for ( auto c : stem )
+        name += std::isalnum( static_cast< unsigned char >( c ) ) ? c : '_';
+    if ( name.empty() or std::isdigit( static_cast< unsigned char >( name[0] ) ) )
+        name = "bares_" + name;
+    std::string guard;
+    for ( auto c : name )
+        guard += static_cast< char >( std::toupper( static_cast< unsigned char >( c ) ) );
+    guard = "_" + guard + "_HPP_";
+
+    ofs << "// Generated by `bares header " << in_file_ << " " << out_file_ << "`. Do not edit.\n\n";
+    ofs << "#ifndef " << guard << "\n#define " << guard << "\n\n";
+    ofs << "#include \"bares_constexpr.hpp\"\n\n";
+    ofs << "namespace " << name << "\n{\n";
+    ofs << "    //! Results of the lines of \"" << in_file_ << "\", in order.\n";
+    ofs << "    constexpr bares::Result results[] =\n    {\n";
+
+    Parser my_parser;
+    std::string expression;
+    std::ostringstream checks;
+    size_t count = 0;
+    while( getline( ifs, expression ) )
+    {
+        auto result = my_parser.parse( expression );
+
+        std::pair< value_type,int > answer( 0, 0 );
+        if( result.type == Parser::ResultType::OK )
+            answer = evaluate_postfix( infix2postfix( my_parser.get_tokens() ) );
+
+        ofs << "        bares::evaluate( " << cpp_literal( expression ) << " ),\n";
+
+        // The value is only meaningful if there was no error at all.
+        auto value = result.type == Parser::ResultType::OK and answer.second == 0 ? answer.first : 0;
+        checks << "    static_assert( results[" << count << "].code == bares::code_t( " << int( result.type ) << " )"
+               << " and results[" << count << "].at_col == " << ( result.type == Parser::ResultType::OK ? 0 : result.at_col )
+               << " and results[" << count << "].eval == " << answer.second
+               << " and ( not results[" << count << "].ok() or results[" << count << "].value == " << value << " ),"
+               << " \"line " << count + 1 << "\" );\n";
+        ++count;
+    }
+
+    // An empty array is not valid C++.
+    if( count == 0 )
+        ofs << "        bares::Result()\n";
+
+    ofs << "    };\n\n";
+    ofs << "    constexpr std::size_t size = " << count << ";\n\n";
+    ofs << "    // Same results as the runtime engine.\n" << checks.str();
+    ofs << "}\n\n#endif\n";
+
+    if( not ofs )
+    {
+        std::cerr << "Could not write \"" << out_file_ << "\"!\n";
+        return -1;
+    }
+
+    std::cout << ">>> " << count << " expressions evaluated into \"" << out_file_ << "\".\n";
+    return EXIT_SUCCESS;
+}
+
+//! @brief Evaluates the records of a binary expression file, skipping lexing and parsing.
+int evaluate_binary( const std::string & in_file_, std::ostream & ofs_, const Options & opt_ )
+{
+    BinaryReader reader;
+    if( not reader.open( in_file_ ) )
+    {
+        std::cerr << "\"" << in_file_ << "\" is not a valid binary expression file!\n";
+        return -1;
+    }
+
+    RunStats stats;
+    stats.counts_checks = not opt_.compiled;
+    for( auto i(0u); i < reader.size(); ++i )
+    {
+        auto rec = reader.record( i );
+        ++stats.lines;
+        std::string expression( rec.source, rec.source_length );
+
+        trace_set_line( i + 1 );
+        TraceSpan whole( "expression" );
+
+        std::cout << std::setfill('=') << std::setw(80) << "\n";
+        std::cout << std::setfill(' ') << ">>> Parsing \"" << expression << "\"\n";
+
+        // Records were parsed when compiled, without limits; the budgets still hold for
+        // them. A line over one is parsed again, so its error is the one a text input gives.
+        if( rec.source_length > opt_.limits.max_bytes or rec.counts.tokens > opt_.limits.max_tokens or
+            rec.counts.depth > opt_.limits.max_depth or rec.counts.steps > opt_.limits.max_steps )
+        {
+            Parser limited( opt_.limits );
+            rec.result = limited.parse( expression );
+            if( rec.result.type == Parser::ResultType::LIMIT_EXCEEDED ) ++stats.rejected;
+        }
+
+        if( rec.result.type != Parser::ResultType::OK )
+        {
+            print_error_msg( rec.result, expression, ofs_ );
+            continue;
+        }
+
+        std::pair< value_type,int > answer;
+        if( opt_.compiled )
+        {
+            auto program = traced( "decode_program", [&](){
+                return decode_program( rec.program, rec.program + rec.program_length ); } );
+            answer = traced( "execute_threaded", [&](){ return execute_threaded( program ); } );
+        }
+        else
+            answer = traced( "execute_program", [&](){
+                return execute_program( rec.program, rec.program + rec.program_length, &stats.checks ); } );
+        traced( "write", [&](){ print_answer( answer, ofs_ ); } );
+    }
+
+    if( opt_.stats )
+        print_stats( stats, opt_.limits );
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return EXIT_SUCCESS;
+}
+
+//! @brief Parses and evaluates the input in fixed-size chunks; no whole line is ever kept.
+int evaluate_stream( std::istream & ifs_, std::ostream & ofs_, const Options & opt_ )
+{
+    ChunkSource source( ifs_, opt_.chunk_size );
+    StreamParser parser( opt_.limits );
+    std::uint64_t line = 0;
+    RunStats stats;
+
+    while( source.has_line() )
+    {
+        trace_set_line( ++line );
+        TraceSpan whole( "expression" );
+
+        // Reading, parsing and evaluation happen together here.
+        auto out = traced( "stream_parse", [&](){ return parser.parse( source ); } );
+
+        std::cout << std::setfill('=') << std::setw(80) << "\n";
+        std::cout << std::setfill(' ') << ">>> Streaming line " << line << "\n";
+
+        if( out.result.type == Parser::ResultType::LIMIT_EXCEEDED )
+            ++stats.rejected;
+
+        if( out.result.type != Parser::ResultType::OK )
+        {
+            auto msg = error_message( out.result );
+            std::cout << ">>> " << msg << "\n";
+            ofs_ << msg << "\n";
+            continue;
+        }
+
+        traced( "write", [&](){ print_answer( out.answer, ofs_ ); } );
+    }
+
+    if( opt_.stats )
+    {
+        stats.lines = line;
+        print_stats( stats, opt_.limits );
+    }
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return EXIT_SUCCESS;
+}
+
+//! @brief Lines read, and grouped by shape, at a time by `--batch-shapes`.
+constexpr size_t shape_batch_lines = 1u << 16;
+
+//! @brief Evaluates the input in batches of lines, grouping the expressions by shape (see ShapeBatch).
+int evaluate_shapes( std::istream & ifs_, std::ostream & ofs_, const Options & opt_ )
+{
+    using ms = std::chrono::duration< double, std::milli >;
+
+    Parser parser( opt_.limits );
+    ShapeBatch batch;
+    RunStats stats;
+    std::uint64_t line = 0;
+    std::vector< std::string > lines;
+    std::vector< Parser::ResultType > results;
+    std::vector< std::vector< Token > > kept; // Only for `--stats`, to time the line by line evaluation.
+    double by_shape = 0, by_line = 0;
+
+    std::string expression;
+    while( true )
+    {
+        lines.clear();
+        results.clear();
+        kept.clear();
+
+        while( lines.size() < shape_batch_lines and read_line( ifs_, expression, line ) )
+        {
+            auto result = traced( "parse", [&](){ return parser.parse( expression ); } );
+            if( result.type == Parser::ResultType::OK )
+            {
+                auto tokens = parser.get_tokens();
+                auto start = std::chrono::steady_clock::now();
+                batch.add( tokens );
+                by_shape += ms( std::chrono::steady_clock::now() - start ).count();
+
+                if( opt_.stats ) kept.push_back( std::move( tokens ) );
+            }
+            lines.push_back( expression );
+            results.push_back( result );
+        }
+        if( lines.empty() ) break;
+
+        auto start = std::chrono::steady_clock::now();
+        auto answers = traced( "evaluate_shapes", [&](){ return batch.evaluate(); } );
+        by_shape += ms( std::chrono::steady_clock::now() - start ).count();
+
+        if( opt_.stats )
+        {
+            // What the default mode does with each line after parsing it.
+            start = std::chrono::steady_clock::now();
+            volatile value_type sink = 0;
+            for( const auto & tokens : kept )
+                sink = sink + evaluate_postfix( infix2postfix( tokens ) ).first;
+            by_line += ms( std::chrono::steady_clock::now() - start ).count();
+        }
+
+        // Back in the original order.
+        auto answer = answers.begin();
+        for( auto i(0u); i < lines.size(); ++i )
+        {
+            ++stats.lines;
+            std::cout << std::setfill('=') << std::setw(80) << "\n";
+            std::cout << std::setfill(' ') << ">>> Parsing \"" << lines[i] << "\"\n";
+
+            if( results[i].type == Parser::ResultType::LIMIT_EXCEEDED )
+                ++stats.rejected;
+
+            if( results[i].type != Parser::ResultType::OK )
+                print_error_msg( results[i], lines[i], ofs_ );
+            else
+                print_answer( *answer++, ofs_ );
+        }
+    }
+
+    if( opt_.stats )
+    {
+        print_stats( stats, opt_.limits );
+        std::cout << ">>> Distinct shapes: " << batch.shapes() << "\n";
+        std::cout << ">>> Evaluation by shape: " << by_shape << " ms, line by line: " << by_line << " ms"
+                  << " (speedup " << ( by_shape > 0 ? by_line / by_shape : 0 ) << "x)\n";
+    }
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return EXIT_SUCCESS;
+}
+
+//! @brief Evaluates a `--sheet`, whose lines are definitions `name = expression`, in dependency order.
+/*!
+ * Every definition is parsed first; the sheet then evaluates them level
+ * by level, on `pool_` if there is one. The answers are written in the
+ * order of the lines, one per line, as in the other modes. A name defined
+ * twice keeps its first definition.
+ */
+int evaluate_sheet( std::istream & ifs_, std::ostream & ofs_, const Options & opt_, ThreadPool * pool_ )
+{
+    //! One line of the sheet.
+    struct Entry
+    {
+        std::string text;                //!< The line itself.
+        bool definition = false;         //!< Whether it has the form `name = expression`.
+        std::string name;                //!< Name it defines.
+        size_t column = 0;               //!< Where its expression starts, or where it went wrong.
+        Parser::ResultType parsed;       //!< Result of parsing the expression.
+        std::uint64_t defined_at = 0;    //!< Line of an earlier definition of the same name, if any.
+    };
+
+    Sheet sheet( pool_ );
+    sheet.set_limits( opt_.limits );
+    RunStats stats;
+    std::vector< Entry > entries;
+    std::unordered_map< std::string, std::uint64_t > first_line;
+
+    std::string expression;
+    std::uint64_t line = 0;
+    while( read_line( ifs_, expression, line ) )
+    {
+        Entry e;
+        e.text = expression;
+        std::string body;
+        e.definition = parse_definition( expression, e.name, body, e.column );
+        if( e.definition )
+        {
+            auto seen = first_line.emplace( e.name, line );
+            if( not seen.second )
+                e.defined_at = seen.first->second;
+            else
+                e.parsed = traced( "parse", [&](){ return sheet.define( e.name, body ); } );
+        }
+        entries.push_back( std::move( e ) );
+    }
+
+    traced( "recompute", [&](){ sheet.recompute(); } );
+
+    for( const auto & e : entries )
+    {
+        ++stats.lines;
+        std::cout << std::setfill('=') << std::setw(80) << "\n";
+        std::cout << std::setfill(' ') << ">>> Parsing \"" << e.text << "\"\n";
+
+        if( not e.definition )
+        {
+            print_error_msg( "Expected a definition <name> = <expression> at column (" + std::to_string( e.column + 1 ) + ")!",
+                             e.column, e.text, ofs_ );
+            continue;
+        }
+        if( e.defined_at != 0 )
+        {
+            print_error_msg( "Name \"" + e.name + "\" already defined in line " + std::to_string( e.defined_at ) + "!",
+                             e.text.find( e.name ), e.text, ofs_ );
+            continue;
+        }
+        if( e.parsed.type != Parser::ResultType::OK )
+        {
+            if( e.parsed.type == Parser::ResultType::LIMIT_EXCEEDED ) ++stats.rejected;
+
+            // Columns are counted in the whole line.
+            Parser::ResultType at_line( e.parsed.type, e.parsed.at_col + static_cast< Parser::ResultType::size_type >( e.column ) );
+            print_error_msg( at_line, e.text, ofs_ );
+            continue;
+        }
+
+        auto id = sheet.find( e.name );
+        const auto & cell = sheet.cell( id );
+        switch( cell.status )
+        {
+            case Sheet::status_t::CYCLE:
+            {
+                std::string path;
+                for( auto step : sheet.cycle_of( id ) )
+                    path += ( path.empty() ? "" : " -> " ) + sheet.name( step );
+                print_error_msg( "Circular definition: " + path + "!", e.column, e.text, ofs_ );
+                break;
+            }
+            case Sheet::status_t::BAD_REFERENCE:
+            {
+                const auto & blame = sheet.name( cell.blame );
+                auto msg = sheet.cell( cell.blame ).defined ? "\"" + blame + "\" has no value!"
+                                                            : "Undefined name \"" + blame + "\"!";
+                print_error_msg( msg, e.column, e.text, ofs_ );
+                break;
+            }
+            default:
+                print_answer( cell.answer, ofs_ );
+                break;
+        }
+    }
+
+    if( opt_.stats ) print_stats( stats, opt_.limits );
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return EXIT_SUCCESS;
+}
+
+//! @return Bytes of the UTF-8 sequence at `i_` of `str_`, or 0 if it is not valid UTF-8.
+size_t utf8_length( const std::string & str_, size_t i_ )
+{
+    auto byte = [&]( size_t k_ ){ return static_cast< unsigned char >( str_[ i_ + k_ ] ); };
+    auto c = byte( 0 );
+
+    // Lead byte: length, and the range of the second byte that rules out
+    // overlong forms, surrogates and code points past U+10FFFF.
+    size_t length = 0;
+    unsigned char lo = 0x80, hi = 0xBF;
+    if ( c < 0x80 ) return 1;
+    else if ( c >= 0xC2 and c <= 0xDF ) length = 2;
+    else if ( c >= 0xE0 and c <= 0xEF ) { length = 3; if ( c == 0xE0 ) lo = 0xA0; if ( c == 0xED ) hi = 0x9F; }
+    else if ( c >= 0xF0 and c <= 0xF4 ) { length = 4; if ( c == 0xF0 ) lo = 0x90; if ( c == 0xF4 ) hi = 0x8F; }
+    else return 0;
+
+    if ( i_ + length > str_.size() or byte( 1 ) < lo or byte( 1 ) > hi ) return 0;
+    for ( auto k(2u); k < length; ++k )
+        if ( byte( k ) < 0x80 or byte( k ) > 0xBF ) return 0;
+    return length;
+}
+
+//! @brief `str_` as a JSON string. A byte that is not part of valid UTF-8 becomes \u00XX, the code point of its value.
+std::string json_string( const std::string & str_ )
+{
+    std::ostringstream lit;
+    lit << '"' << std::hex << std::setfill( '0' );
+    for ( size_t i = 0; i < str_.size(); )
+    {
+        unsigned char c = str_[i];
+        auto length = utf8_length( str_, i );
+        if ( c == '"' or c == '\\' )
+            lit << '\\' << c;
+        else if ( c < ' ' or length == 0 )
+            lit << "\\u" << std::setw( 4 ) << int( c );
+        else
+            lit.write( str_.data() + i, length );
+        i += length > 0 ? length : 1;
+    }
+    lit << '"';
+    return lit.str();
+}
+
+//! @brief Writes the profile `e_` of line `line_` as one line of JSON.
+void write_explanation( std::ostream & os_, std::uint64_t line_, const std::string & expression_,
+                        const Explanation & e_, size_t repetitions_ )
+{
+    auto phase = [&]( const char * name_, const PhaseTime & t_ ){
+        os_ << "\"" << name_ << "\":{\"median\":" << t_.median << ",\"best\":" << t_.best << "}"; };
+
+    os_ << std::fixed << std::setprecision( 1 );
+    os_ << "{\"line\":" << line_ << ",\"expression\":" << json_string( expression_ ) << ",\"bytes\":" << e_.bytes
+        << ",\"tokens\":" << e_.tokens << ",\"repetitions\":" << repetitions_;
+
+    if( e_.result.type != Parser::ResultType::OK )
+    {
+        os_ << ",\"status\":\"error\",\"error\":" << json_string( error_message( e_.result ) ) << ",\"ns\":{";
+        phase( "parse", e_.parse );
+        os_ << "}}\n";
+        return;
+    }
+
+    os_ << ",\"status\":\"ok\",\"result\":" << json_string( answer_text( e_.answer ) )
+        << ",\"nesting\":" << e_.nesting << ",\"unary_minus_rewrites\":" << e_.unary_rewrites
+        << ",\"postfix_length\":" << e_.postfix_length << ",\"instructions\":" << e_.instructions
+        << ",\"stack_peak\":{\"infix2postfix\":" << e_.stack_peak.operators
+        << ",\"evaluate_postfix\":" << e_.stack_peak.values << "}";
+
+    os_ << ",\"ns\":{";
+    phase( "parse", e_.parse );         os_ << ",";
+    phase( "infix2postfix", e_.infix2postfix ); os_ << ",";
+    phase( "evaluate_postfix", e_.evaluate ); os_ << ",";
+    phase( "fused", e_.fused );         os_ << ",";
+    phase( "compile", e_.compile );     os_ << ",";
+    phase( "execute_threaded", e_.execute );
+    os_ << "}";
+
+    const engine_t engines[] = { engine_t::CLASSIC, engine_t::FUSED, engine_t::COMPILED };
+    os_ << ",\"engines\":{";
+    for( auto engine : engines )
+        os_ << ( engine == engine_t::CLASSIC ? "" : "," ) << "\"" << engine_name( engine ) << "\":{\"once\":"
+            << e_.engine_time( engine ) << ",\"reused\":" << e_.reused_time( engine ) << "}";
+    os_ << "},\"fastest\":\"" << engine_name( e_.fastest ) << "\",\"fastest_reused\":\""
+        << engine_name( e_.fastest_reused ) << "\",\"engines_agree\":" << ( e_.engines_agree ? "true" : "false" ) << "}\n";
+}
+
+//! @brief Writes a JSON line with the cost profile of each expression of the input.
+int explain_expressions( std::istream & ifs_, std::ostream & ofs_, const Options & opt_ )
+{
+    std::string expression;
+    std::uint64_t line = 0;
+    size_t counts[3] = { 0, 0, 0 }; // Lines each engine is the fastest for.
+    bool agree = true;
+
+    while( read_line( ifs_, expression, line ) )
+    {
+        auto e = explain_expression( expression, opt_.limits, opt_.explain_repetitions );
+        write_explanation( ofs_, line, expression, e, opt_.explain_repetitions );
+
+        std::cout << ">>> Line " << line << ": ";
+        if( e.result.type != Parser::ResultType::OK )
+        {
+            std::cout << error_message( e.result ) << "\n";
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision( 1 ) << e.tokens << " tokens, fastest "
+                  << engine_name( e.fastest ) << " (" << e.engine_time( e.fastest ) << " ns), "
+                  << engine_name( e.fastest_reused ) << " when evaluated again ("
+                  << e.reused_time( e.fastest_reused ) << " ns)\n";
+        ++counts[ static_cast< int >( e.fastest ) ];
+        agree = agree and e.engines_agree;
+    }
+
+    std::cout << "\n>>> Fastest engine: classic for " << counts[0] << " lines, fused for " << counts[1]
+              << ", compiled for " << counts[2] << "\n";
+    if( not agree )
+        std::cerr << "The engines gave different answers; see \"engines_agree\"!\n";
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return agree ? EXIT_SUCCESS : -1;
+}
+
+//! @brief Serves clients through the shared memory object `name_` until SIGINT or SIGTERM.
+int serve_shared_memory( const std::string & name_, const Options & opt_ )
+{
+    // Blocked before the workers start, so only sigwait() below sees them.
+    sigset_t signals;
+    sigemptyset( &signals );
+    sigaddset( &signals, SIGINT );
+    sigaddset( &signals, SIGTERM );
+    pthread_sigmask( SIG_BLOCK, &signals, nullptr );
+
+    ShmServer server( opt_.limits );
+    if( not server.start( name_, opt_.shm ) )
+    {
+        std::cerr << "Could not create the shared memory object \"" << name_ << "\"!\n";
+        return -1;
+    }
+
+    std::cout << ">>> Serving " << opt_.shm.slots << " clients on \"" << name_ << "\". Stop with Ctrl-C.\n";
+
+    int received;
+    sigwait( &signals, &received );
+    server.stop();
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return EXIT_SUCCESS;
+}
+
+//! @brief Appends to `out_` what the line by line loop writes to the output file for `expression_`.
+void evaluate_line( Parser & parser_, const std::string & expression_, const Options & opt_, std::string & out_ )
+{
+    auto result = parser_.parse( expression_ );
+    if( result.type != Parser::ResultType::OK )
+    {
+        out_ += error_message( result );
+        out_ += '\n';
+        return;
+    }
+
+    auto depth = parser_.get_stack_depth();
+    auto postfix = infix2postfix( parser_.get_tokens(), depth );
+
+    if( opt_.exact )
+        out_ += answer_text( evaluate_postfix_exact( postfix ) );
+    else if( opt_.compiled )
+    {
+        auto compiled = compile_postfix( postfix );
+        if( opt_.simplify ) simplify_program( compiled );
+        out_ += answer_text( execute_threaded( decode_program( compiled ) ) );
+    }
+    else
+        out_ += answer_text( evaluate_postfix( postfix, depth ) );
+    out_ += '\n';
+}
+
+//! @brief Evaluates the files of the manifest or directory `list_` into `out_dir_`, all at once.
+int evaluate_batch( const std::string & list_, const std::string & out_dir_, const Options & opt_ )
+{
+    struct stat st;
+    std::vector< BatchFile > files;
+    bool is_dir = stat( list_.c_str(), &st ) == 0 and S_ISDIR( st.st_mode );
+    if( not ( is_dir ? list_directory( list_, out_dir_, files ) : read_manifest( list_, out_dir_, files ) ) )
+    {
+        std::cerr << "Could not read the " << ( is_dir ? "directory" : "manifest" ) << " \"" << list_
+                  << "\", or two of its files have the same output!\n";
+        return -1;
+    }
+
+    if( mkdir( out_dir_.c_str(), 0755 ) != 0 and errno != EEXIST )
+    {
+        std::cerr << "Could not create the output directory \"" << out_dir_ << "\"!\n";
+        return -1;
+    }
+
+    auto workers = opt_.parallel_workers > 0 ? opt_.parallel_workers : std::thread::hardware_concurrency();
+    ThreadPool pool( workers );
+
+    auto start = std::chrono::steady_clock::now();
+    auto stats = process_files( files, pool, opt_.limits,
+        [&opt_]( Parser & parser_, const std::string & line_, std::string & out_ ){
+            evaluate_line( parser_, line_, opt_, out_ ); },
+        opt_.split_size );
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now() - start;
+
+    for( const auto & input : stats.failed )
+        std::cerr << "Could not evaluate \"" << input << "\"!\n";
+
+    std::cout << ">>> Files: " << stats.files << " in " << stats.chunks << " chunks, expressions: " << stats.lines
+              << ", failed: " << stats.failed.size() << ", workers: " << pool.size()
+              << ", seconds: " << elapsed.count() << "\n";
+
+    std::cout << "\n>>> Normal exiting...\n";
+    return stats.failed.empty() ? EXIT_SUCCESS : -1;
+}
 
 int main( int argc, char **argv )
 {
 /*----------------- Command Line Arguments Control -----------------*/
-	if( argc != 3 )
+	Options options;
+	if( not parse_options( argc, argv, options ) )
 	{
 		std::cerr << "Incorrect amount of arguments. Try again!\n";
+		std::cerr << "Usage: bares [--parallel[=<workers>]] [--parallel-threshold=<entries>] <input> <output>\n";
+		std::cerr << "       bares --exact <input> <output>\n";
+		std::cerr << "       bares --stream [--chunk-size=<bytes>] <input> <output>\n";
+		std::cerr << "       bares [--stats] <input.bin> <output>\n";
+		std::cerr << "       bares --engine=classic|compiled [--no-simplify] <input> <output>\n";
+		std::cerr << "       bares --batch-shapes [--stats] <input> <output>\n";
+		std::cerr << "       bares --sheet [--parallel[=<workers>]] <input> <output>\n";
+		std::cerr << "       bares --explain[=<repetitions>] <input> <output.jsonl>\n";
+		std::cerr << "       bares compile [--no-simplify] <input> <output.bin>\n";
+		std::cerr << "       bares header <input> <output.hpp>\n";
+		std::cerr << "       bares batch [--parallel[=<workers>]] [--split-size=<bytes>] <manifest|directory> <output directory>\n";
+		std::cerr << "       bares serve [--clients=<n>] [--ring-size=<bytes>] [--spin] <name>\n";
+		std::cerr << "Limits: [--max-bytes=<n>] [--max-tokens=<n>] [--max-depth=<n>] [--max-steps=<n>]\n";
+		std::cerr << "Tracing: [--trace=<file.json>]\n";
+		std::cerr << "Checkpoints: [--checkpoint=<file>] [--checkpoint-every=<lines>]\n";
+		std::cerr << "Compression: [--compress[=<level>]] writes a gzip output; gzip inputs are recognized\n";
 		return -1;
 	}
 	
-	std::istringstream ss( argv[1] );
-	std::string in_file;
-	ss >> in_file;
-	
-	std::istringstream zz( argv[2] );
-	std::string out_file;
-	zz >> out_file;
+	if( options.serve )
+		return serve_shared_memory( options.files[1], options );
+
+	std::string in_file = options.files[0];
+	std::string out_file = options.files[1];
+
+	if( options.compile )
+		return compile_expressions( in_file, out_file, options.simplify );
+
+	if( options.header )
+		return generate_header( in_file, out_file );
+
+	if( options.batch )
+		return evaluate_batch( in_file, out_file, options );
+
+	// Declared before the pool, so the trace is written once the workers are gone.
+	TraceSession trace( options.trace_file );
+
+	// Only built when a single expression may be split among threads.
+	std::unique_ptr< ThreadPool > pool;
+	if( options.parallel_workers > 0 )
+		pool.reset( new ThreadPool( options.parallel_workers ) );
 
 /*---------------------------- Streams -----------------------------*/
 	std::ifstream ifs;
 	std::ofstream ofs;
-	ifs.open( in_file.c_str() );
-	ofs.open( out_file.c_str() );
+	bool checkpoints = not options.checkpoint_file.empty();
+	bool gzip_input = is_gzip_file( in_file );
+
+	if( checkpoints and is_binary_file( in_file ) )
+	{
+		std::cerr << "Checkpoints are not made for binary files!\n";
+		return -1;
+	}
+
+	// Offsets into compressed streams can't be sought back to.
+	if( checkpoints and ( gzip_input or options.compress ) )
+	{
+		std::cerr << "Checkpoints are not made for compressed files!\n";
+		return -1;
+	}
+
+	// A run with the same arguments and input goes on from its last checkpoint.
+	Checkpoint checkpoint;
+	bool resumed = false;
+	if( checkpoints )
+	{
+		if( not new_checkpoint( options.args_hash, in_file, checkpoint ) )
+		{
+			std::cerr << "Could not open the input file!\n";
+			return -1;
+		}
+		resumed = resume_checkpoint( options.checkpoint_file, out_file, checkpoint );
+	}
+
+	// Either stream reads and writes a plain file or, through zlib, a gzip file.
+	GzipReader gz_in;
+	GzipWriter gz_out;
+	std::istream input( nullptr );
+	std::ostream output( nullptr );
+
+	if( options.compress )
+	{
+		if( not gz_out.open( out_file, options.compress_level ) )
+		{
+			std::cerr << "Could not create the output file!\n";
+			return -1;
+		}
+		output.rdbuf( &gz_out );
+	}
+	else
+	{
+		if( resumed )
+		{
+			ofs.open( out_file.c_str(), std::ios::in | std::ios::out );
+			ofs.seekp( 0, std::ios::end );
+		}
+		else
+			ofs.open( out_file.c_str() );
+		output.rdbuf( ofs.rdbuf() );
+	}
+
+	// Whatever mode ran, a compressed output is only complete once closed.
+	auto finish = [&]( int status_ ){
+		if( gz_in.failed() )
+		{
+			std::cerr << "The compressed input is corrupt or truncated!\n";
+			status_ = -1;
+		}
+		if( options.compress and not gz_out.close() )
+		{
+			std::cerr << "Could not write the compressed output!\n";
+			status_ = -1;
+		}
+		return status_; };
+
+	// Files made by `bares compile` are mapped and evaluated directly.
+	if( is_binary_file( in_file ) )
+		return finish( evaluate_binary( in_file, output, options ) );
+
+	if( gzip_input )
+	{
+		if( not gz_in.open( in_file ) )
+		{
+			std::cerr << "Could not open the input file!\n";
+			return finish( -1 );
+		}
+		input.rdbuf( &gz_in );
+	}
+	else
+	{
+		ifs.open( in_file.c_str() );
+		input.rdbuf( ifs.rdbuf() );
+	}
+
+	if( options.stream )
+		return finish( evaluate_stream( input, output, options ) );
+
+	if( options.shapes )
+		return finish( evaluate_shapes( input, output, options ) );
+
+	if( options.sheet )
+		return finish( evaluate_sheet( input, output, options, pool.get() ) );
+
+	if( options.explain )
+		return finish( explain_expressions( input, output, options ) );
 
 /*---------------------- Treating Expressions ----------------------*/
-    Parser my_parser; // Instancia um parser.
+    Parser my_parser( options.limits ); // Instancia um parser.
+    RunStats stats;
     // Tentar analisar cada expressão da lista.
 	std::string expression; // String var to constantly receive new expressions.
-    while( getline( ifs, expression ) )
+	std::uint64_t line = 0;
+	std::uint64_t input_offset = 0; // Where the line just read starts.
+
+	if( resumed )
+	{
+		input.seekg( static_cast< std::streamoff >( checkpoint.input_offset ) );
+		line = stats.lines = checkpoint.line;
+		input_offset = checkpoint.input_offset;
+		stats.rejected = checkpoint.rejected;
+		stats.checks.performed = checkpoint.checks_performed;
+		stats.checks.skipped = checkpoint.checks_skipped;
+		std::cout << ">>> Resuming from line " << line + 1 << ".\n";
+	}
+
+	// Everything written so far belongs to the lines before the one just read.
+	auto save_checkpoint_before = [&]( std::uint64_t line_ ){
+		output.flush();
+		checkpoint.line = line_ - 1;
+		checkpoint.input_offset = input_offset;
+		checkpoint.output_offset = static_cast< std::uint64_t >( output.tellp() );
+		checkpoint.rejected = stats.rejected;
+		checkpoint.checks_performed = stats.checks.performed;
+		checkpoint.checks_skipped = stats.checks.skipped;
+
+		if( not output or not sync_file( out_file ) or not save_checkpoint( options.checkpoint_file, checkpoint ) )
+			std::cerr << "Could not write the checkpoint \"" << options.checkpoint_file << "\"!\n";
+	};
+
+    while( read_line( input, expression, line ) )
     {
+        if( checkpoints and line > 1 and ( line - 1 ) % options.checkpoint_every == 0 )
+            traced( "checkpoint", [&](){ save_checkpoint_before( line ); } );
+        input_offset += expression.size() + 1;
+
+        TraceSpan whole( "expression" );
         // Fazer o parsing desta expressão.
-        auto result = my_parser.parse( expression );
+        auto result = traced( "parse", [&](){ return my_parser.parse( expression ); } );
+        ++stats.lines;
+        if( result.type == Parser::ResultType::LIMIT_EXCEEDED ) ++stats.rejected;
         // Preparar cabeçalho da saida.
         std::cout << std::setfill('=') << std::setw(80) << "\n";
         std::cout << std::setfill(' ') << ">>> Parsing \"" << expression << "\"\n";        
         // Se deu pau, imprimir a mensagem adequada.
         if ( result.type != Parser::ResultType::OK )
         {
-            print_error_msg( result, expression, ofs );
+            traced( "write", [&](){ print_error_msg( result, expression, output ); } );
             /* Won't calculate if it isn't parsed right */
         }
         else
@@ -114,7 +1297,9 @@ int main( int argc, char **argv )
 		// For debugging
         if( result.type != Parser::ResultType::OK ) continue;
 		/// Calculation only usable if expression is successfully parsed.
-		std::vector< std::string > postfix = infix2postfix( lista );
+		// The parser already knows how deep both stacks get.
+		auto depth = my_parser.get_stack_depth();
+		auto postfix = traced( "infix2postfix", [&](){ return infix2postfix( lista, depth ); } );
 		
         /*For debugging*/
 		std::cout << "\n>>> Olhando separadamente:\n";
@@ -123,29 +1308,43 @@ int main( int argc, char **argv )
 		}
 		std::cout << "\n";
         
-		auto answer = evaluate_postfix( postfix );
+		if( options.exact )
+		{
+			auto exact = traced( "evaluate_postfix_exact", [&](){ return evaluate_postfix_exact( postfix ); } );
+			traced( "write", [&](){ print_answer( exact, output ); } );
+			continue;
+		}
 
-        if( answer.second < 0)
-        {
-            std::cout << "Division by zero!\n";
-            ofs << "Division by zero!\n";
-            continue;
-        }
-        if( answer.second > 0)
-        {
-            std::cout << "Numeric overflow error!\n";
-            ofs << "Numeric overflow error!\n";
-            continue;
-        }
+		if( options.compiled )
+		{
+			auto program = traced( "decode_program", [&](){
+				auto compiled = compile_postfix( postfix );
+				if( options.simplify ) simplify_program( compiled );
+				return decode_program( compiled ); } );
+			auto answer = traced( "execute_threaded", [&](){ return execute_threaded( program ); } );
+			traced( "write", [&](){ print_answer( answer, output ); } );
+			continue;
+		}
+
+		auto answer = traced( "evaluate_postfix", [&](){
+			return pool ? evaluate_postfix_parallel( postfix, *pool, options.parallel_threshold )
+			            : evaluate_postfix( postfix, depth ); } );
 
-		std::cout << "Expression results in: " << answer.first << "\n";
-        ofs << answer.first << "\n";
+        traced( "write", [&](){ print_answer( answer, output ); } );
     }
 
+    if( options.stats )
+        print_stats( stats, options.limits );
+
     std::cout << "\n>>> Normal exiting...\n";
 
+    output.flush();
     ifs.close();
     ofs.close();
 
-    return EXIT_SUCCESS;
+    // The run is complete; a new one starts from the beginning.
+    if( checkpoints and output and ofs )
+        std::remove( options.checkpoint_file.c_str() );
+
+    return finish( EXIT_SUCCESS );
 }
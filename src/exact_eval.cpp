@@ -0,0 +1,204 @@
+/**
+ * @file exact_eval.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Exact Evaluation Code
+ * @brief Evaluates postfix expressions without the `short int` range limit.
+ */
+
+#include "../include/exact_eval.hpp"
+#include "../include/stack.hpp" // stack
+
+#include <charconv> // std::from_chars
+#include <limits>   // std::numeric_limits
+
+/// @brief A value of any size; it is kept as a word if it fits one.
+ExactValue::ExactValue( BigInt value_ )
+{
+    if ( value_.fits_int64() )
+        word = value_.to_int64();
+    else
+    {
+        is_big = true;
+        word = 0;
+        big = std::move( value_ );
+    }
+}
+
+namespace
+{
+    using exact_result = std::pair< ExactValue,int >;
+
+    const exact_result division_by_zero( 0, -1 );
+    const exact_result overflow( 0, 1 );
+
+    //! @brief `base_ ^ exponent_` for a negative exponent, or for a base of 0, 1 or -1.
+    //! @return false if it is none of those cases.
+    bool trivial_power( const BigInt & base_, const BigInt & exponent_, exact_result & result_ )
+    {
+        const BigInt one( 1 );
+        bool base_is_one = compare( base_, one ) == 0 or compare( base_, -one ) == 0;
+
+        if ( not exponent_.is_negative() and not base_.is_zero() and not base_is_one )
+            return false;
+
+        if ( exponent_.is_zero() )
+            result_ = exact_result( 1, 0 );
+        else if ( base_.is_zero() )
+            result_ = exponent_.is_negative() ? division_by_zero : exact_result( 0, 0 );
+        else if ( not base_is_one )
+            result_ = exact_result( 0, 0 ); // |base| > 1 and a negative exponent.
+        else if ( not base_.is_negative() )
+            result_ = exact_result( 1, 0 );
+        else
+        {
+            // -1 to an odd power is -1.
+            BigInt q, r;
+            BigInt::divmod( exponent_, BigInt( 2 ), q, r );
+            result_ = exact_result( r.is_zero() ? 1 : -1, 0 );
+        }
+
+        return true;
+    }
+
+    //! @brief The operation on BigInt, for operands or results that do not fit a word.
+    exact_result execute_big( const BigInt & n1, const BigInt & n2, char opr )
+    {
+        BigInt value;
+
+        if ( opr == '+' ) value = n1 + n2;
+
+        else if ( opr == '-' ) value = n1 - n2;
+
+        else if ( opr == '*' ) value = n1 * n2;
+
+        else if ( opr == '/' or opr == '%' )
+        {
+            if ( n2.is_zero() ) return division_by_zero;
+
+            BigInt q, r;
+            BigInt::divmod( n1, n2, q, r );
+            value = opr == '/' ? q : r;
+        }
+        else if ( opr == '^' )
+        {
+            exact_result trivial;
+            if ( trivial_power( n1, n2, trivial ) ) return trivial;
+
+            // |n1| >= 2, so the result has at least n2 * (bits of n1 - 1) bits.
+            if ( not n2.fits_int64() ) return overflow;
+            auto exponent = static_cast< unsigned long long >( n2.to_int64() );
+            if ( exponent > max_exact_bits / ( n1.bit_length() - 1 ) ) return overflow;
+
+            value = n1.pow( exponent );
+        }
+        else
+        {
+            assert( false );
+        }
+
+        if ( value.bit_length() > max_exact_bits ) return overflow;
+        return exact_result( ExactValue( std::move( value ) ), 0 );
+    }
+
+    //! @brief `n1 ^ n2` on words. @return false if the result does not fit one.
+    bool power_word( long long n1, long long n2, exact_result & result_ )
+    {
+        if ( trivial_power( BigInt( n1 ), BigInt( n2 ), result_ ) ) return true;
+
+        // |n1| >= 2 here, so any exponent from 64 on overflows.
+        if ( n2 >= 64 ) return false;
+
+        long long value = 1, base = n1;
+        while ( true )
+        {
+            if ( ( n2 & 1 ) and __builtin_mul_overflow( value, base, &value ) ) return false;
+            n2 >>= 1;
+            if ( n2 == 0 ) break;
+            if ( __builtin_mul_overflow( base, base, &base ) ) return false;
+        }
+
+        result_ = exact_result( value, 0 );
+        return true;
+    }
+}
+
+/// @brief Exact version of execute_operator(): second is -1 on division by zero, 1 past max_exact_bits.
+std::pair< ExactValue,int > execute_operator_exact( const ExactValue & n1, const ExactValue & n2, char opr )
+{
+    // Fast path: both operands and the result fit a word.
+    if ( n1.is_word() and n2.is_word() )
+    {
+        long long x = n1.to_word(), y = n2.to_word(), r;
+
+        switch ( opr )
+        {
+            case '+':
+                if ( not __builtin_add_overflow( x, y, &r ) ) return exact_result( r, 0 );
+                break;
+            case '-':
+                if ( not __builtin_sub_overflow( x, y, &r ) ) return exact_result( r, 0 );
+                break;
+            case '*':
+                if ( not __builtin_mul_overflow( x, y, &r ) ) return exact_result( r, 0 );
+                break;
+            case '/':
+                if ( y == 0 ) return division_by_zero;
+                // The only quotient that does not fit.
+                if ( not ( x == std::numeric_limits< long long >::min() and y == -1 ) )
+                    return exact_result( x / y, 0 );
+                break;
+            case '%':
+                if ( y == 0 ) return division_by_zero;
+                return exact_result( y == -1 ? 0 : x % y, 0 );
+            case '^':
+            {
+                exact_result result;
+                if ( power_word( x, y, result ) ) return result;
+                break;
+            }
+            default:
+                assert( false );
+        }
+    }
+
+    return execute_big( n1.to_big(), n2.to_big(), opr );
+}
+
+/// @brief Exact version of evaluate_postfix(), with the same error codes.
+std::pair< ExactValue,int > evaluate_postfix_exact( const std::vector< std::string > & postfix_ )
+{
+    sc::stack< ExactValue > s;
+
+    for ( const auto & entry : postfix_ )
+    {
+        if ( not is_operator_entry( entry ) )
+        {
+            // The parser only lets valid integers through, so no error is expected here.
+            long long integer = 0;
+            auto conversion = std::from_chars( entry.data(), entry.data() + entry.size(), integer );
+            assert( conversion.ec == std::errc() );
+            (void) conversion;
+
+            s.push( integer );
+        }
+        else
+        {
+            // Recover the two operands in reverse order.
+            auto op2 = std::move( s.top() ); s.pop();
+            auto op1 = std::move( s.top() ); s.pop();
+
+            auto result = execute_operator_exact( op1, op2, entry[0] );
+            if ( result.second < 0 )
+                return std::make_pair( result.first, -10 );
+
+            if ( result.second > 0 )
+                return std::make_pair( result.first, 10 );
+
+            s.push( std::move( result.first ) );
+        }
+    }
+
+    return std::make_pair( s.top(), 0 );
+}
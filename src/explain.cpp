@@ -0,0 +1,179 @@
+/**
+ * @file explain.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Explain Code
+ * @brief Cost profile of a single expression: its shape, and the time of each phase and engine.
+ */
+
+#include "../include/explain.hpp"
+#include "../include/bytecode.hpp"
+#include "../include/simplify.hpp"
+#include "../include/stream_parser.hpp"
+#include "../include/threaded_eval.hpp"
+
+#include <algorithm> // std::sort, std::max
+#include <chrono>    // std::chrono::steady_clock
+#include <istream>   // std::istream
+#include <memory>    // std::unique_ptr
+#include <streambuf> // std::streambuf
+#include <vector>    // std::vector
+
+namespace
+{
+    //! @brief A sample shorter than this is too close to the resolution of the clock.
+    constexpr double min_sample_ns = 2000;
+
+    //! @brief Runs of a phase in a sample, at most.
+    constexpr size_t max_batch = 1u << 16;
+
+    //! @brief Bytes of repeated lines the fused engine is timed on.
+    constexpr size_t fused_text = 1u << 16;
+
+    //! @brief Reads a string in place, again from the start after rewind().
+    class StringBuffer : public std::streambuf
+    {
+        public:
+            explicit StringBuffer( const std::string & str_ ) : str( str_ ) { rewind(); }
+
+            void rewind( void )
+            {
+                auto p = const_cast< char * >( str.data() );
+                setg( p, p, p + str.size() );
+            }
+
+        private:
+            const std::string & str;
+    };
+
+    //! @brief Keeps results alive, so timed work is not optimized away.
+    volatile value_type sink = 0;
+
+    /// @brief Times `f_`, `repetitions_` samples of as many runs as it takes to be measurable.
+    template < typename F >
+    PhaseTime measure( F f_, size_t repetitions_ )
+    {
+        using ns = std::chrono::duration< double, std::nano >;
+
+        auto sample = [&]( size_t runs_ ){
+            auto start = std::chrono::steady_clock::now();
+            for ( auto r(0u); r < runs_; ++r ) sink = sink + f_();
+            return ns( std::chrono::steady_clock::now() - start ).count(); };
+
+        size_t batch = 1;
+        while ( batch < max_batch and sample( batch ) < min_sample_ns )
+            batch *= 2;
+
+        std::vector< double > times;
+        for ( auto i(0u); i < std::max< size_t >( 1, repetitions_ ); ++i )
+            times.push_back( sample( batch ) / batch );
+
+        std::sort( times.begin(), times.end() );
+        PhaseTime t;
+        t.median = times[ times.size() / 2 ];
+        t.best = times.front();
+        return t;
+    }
+}
+
+/// @return The name of `engine_`, as `--explain` prints it.
+const char * engine_name( engine_t engine_ )
+{
+    switch ( engine_ )
+    {
+        case engine_t::CLASSIC: return "classic";
+        case engine_t::FUSED: return "fused";
+        default: return "compiled";
+    }
+}
+
+/// @return Median nanoseconds of `engine_` from the text to the answer.
+double Explanation::engine_time( engine_t engine_ ) const
+{
+    switch ( engine_ )
+    {
+        case engine_t::CLASSIC: return parse.median + infix2postfix.median + evaluate.median;
+        case engine_t::FUSED: return fused.median;
+        default: return parse.median + infix2postfix.median + compile.median + execute.median;
+    }
+}
+
+/// @return Median nanoseconds of `engine_` evaluating again: postfix and program are kept, the fused engine keeps nothing.
+double Explanation::reused_time( engine_t engine_ ) const
+{
+    switch ( engine_ )
+    {
+        case engine_t::CLASSIC: return evaluate.median;
+        case engine_t::FUSED: return fused.median;
+        default: return execute.median;
+    }
+}
+
+/// @brief Profiles `expression_`, timing each phase over `repetitions_` runs.
+Explanation explain_expression( const std::string & expression_, const Parser::Limits & limits_, size_t repetitions_ )
+{
+    Explanation e;
+    Parser parser( limits_ );
+
+    e.result = parser.parse( expression_ );
+    e.bytes = expression_.size();
+    e.tokens = parser.get_tokens().size();
+    e.parse = measure( [&](){ return value_type( parser.parse( expression_ ).type ); }, repetitions_ );
+    if ( e.result.type != Parser::ResultType::OK )
+        return e;
+
+    auto tokens = parser.get_tokens();
+    e.nesting = parser.get_nesting();
+    e.unary_rewrites = parser.get_unary_rewrites();
+    e.stack_peak = parser.get_stack_depth();
+
+    auto postfix = infix2postfix( tokens, e.stack_peak );
+    e.postfix_length = postfix.size();
+    e.answer = evaluate_postfix( postfix, e.stack_peak );
+
+    auto compile = [&](){
+        auto program = compile_postfix( postfix );
+        simplify_program( program );
+        return program; };
+    auto program = compile();
+    auto decoded = decode_program( program );
+    e.instructions = program.size();
+
+    // The fused engine runs as `--stream` does: one source and one parser
+    // for many lines, here the same line over and over.
+    std::string lines;
+    do lines += expression_ + "\n"; while ( lines.size() < fused_text );
+    StringBuffer buffer( lines );
+    std::istream is( &buffer );
+    std::unique_ptr< ChunkSource > source( new ChunkSource( is ) );
+    StreamParser streamer( limits_ );
+    auto fused = [&](){
+        if ( not source->has_line() )
+        {
+            buffer.rewind();
+            is.clear();
+            source.reset( new ChunkSource( is ) );
+            source->has_line();
+        }
+        return streamer.parse( *source ); };
+
+    auto streamed = fused();
+    e.engines_agree = streamed.result.type == Parser::ResultType::OK and streamed.answer == e.answer and
+                      execute_threaded( decoded ) == e.answer;
+
+    e.infix2postfix = measure( [&](){ return value_type( infix2postfix( tokens, e.stack_peak ).size() ); }, repetitions_ );
+    e.evaluate = measure( [&](){ return evaluate_postfix( postfix, e.stack_peak ).first; }, repetitions_ );
+    e.fused = measure( [&](){ return fused().answer.first; }, repetitions_ );
+    e.compile = measure( [&](){ return value_type( decode_program( compile() ).code.size() ); }, repetitions_ );
+    e.execute = measure( [&](){ return execute_threaded( decoded ).first; }, repetitions_ );
+
+    const engine_t engines[] = { engine_t::CLASSIC, engine_t::FUSED, engine_t::COMPILED };
+    for ( auto engine : engines )
+    {
+        if ( e.engine_time( engine ) < e.engine_time( e.fastest ) ) e.fastest = engine;
+        if ( e.reused_time( engine ) < e.reused_time( e.fastest_reused ) ) e.fastest_reused = engine;
+    }
+
+    return e;
+}
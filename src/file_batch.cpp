@@ -0,0 +1,403 @@
+/**
+ * @file file_batch.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title File Batch Code
+ * @brief Many input files evaluated at once, in chunks, on a work-stealing pool.
+ */
+
+#include "../include/file_batch.hpp"
+#include "../include/gzip_stream.hpp"
+
+#include <algorithm>     // std::sort, std::max, std::min
+#include <cerrno>        // errno, EINTR
+#include <fstream>       // std::ifstream
+#include <istream>       // std::istream
+#include <memory>        // std::unique_ptr
+#include <mutex>         // std::mutex, std::lock_guard
+#include <sstream>       // std::istringstream
+#include <unordered_set> // std::unordered_set
+#include <utility>       // std::pair, std::move
+
+#include <dirent.h>   // opendir, readdir, closedir
+#include <fcntl.h>    // open
+#include <sys/stat.h> // stat, fstat
+#include <unistd.h>   // pread, write, close
+
+namespace
+{
+    //! @brief Bytes read at a time to finish the last line of a chunk.
+    constexpr size_t tail_block = 1u << 12;
+
+    //! @brief The last component of `path_`.
+    std::string name_of( const std::string & path_ )
+    {
+        auto slash = path_.find_last_of( '/' );
+        return slash == std::string::npos ? path_ : path_.substr( slash + 1 );
+    }
+
+    //! @brief Reads `length_` bytes at `offset_` into `data_`, fewer at the end of the file. @return Bytes read, or -1.
+    ssize_t read_at( int fd_, char * data_, size_t length_, std::uint64_t offset_ )
+    {
+        size_t done = 0;
+        while ( done < length_ )
+        {
+            auto n = pread( fd_, data_ + done, length_ - done, static_cast< off_t >( offset_ + done ) );
+            if ( n < 0 and errno == EINTR ) continue;
+            if ( n < 0 ) return -1;
+            if ( n == 0 ) break;
+            done += static_cast< size_t >( n );
+        }
+        return static_cast< ssize_t >( done );
+    }
+
+    //! @brief Writes all of `data_`. @return false on any error.
+    bool write_all( int fd_, const std::string & data_ )
+    {
+        size_t done = 0;
+        while ( done < data_.size() )
+        {
+            auto n = write( fd_, data_.data() + done, data_.size() - done );
+            if ( n < 0 and errno == EINTR ) continue;
+            if ( n <= 0 ) return false;
+            done += static_cast< size_t >( n );
+        }
+        return true;
+    }
+
+    //! @brief A parser and an input buffer, handed from one chunk to the next.
+    struct Workspace
+    {
+        Parser parser;
+        std::string input; //!< Bytes of the chunk.
+        std::string line;  //!< The line being evaluated.
+    };
+
+    //! @brief A file being evaluated.
+    struct FileJob
+    {
+        const BatchFile * file = nullptr;
+        int in = -1;                         //!< Shared by every chunk, read with pread().
+        int out = -1;
+        std::uint64_t size = 0;
+
+        std::mutex lock;                     //!< Guards everything below.
+        std::vector< std::string > outputs;  //!< Output of the chunks done, but not written yet.
+        std::vector< char > done;            //!< Whether each chunk is done.
+        size_t next = 0;                     //!< First chunk not written yet.
+        size_t lines = 0;
+        bool failed = false;
+    };
+
+    //! @brief The state of one process_files() call, shared by its tasks.
+    class Batch
+    {
+        public:
+            Batch( ThreadPool & pool_, const Parser::Limits & limits_, const line_evaluator & evaluate_, size_t split_size_ )
+                : pool( pool_ ), limits( limits_ ), evaluate( evaluate_ ), split_size( std::max< size_t >( 1, split_size_ ) )
+            { /* empty */ }
+
+            /// @brief Queues `job_` on the pool, to be opened when it gets its turn.
+            void queue( FileJob & job_ ) { pool.run( group, [this, &job_](){ start( job_ ); } ); }
+
+            /// @brief Waits for every file queued. @return What was done.
+            BatchStats finish( void ) { pool.wait( group ); return stats; }
+
+        private:
+            ThreadPool & pool;
+            TaskGroup group;
+            Parser::Limits limits;
+            const line_evaluator & evaluate;
+            size_t split_size;
+
+            std::mutex free_lock;                                //!< Guards the free lists.
+            std::vector< std::unique_ptr< Workspace > > workspaces; //!< Not in use.
+            std::vector< std::string > buffers;                  //!< Empty output buffers, with their capacity.
+
+            std::mutex stats_lock;                               //!< Guards `stats`.
+            BatchStats stats;
+
+            std::unique_ptr< Workspace > acquire( std::string & buffer_ );
+            void release( std::unique_ptr< Workspace > ws_, std::string * buffer_ );
+
+            void start( FileJob & job_ );
+            void run_chunk( FileJob & job_, size_t chunk_ );
+            void run_gzip( FileJob & job_ );
+            bool read_chunk( FileJob & job_, std::uint64_t begin_, std::uint64_t end_, std::string & data_ );
+            void chunk_done( FileJob & job_, size_t chunk_, std::string && output_, size_t lines_, bool ok_ );
+            void close( FileJob & job_ );
+    };
+
+    /// @brief A workspace of a chunk done before, or a new one, and an output buffer in `buffer_`.
+    std::unique_ptr< Workspace > Batch::acquire( std::string & buffer_ )
+    {
+        std::lock_guard< std::mutex > guard( free_lock );
+        if ( not buffers.empty() )
+        {
+            buffer_ = std::move( buffers.back() );
+            buffers.pop_back();
+        }
+
+        if ( workspaces.empty() )
+        {
+            std::unique_ptr< Workspace > ws( new Workspace );
+            ws->parser.set_limits( limits );
+            return ws;
+        }
+
+        auto ws = std::move( workspaces.back() );
+        workspaces.pop_back();
+        return ws;
+    }
+
+    /// @brief Puts back a workspace, or an output buffer once written, if not null.
+    void Batch::release( std::unique_ptr< Workspace > ws_, std::string * buffer_ )
+    {
+        std::lock_guard< std::mutex > guard( free_lock );
+        if ( ws_ ) workspaces.push_back( std::move( ws_ ) );
+        if ( buffer_ )
+        {
+            buffer_->clear();
+            buffers.push_back( std::move( *buffer_ ) );
+        }
+    }
+
+    /// @brief Opens the files of `job_` and splits it into chunks.
+    void Batch::start( FileJob & job_ )
+    {
+        struct stat st;
+        job_.in = open( job_.file->input.c_str(), O_RDONLY );
+        if ( job_.in >= 0 and fstat( job_.in, &st ) == 0 and S_ISREG( st.st_mode ) )
+            job_.out = open( job_.file->output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+
+        if ( job_.out < 0 )
+        {
+            job_.failed = true;
+            close( job_ );
+            return;
+        }
+
+        // A gzip file can't be read from the middle: it is one task.
+        if ( is_gzip_file( job_.file->input ) )
+        {
+            run_gzip( job_ );
+            return;
+        }
+
+        job_.size = static_cast< std::uint64_t >( st.st_size );
+        auto chunks = std::max< std::uint64_t >( 1, ( job_.size + split_size - 1 ) / split_size );
+        job_.outputs.resize( chunks );
+        job_.done.assign( chunks, 0 );
+
+        // The owner pops the newest task first: it goes on with chunk 1,
+        // 2, ... while thieves take the chunks at the end of the file.
+        for ( auto c = chunks - 1; c > 0; --c )
+            pool.run( group, [this, &job_, c](){ run_chunk( job_, c ); } );
+        run_chunk( job_, 0 );
+    }
+
+    /// @brief Evaluates the lines that start in chunk `chunk_` of `job_`.
+    void Batch::run_chunk( FileJob & job_, size_t chunk_ )
+    {
+        std::string output;
+        auto ws = acquire( output );
+
+        std::uint64_t begin = chunk_ * split_size;
+        std::uint64_t end = chunk_ + 1 == job_.outputs.size() ? job_.size : begin + split_size;
+        bool ok = read_chunk( job_, begin, end, ws->input );
+
+        // The data starts one byte before the chunk, so a line starting at
+        // `begin` is seen to start there: the first line is the previous
+        // chunk's unless that byte is a newline.
+        const auto & data = ws->input;
+        size_t first = begin == 0 ? 0 : 1;
+        size_t pos = 0;
+        if ( begin > 0 )
+        {
+            auto nl = data.find( '\n' );
+            pos = nl == std::string::npos ? data.size() : nl + 1;
+        }
+
+        size_t lines = 0;
+        const size_t limit = static_cast< size_t >( end - begin ) + first;
+        while ( ok and pos < data.size() and pos < limit )
+        {
+            auto nl = data.find( '\n', pos );
+            if ( nl == std::string::npos ) nl = data.size();
+            ws->line.assign( data, pos, nl - pos );
+            evaluate( ws->parser, ws->line, output );
+            ++lines;
+            pos = nl + 1;
+        }
+
+        release( std::move( ws ), nullptr );
+        chunk_done( job_, chunk_, std::move( output ), lines, ok );
+    }
+
+    /// @brief Evaluates every line of the gzip file of `job_`, as a single chunk.
+    void Batch::run_gzip( FileJob & job_ )
+    {
+        job_.outputs.resize( 1 );
+        job_.done.assign( 1, 0 );
+
+        std::string output;
+        auto ws = acquire( output );
+
+        // Decompressed inline: the other workers are the parallelism here.
+        GzipReader gz( default_gzip_block, false );
+        bool ok = gz.open( job_.file->input );
+        std::istream is( &gz );
+
+        size_t lines = 0;
+        while ( ok and std::getline( is, ws->line ) )
+        {
+            evaluate( ws->parser, ws->line, output );
+            ++lines;
+
+            // No other chunk writes this file, so the output goes out as it grows.
+            if ( output.size() >= split_size )
+            {
+                ok = write_all( job_.out, output );
+                output.clear();
+            }
+        }
+        ok = ok and not gz.failed();
+
+        release( std::move( ws ), nullptr );
+        chunk_done( job_, 0, std::move( output ), lines, ok );
+    }
+
+    /// @brief Reads the bytes from `begin_` - 1 to the end of the line that holds `end_` - 1. @return false on error.
+    bool Batch::read_chunk( FileJob & job_, std::uint64_t begin_, std::uint64_t end_, std::string & data_ )
+    {
+        std::uint64_t first = begin_ == 0 ? 0 : begin_ - 1;
+        data_.resize( static_cast< size_t >( end_ - first ) );
+        auto n = read_at( job_.in, &data_[0], data_.size(), first );
+        if ( n < 0 ) return false;
+        data_.resize( static_cast< size_t >( n ) );
+
+        // The last line that starts in the chunk may end in the next one.
+        size_t from = data_.empty() ? 0 : data_.size() - 1;
+        while ( data_.find( '\n', from ) == std::string::npos )
+        {
+            from = data_.size();
+            data_.resize( from + tail_block );
+            n = read_at( job_.in, &data_[from], tail_block, first + from );
+            if ( n < 0 ) return false;
+            data_.resize( from + static_cast< size_t >( n ) );
+            if ( n == 0 ) break;
+        }
+
+        return true;
+    }
+
+    /// @brief Keeps the output of chunk `chunk_` and writes every chunk that is next in line.
+    void Batch::chunk_done( FileJob & job_, size_t chunk_, std::string && output_, size_t lines_, bool ok_ )
+    {
+        std::lock_guard< std::mutex > guard( job_.lock );
+        job_.outputs[ chunk_ ] = std::move( output_ );
+        job_.done[ chunk_ ] = 1;
+        job_.lines += lines_;
+        job_.failed = job_.failed or not ok_;
+
+        while ( job_.next < job_.done.size() and job_.done[ job_.next ] )
+        {
+            auto & out = job_.outputs[ job_.next++ ];
+            if ( not job_.failed and not write_all( job_.out, out ) )
+                job_.failed = true;
+            release( nullptr, &out );
+        }
+
+        if ( job_.next == job_.done.size() )
+            close( job_ );
+    }
+
+    /// @brief Closes the files of `job_`, done or failed, and counts it.
+    void Batch::close( FileJob & job_ )
+    {
+        if ( job_.in >= 0 ) ::close( job_.in );
+        if ( job_.out >= 0 and ::close( job_.out ) != 0 ) job_.failed = true;
+        job_.in = job_.out = -1;
+
+        std::lock_guard< std::mutex > guard( stats_lock );
+        if ( job_.failed )
+        {
+            stats.failed.push_back( job_.file->input );
+            return;
+        }
+        ++stats.files;
+        stats.chunks += job_.done.size();
+        stats.lines += job_.lines;
+    }
+}
+
+/// @brief Reads a manifest: one `<input> [<output>]` per line, blank lines skipped.
+bool read_manifest( const std::string & path_, const std::string & out_dir_, std::vector< BatchFile > & files_ )
+{
+    std::ifstream ifs( path_.c_str() );
+    if ( not ifs ) return false;
+
+    std::unordered_set< std::string > outputs;
+    for ( std::string line; std::getline( ifs, line ); )
+    {
+        std::istringstream fields( line );
+        BatchFile file;
+        if ( not ( fields >> file.input ) ) continue;
+        if ( not ( fields >> file.output ) )
+            file.output = out_dir_ + "/" + name_of( file.input );
+
+        if ( not outputs.insert( file.output ).second ) return false;
+        files_.push_back( file );
+    }
+
+    return not ifs.bad();
+}
+
+/// @brief Lists the regular files of the directory `dir_`, by name, each going to `<out_dir_>/<name>`.
+bool list_directory( const std::string & dir_, const std::string & out_dir_, std::vector< BatchFile > & files_ )
+{
+    DIR * dir = opendir( dir_.c_str() );
+    if ( dir == nullptr ) return false;
+
+    std::vector< std::string > names;
+    while ( auto entry = readdir( dir ) )
+    {
+        std::string name( entry->d_name );
+        struct stat st;
+        if ( stat( ( dir_ + "/" + name ).c_str(), &st ) == 0 and S_ISREG( st.st_mode ) )
+            names.push_back( name );
+    }
+    closedir( dir );
+
+    std::sort( names.begin(), names.end() );
+    for ( const auto & name : names )
+        files_.push_back( BatchFile{ dir_ + "/" + name, out_dir_ + "/" + name } );
+    return true;
+}
+
+/// @brief Evaluates every line of every file of `files_` on `pool_`.
+BatchStats process_files( const std::vector< BatchFile > & files_, ThreadPool & pool_, const Parser::Limits & limits_,
+                          const line_evaluator & evaluate_, size_t split_size_ )
+{
+    std::vector< std::unique_ptr< FileJob > > jobs;
+    std::vector< std::pair< std::uint64_t, size_t > > by_size; // Size, index.
+    for ( auto i(0u); i < files_.size(); ++i )
+    {
+        jobs.emplace_back( new FileJob );
+        jobs.back()->file = &files_[i];
+
+        struct stat st;
+        by_size.emplace_back( stat( files_[i].input.c_str(), &st ) == 0 ? st.st_size : 0, i );
+    }
+
+    // Workers run their newest task first: the largest files are queued
+    // last, so they start first. Thieves take the oldest tasks, the small
+    // files, and once those run out, the last chunks of the large ones.
+    std::sort( by_size.begin(), by_size.end() );
+
+    Batch batch( pool_, limits_, evaluate_, split_size_ );
+    for ( const auto & f : by_size )
+        batch.queue( *jobs[ f.second ] );
+    return batch.finish();
+}
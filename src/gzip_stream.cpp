@@ -0,0 +1,309 @@
+/**
+ * @file gzip_stream.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Gzip Stream Code
+ * @brief Stream buffers that read and write gzip files through zlib.
+ */
+
+#include "../include/gzip_stream.hpp"
+
+#include <cerrno>  // errno, EINTR
+#include <cstring> // std::memset
+
+#include <fcntl.h>  // open
+#include <unistd.h> // read, write, close
+
+namespace
+{
+    //! @brief Compressed bytes read from the file at a time.
+    constexpr size_t compressed_chunk = 1u << 16;
+
+    //! @brief Reads up to `length_` bytes. @return Bytes read, 0 at the end of the file, or -1.
+    ssize_t read_some( int fd_, char * data_, size_t length_ )
+    {
+        ssize_t n;
+        do n = read( fd_, data_, length_ ); while ( n < 0 and errno == EINTR );
+        return n;
+    }
+
+    //! @brief Writes all `length_` bytes. @return false on any error.
+    bool write_all( int fd_, const char * data_, size_t length_ )
+    {
+        while ( length_ > 0 )
+        {
+            auto n = write( fd_, data_, length_ );
+            if ( n < 0 and errno == EINTR ) continue;
+            if ( n <= 0 ) return false;
+            data_ += n;
+            length_ -= static_cast< size_t >( n );
+        }
+        return true;
+    }
+}
+
+/// @brief Says if the file at `path_` starts with the gzip magic bytes.
+bool is_gzip_file( const std::string & path_ )
+{
+    int fd = ::open( path_.c_str(), O_RDONLY );
+    if ( fd < 0 ) return false;
+
+    unsigned char magic[2];
+    auto n = read_some( fd, reinterpret_cast< char * >( magic ), 2 );
+    ::close( fd );
+    return n == 2 and magic[0] == 0x1f and magic[1] == 0x8b;
+}
+
+//=== GzipReader
+
+/// @brief A reader that decompresses `block_size_` bytes at a time, on its own thread if `threaded_`.
+GzipReader::GzipReader( size_t block_size_, bool threaded_ )
+    : compressed( compressed_chunk )
+    , block_size( block_size_ > 0 ? block_size_ : default_gzip_block )
+    , threaded( threaded_ )
+    , blocks( threaded_ ? gzip_blocks_ahead : 1 )
+{
+    std::memset( &zs, 0, sizeof( zs ) );
+    for ( auto & b : blocks ) b.data.resize( block_size );
+}
+
+/// @brief Stops the decompression thread and closes the file.
+GzipReader::~GzipReader()
+{
+    if ( worker.joinable() )
+    {
+        {
+            std::lock_guard< std::mutex > guard( lock );
+            stopping = true;
+        }
+        not_full.notify_all();
+        worker.join();
+    }
+
+    if ( zs_ready ) inflateEnd( &zs );
+    if ( fd >= 0 ) ::close( fd );
+}
+
+/// @brief Opens the gzip file at `path_` and starts decompressing. @return false if it can't be opened.
+bool GzipReader::open( const std::string & path_ )
+{
+    if ( fd >= 0 ) return false;
+
+    fd = ::open( path_.c_str(), O_RDONLY );
+    if ( fd < 0 ) return false;
+
+    // 16 + MAX_WBITS: a gzip header and trailer around the deflate data.
+    if ( inflateInit2( &zs, 16 + MAX_WBITS ) != Z_OK )
+        return false;
+    zs_ready = true;
+
+    if ( threaded )
+        worker = std::thread( &GzipReader::decompress_ahead, this );
+    return true;
+}
+
+/// @brief Decompresses up to block_size bytes into `out_`. @return Bytes made; 0 at the end or on error.
+size_t GzipReader::inflate_block( char * out_ )
+{
+    zs.next_out = reinterpret_cast< Bytef * >( out_ );
+    zs.avail_out = static_cast< uInt >( block_size );
+
+    while ( zs.avail_out > 0 and not error )
+    {
+        if ( zs.avail_in == 0 and not input_end )
+        {
+            auto n = read_some( fd, compressed.data(), compressed.size() );
+            if ( n < 0 ) error = true;
+            else if ( n == 0 ) input_end = true;
+            zs.next_in = reinterpret_cast< Bytef * >( compressed.data() );
+            zs.avail_in = n > 0 ? static_cast< uInt >( n ) : 0;
+        }
+
+        if ( zs.avail_in == 0 and input_end )
+        {
+            // The last member has to be complete.
+            if ( in_member ) error = true;
+            break;
+        }
+
+        // Zeros after the last member, as some tools pad files with, are accepted like gzip -t does.
+        if ( not in_member and ( padding or *zs.next_in == 0 ) )
+        {
+            padding = true;
+            while ( zs.avail_in > 0 and *zs.next_in == 0 ) { ++zs.next_in; --zs.avail_in; }
+            if ( zs.avail_in > 0 ) error = true;
+            continue;
+        }
+
+        in_member = true;
+        auto ret = inflate( &zs, Z_NO_FLUSH );
+        if ( ret == Z_STREAM_END )
+        {
+            // Another member may follow, as in `cat a.gz b.gz`.
+            in_member = false;
+            inflateReset( &zs );
+        }
+        else if ( ret != Z_OK and not ( ret == Z_BUF_ERROR and zs.avail_in == 0 ) )
+            error = true;
+    }
+
+    return block_size - zs.avail_out;
+}
+
+/// @brief Main loop of the decompression thread.
+void GzipReader::decompress_ahead( void )
+{
+    for ( ;; )
+    {
+        size_t index;
+        {
+            std::unique_lock< std::mutex > guard( lock );
+            not_full.wait( guard, [this](){ return stopping or count < blocks.size(); } );
+            if ( stopping ) return;
+            index = head;
+        }
+
+        // Filled outside the lock: the reader never touches a block that isn't counted.
+        auto size = inflate_block( blocks[index].data.data() );
+
+        {
+            std::lock_guard< std::mutex > guard( lock );
+            if ( size == 0 ) done = true;
+            else
+            {
+                blocks[index].size = size;
+                head = ( head + 1 ) % blocks.size();
+                ++count;
+            }
+        }
+        not_empty.notify_one();
+        if ( size == 0 ) return;
+    }
+}
+
+/// @brief Moves on to the next block of decompressed text.
+GzipReader::int_type GzipReader::underflow( void )
+{
+    if ( fd < 0 ) return traits_type::eof();
+
+    Block * b = &blocks[0];
+    if ( threaded )
+    {
+        std::unique_lock< std::mutex > guard( lock );
+        if ( holding )
+        {
+            holding = false;
+            tail = ( tail + 1 ) % blocks.size();
+            --count;
+            not_full.notify_one();
+        }
+
+        not_empty.wait( guard, [this](){ return count > 0 or done; } );
+        if ( count == 0 ) return traits_type::eof();
+        holding = true;
+        b = &blocks[tail];
+    }
+    else if ( ( b->size = inflate_block( b->data.data() ) ) == 0 )
+        return traits_type::eof();
+
+    setg( b->data.data(), b->data.data(), b->data.data() + b->size );
+    return traits_type::to_int_type( *gptr() );
+}
+
+//=== GzipWriter
+
+/// @brief A writer that compresses `buffer_size_` bytes at a time.
+GzipWriter::GzipWriter( size_t buffer_size_ )
+    : buffer( buffer_size_ > 0 ? buffer_size_ : default_gzip_block )
+    , compressed( compressed_chunk )
+{
+    std::memset( &zs, 0, sizeof( zs ) );
+    setp( buffer.data(), buffer.data() + buffer.size() );
+}
+
+/// @brief Ends the gzip stream if close() was not called.
+GzipWriter::~GzipWriter()
+{
+    close();
+}
+
+/// @brief Creates the gzip file at `path_`, compressed at `level_` (1 to 9). @return false on any error.
+bool GzipWriter::open( const std::string & path_, int level_ )
+{
+    if ( fd >= 0 ) return false;
+
+    fd = ::open( path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+    if ( fd < 0 ) return false;
+
+    if ( deflateInit2( &zs, level_, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+    {
+        error = true;
+        return false;
+    }
+    zs_ready = true;
+    return true;
+}
+
+/// @brief Compresses the buffered text with `flush_` and writes the result. @return false on any error.
+bool GzipWriter::deflate_buffer( int flush_ )
+{
+    if ( not zs_ready or error ) return false;
+
+    zs.next_in = reinterpret_cast< Bytef * >( pbase() );
+    zs.avail_in = static_cast< uInt >( pptr() - pbase() );
+
+    // Until deflate() has taken all the input and, when finishing, written the trailer.
+    int ret;
+    do
+    {
+        zs.next_out = reinterpret_cast< Bytef * >( compressed.data() );
+        zs.avail_out = static_cast< uInt >( compressed.size() );
+        ret = deflate( &zs, flush_ );
+        if ( ret == Z_STREAM_ERROR or not write_all( fd, compressed.data(), compressed.size() - zs.avail_out ) )
+        {
+            error = true;
+            return false;
+        }
+    } while ( zs.avail_out == 0 or ( flush_ == Z_FINISH and ret != Z_STREAM_END ) );
+
+    setp( buffer.data(), buffer.data() + buffer.size() );
+    return true;
+}
+
+/// @brief Compresses the full buffer and takes `c_`.
+GzipWriter::int_type GzipWriter::overflow( int_type c_ )
+{
+    if ( not deflate_buffer( Z_NO_FLUSH ) )
+        return traits_type::eof();
+
+    if ( not traits_type::eq_int_type( c_, traits_type::eof() ) )
+    {
+        *pptr() = traits_type::to_char_type( c_ );
+        pbump( 1 );
+    }
+    return traits_type::not_eof( c_ );
+}
+
+/// @brief Compresses what is buffered; deflate() may still hold some of it back.
+int GzipWriter::sync( void )
+{
+    return deflate_buffer( Z_NO_FLUSH ) ? 0 : -1;
+}
+
+/// @brief Compresses what is left, ends the gzip stream and closes the file. @return false on any error.
+bool GzipWriter::close( void )
+{
+    if ( fd < 0 ) return not error;
+
+    if ( zs_ready )
+    {
+        deflate_buffer( Z_FINISH );
+        deflateEnd( &zs );
+        zs_ready = false;
+    }
+
+    if ( ::close( fd ) != 0 ) error = true;
+    fd = -1;
+    return not error;
+}
@@ -17,6 +17,7 @@
 #include "../include/infix2postfix.hpp" 
 #include "../include/stack.hpp" // stack
 #include <limits>
+#include <charconv> // from_chars
 
 /*---------------------------------------------------------------------------*/
 
@@ -40,61 +41,94 @@ bool has_higher_precedence( const Token & op1, const Token & op2 ){
     return p1 >= p2 ;
 }
 
-//! @brief Converts a expression in infix notation to a corresponding profix representation.
-std::vector< std::string > infix2postfix( std::vector< Token > infix_ ){
-    
-    std::vector< std::string > postfix; //!< Stores the postfix expression.
-/*change*/sc::stack <Token> s; //!< Stack to help the conversion.
+//! @brief Tells operators apart from (possibly negative) operands in a postfix expression.
+bool is_operator_entry( const std::string & entry_ ){
 
-    // Going through the expression.
-    for( auto & ch : infix_ ){
+    return entry_.size() == 1 and std::string( "+-%^/*" ).find( entry_[0] ) != std::string::npos;
+}
 
-        // Operand goes straight to the output symbol queue.
-        if ( (int)(ch.type) == 0 )
-            postfix.push_back( ch.value );
-        
-		else if ( (int)(ch.type) == 1 ){
+namespace {
+
+    //! @brief The conversion itself, on any stack of token pointers with enough room.
+    template < typename Stack >
+    void convert( const std::vector< Token > & infix_, Stack & s, std::vector< std::string > & postfix ){
 
-            // Pop out all the element with higher priority.
-            while( not s.empty() and has_higher_precedence( s.top() , ch ) ){
-                
-                postfix.push_back( s.top().value );
-                s.pop();
+        // Going through the expression.
+        for( auto & ch : infix_ ){
+
+            // Operand goes straight to the output symbol queue.
+            if ( (int)(ch.type) == 0 )
+                postfix.push_back( ch.value );
+
+            else if ( (int)(ch.type) == 1 ){
+
+                // Pop out all the element with higher priority.
+                while( not s.empty() and has_higher_precedence( *s.top() , ch ) ){
+
+                    postfix.push_back( s.top()->value );
+                    s.pop();
+                }
+
+                // The incoming operator always goes into the stack.
+                s.push( &ch );
             }
-            
-            // The incoming operator always goes into the stack.
-            s.push( ch );
-        } 
-		else if (  ch.value == "(" ){
-            // "("
-            s.push( ch );
-        }
-        else if ( ch.value == ")" ){ 
-            // ")"
-            // pop out all elements that are not '('.
-            while( not s.empty() and s.top().value != "(" ){
-                postfix.push_back( s.top().value ); // goes to the output.
-                s.pop();
+            else if (  ch.value == "(" ){
+                // "("
+                s.push( &ch );
+            }
+            else if ( ch.value == ")" ){
+                // ")"
+                // pop out all elements that are not '('.
+                while( not s.empty() and s.top()->value != "(" ){
+                    postfix.push_back( s.top()->value ); // goes to the output.
+                    s.pop();
+                }
+                s.pop(); // Remove the '(' that was on the stack.
+            }
+            else{ // anything else.
+                // ignore this char.
             }
-            s.pop(); // Remove the '(' that was on the stack.
         }
-        else{ // anything else.
-            // ignore this char.
+
+        // Pop out all the remaining operators in the stack.
+        while( not s.empty() ){
+
+            postfix.push_back( s.top()->value );
+            s.pop();
         }
     }
+}
 
-    // Pop out all the remaining operators in the stack.
-    while( not s.empty() ){
+//! @brief Converts a expression in infix notation to a corresponding profix representation.
+std::vector< std::string > infix2postfix( std::vector< Token > infix_ ){
+    
+    std::vector< std::string > postfix; //!< Stores the postfix expression.
+    sc::stack< const Token * > s; //!< Stack to help the conversion.
 
-        postfix.push_back( s.top().value );
-        s.pop();
-    }
+    convert( infix_, s, postfix );
+    return postfix;
+}
+
+//! @brief Same conversion, on a stack allocated once with the exact depth the expression needs.
+std::vector< std::string > infix2postfix( const std::vector< Token > & infix_, const StackDepth & depth_ ){
 
+    std::vector< std::string > postfix;
+    postfix.reserve( infix_.size() );
+    sc::fixed_stack< const Token * > s( depth_.operators );
+
+    convert( infix_, s, postfix );
     return postfix;
 }
 
 //! @brief Execute the binary operator on two operands and return the result.
-std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std::string opr ){   
+std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std::string opr ){
+
+    assert( opr.size() == 1 );
+    return execute_operator( n1, n2, opr[0] );
+}
+
+//! @brief Execute the binary operator, given by its symbol, on two operands and return the result.
+std::pair< value_type,int > execute_operator( value_type n1, value_type n2, char opr ){   
     
     /* Generating a pair. The first position represents the resulting value
     over the specified operations. The second position is a way of
@@ -102,11 +136,11 @@ std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std:
     */
     std::pair< value_type,int > result( 0,0 );
 	
-	if( opr == "^" ) result.first = static_cast< value_type >( pow( n1, n2 ) );
+	if( opr == '^' ) result.first = static_cast< value_type >( pow( n1, n2 ) );
 	
-    else if( opr == "*" ) result.first = static_cast< value_type >( n1*n2 );
+    else if( opr == '*' ) result.first = static_cast< value_type >( n1*n2 );
 	
-    else if( opr == "/" ){
+    else if( opr == '/' ){
 		if( n2 == 0 ){
             
             result.second = -1;
@@ -115,7 +149,7 @@ std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std:
 
 		result.first = n1/n2;
 	}
-    else if( opr == "%" ){
+    else if( opr == '%' ){
 		
         if( n2 == 0 ){
             
@@ -125,9 +159,9 @@ std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std:
 		result.first = n1%n2;
     }
 	
-    else if( opr == "+" ) result.first = n1+n2;
+    else if( opr == '+' ) result.first = n1+n2;
 	
-    else if( opr == "-" ) result.first = n1-n2;
+    else if( opr == '-' ) result.first = n1-n2;
    
     else {
         assert( false );
@@ -144,49 +178,66 @@ std::pair< value_type,int > execute_operator( value_type n1, value_type n2, std:
 
 //! @brief Change an infix expression into its corresponding postfix representation.
 std::pair< value_type,int > evaluate_postfix( std::vector< std::string > postfix_ ){
-    
-    sc::stack< value_type > s;
 
-    for( const auto & ch : postfix_ ){
-		bool is_operand = true;
-		long long int integer;
+    return evaluate_postfix( postfix_.cbegin(), postfix_.cend() );
+}
+
+namespace {
 
-		try { integer = stoll( ch ); }
-		catch( const std::invalid_argument & e ){
-            
-            is_operand = false; 
-        }
-		
+    //! @brief The evaluation itself, on any stack of values with enough room.
+    template < typename Stack >
+    std::pair< value_type,int > evaluate( postfix_iterator first_, postfix_iterator last_, Stack & s ){
 
-        if ( is_operand )
-		    s.push( (value_type) integer );
-        
+        for( ; first_ != last_; ++first_ ){
+            const auto & ch = *first_;
 
-        else if ( std::string("+-%^/*").find( ch ) != std::string::npos )
-        {
-            // Recover the two operands in reverse order.
-            auto op2 = s.top(); s.pop();
-            auto op1 = s.top(); s.pop();
-
-            std::pair< value_type,int > result;
-            result = execute_operator( op1, op2, ch );
-			
-			// Result of operation stacked.
-			s.push( result.first );
-			
-			// Considerates possible division by zero and numeric_overflow.
-            if( result.second < 0)
-                return std::make_pair( s.top(), -10 );
-            
-            if( result.second > 0) 
-                return std::make_pair( s.top(), 10 );
-            
+            if ( not is_operator_entry( ch ) )
+            {
+                // The parser only lets valid integers through, so no error is expected here.
+                value_type integer = 0;
+                auto conversion = std::from_chars( ch.data(), ch.data() + ch.size(), integer );
+                assert( conversion.ec == std::errc() );
+                (void) conversion;
 
+                s.push( integer );
+            }
+            else
+            {
+                // Recover the two operands in reverse order.
+                auto op2 = s.top(); s.pop();
+                auto op1 = s.top(); s.pop();
+
+                std::pair< value_type,int > result;
+                result = execute_operator( op1, op2, ch[0] );
+
+                // Result of operation stacked.
+                s.push( result.first );
+
+                // Considerates possible division by zero and numeric_overflow.
+                if( result.second < 0)
+                    return std::make_pair( s.top(), -10 );
+
+                if( result.second > 0)
+                    return std::make_pair( s.top(), 10 );
+            }
         }
 
-		else assert(false);
+        return std::make_pair( s.top(), 0 );
     }
+}
 
-    return std::make_pair( s.top(), 0 );
+//! @brief Evaluates the postfix entries in [first_, last_), which must form a whole subexpression.
+std::pair< value_type,int > evaluate_postfix( postfix_iterator first_, postfix_iterator last_ ){
+    
+    sc::stack< value_type > s;
+
+    return evaluate( first_, last_, s );
 }
 
+//! @brief Same evaluation, on a stack allocated once with the exact depth the expression needs.
+std::pair< value_type,int > evaluate_postfix( const std::vector< std::string > & postfix_, const StackDepth & depth_ ){
+
+    sc::fixed_stack< value_type > s( depth_.values );
+
+    return evaluate( postfix_.cbegin(), postfix_.cend(), s );
+}
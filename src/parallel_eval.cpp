@@ -0,0 +1,168 @@
+/**
+ * @file parallel_eval.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Parallel Evaluation Code
+ * @brief Evaluates one large postfix expression on a thread pool.
+ */
+
+#include "../include/parallel_eval.hpp"
+#include "../include/stack.hpp" // stack
+#include "../include/trace.hpp" // TraceSpan
+
+#include <algorithm> // std::max, std::reverse
+#include <atomic>    // std::atomic
+#include <limits>    // std::numeric_limits
+
+namespace
+{
+    //! @brief A subtree of the expression, stored as the postfix range [first, last).
+    struct Subtree
+    {
+        size_t first;
+        size_t last;
+    };
+
+    //! @brief Computes the size of the subtree rooted at each postfix entry.
+    //! @return false if the entries do not form exactly one expression tree.
+    bool subtree_sizes( const std::vector< std::string > & postfix_, std::vector< size_t > & sizes_ )
+    {
+        sc::stack< size_t > s;
+
+        sizes_.resize( postfix_.size() );
+        for ( auto i(0u); i < postfix_.size(); ++i )
+        {
+            if ( not is_operator_entry( postfix_[i] ) )
+            {
+                sizes_[i] = 1;
+            }
+            else
+            {
+                if ( s.size() < 2 ) return false;
+
+                auto right = s.top(); s.pop();
+                auto left = s.top(); s.pop();
+                sizes_[i] = left + right + 1;
+            }
+            s.push( sizes_[i] );
+        }
+
+        return s.size() == 1;
+    }
+
+    //! @brief Lists, in postfix order, the maximal subtrees with less than `grain_` entries.
+    std::vector< Subtree > split_subtrees( const std::vector< size_t > & sizes_, size_t grain_ )
+    {
+        std::vector< Subtree > leaves;
+        sc::stack< size_t > roots;
+
+        roots.push( sizes_.size() - 1 );
+        while ( not roots.empty() )
+        {
+            auto i = roots.top(); roots.pop();
+
+            if ( sizes_[i] < grain_ )
+            {
+                leaves.push_back( Subtree{ i + 1 - sizes_[i], i + 1 } );
+                continue;
+            }
+
+            // The right operand ends just before the operator, the left one before it.
+            auto right = i - 1;
+            auto left = right - sizes_[right];
+            roots.push( left );
+            roots.push( right );
+        }
+
+        // Right subtrees were visited first.
+        std::reverse( leaves.begin(), leaves.end() );
+        return leaves;
+    }
+}
+
+/// @brief Evaluates a postfix expression splitting it into independent subtrees.
+std::pair< value_type,int > evaluate_postfix_parallel( const std::vector< std::string > & postfix_,
+                                                       ThreadPool & pool_,
+                                                       size_t threshold_ )
+{
+    const auto n = postfix_.size();
+    std::vector< size_t > sizes;
+
+    if ( n < threshold_ or not subtree_sizes( postfix_, sizes ) )
+        return evaluate_postfix( postfix_.cbegin(), postfix_.cend() );
+
+    // Several subtrees per thread, so stealing can even out the load.
+    const auto grain = std::max< size_t >( 1024, n / ( 8 * ( pool_.size() + 1 ) ) );
+    const auto leaves = split_subtrees( sizes, grain );
+
+    std::vector< std::pair< value_type,int > > results( leaves.size() );
+    std::atomic< size_t > first_error{ std::numeric_limits< size_t >::max() };
+    TaskGroup group;
+
+    // Neighbour subtrees are packed together until a task has `grain` entries.
+    for ( auto begin(0u); begin < leaves.size(); )
+    {
+        auto end = begin;
+        size_t entries = 0;
+        while ( end < leaves.size() and entries < grain )
+        {
+            entries += leaves[end].last - leaves[end].first;
+            ++end;
+        }
+
+        pool_.run( group, [ &, begin, end ]()
+        {
+            TraceSpan span( "evaluate_subtrees" );
+            for ( auto k = begin; k < end; ++k )
+            {
+                // A subtree after a failed one will never be looked at.
+                if ( k > first_error ) return;
+
+                results[k] = evaluate_postfix( postfix_.cbegin() + leaves[k].first,
+                                               postfix_.cbegin() + leaves[k].last );
+                if ( results[k].second != 0 )
+                {
+                    auto seen = first_error.load();
+                    while ( k < seen and not first_error.compare_exchange_weak( seen, k ) ) /* empty */ ;
+                    return;
+                }
+            }
+        } );
+        begin = end;
+    }
+    pool_.wait( group );
+
+    // Apply the operators above the subtrees, in the sequential order.
+    sc::stack< value_type > s;
+    size_t k = 0;
+    for ( auto i(0u); i < n; )
+    {
+        if ( k < leaves.size() and i == leaves[k].first )
+        {
+            // An error here is the first one a left-to-right evaluation would meet.
+            if ( results[k].second != 0 ) return results[k];
+
+            s.push( results[k].first );
+            i = leaves[k].last;
+            ++k;
+            continue;
+        }
+
+        auto op2 = s.top(); s.pop();
+        auto op1 = s.top(); s.pop();
+
+        auto result = execute_operator( op1, op2, postfix_[i][0] );
+        s.push( result.first );
+
+        if ( result.second < 0 )
+            return std::make_pair( s.top(), -10 );
+
+        if ( result.second > 0 )
+            return std::make_pair( s.top(), 10 );
+
+        ++i;
+    }
+
+    return std::make_pair( s.top(), 0 );
+}
@@ -10,9 +10,8 @@
 #include <iterator>
 #include <algorithm>
 #include <cassert>
-
-int scopeOPENING = 0;
-int scopeCLOSING = 0;
+#include <charconv> // std::from_chars
+#include <cctype>   // std::isalpha, std::isalnum
 
 /// @brief Converts the input character c_ into its corresponding terminal symbol code.
 Parser::terminal_symbol_t  Parser::lexer( char c_ ) const
@@ -73,6 +72,63 @@ bool Parser::end_input( void ) const
     return it_curr_symb == expr.end();
 }
 
+/// @brief Appends a token to the list. @return false if that goes over the token or step limit.
+bool Parser::push_token( Token && token_ )
+{
+    if( token_.type == Token::token_t::OPERATOR and ++operator_count > limits.max_steps )
+        return false;
+
+    simulate_stacks( token_ );
+    token_list.emplace_back( std::move( token_ ) );
+    return token_list.size() <= limits.max_tokens;
+}
+
+/// @brief Follows `token_` through the infix to postfix conversion and the evaluation, updating stack_depth.
+/*!
+ * It runs the same steps as infix2postfix() on precedences only. Every
+ * operand that conversion outputs grows the evaluation stack by one and
+ * every operator shrinks it by one.
+ */
+void Parser::simulate_stacks( const Token & token_ )
+{
+    // "(" is kept with precedence 1; "^", the only operator of precedence 4, is right associative.
+    if( token_.type == Token::token_t::OPERAND )
+    {
+        stack_depth.values = std::max( stack_depth.values, ++pending_values );
+    }
+    else if( token_.type == Token::token_t::OPERATOR )
+    {
+        auto p = token_.precedence;
+        while( not pending.empty() and pending.back() >= p and not ( pending.back() == p and p == 4 ) )
+        {
+            pending.pop_back();
+            --pending_values;
+        }
+        pending.push_back( p );
+        stack_depth.operators = std::max( stack_depth.operators, pending.size() );
+    }
+    else if( token_.value == "(" )
+    {
+        pending.push_back( 1 );
+        stack_depth.operators = std::max( stack_depth.operators, pending.size() );
+    }
+    else
+    {
+        while( not pending.empty() and pending.back() != 1 )
+        {
+            pending.pop_back();
+            --pending_values;
+        }
+        if( not pending.empty() ) pending.pop_back();
+    }
+}
+
+/// @brief The LIMIT_EXCEEDED result at the current symbol.
+Parser::ResultType Parser::limit_exceeded( void ) const
+{
+    return ResultType( ResultType::LIMIT_EXCEEDED, std::distance( expr.cbegin(), std::string::const_iterator( it_curr_symb ) ) );
+}
+
 /// @return The result of trying to match the current character with c_, **without** consuming the current character from the input expression.
 bool Parser::peek( terminal_symbol_t c_ ) const
 {
@@ -162,10 +218,13 @@ Parser::ResultType Parser::expression()
 
 				int pred = get_precedence( token_str );
 
-				token_list.emplace_back( Token( token_str, Token::token_t::OPERATOR, pred ) );
-
 				// Don't forget to consume and advance iterator.
 				std::advance( it_curr_symb, 1);
+
+				if( not push_token( Token( token_str, Token::token_t::OPERATOR, pred ) ) )
+				{
+					return limit_exceeded();
+				}
 			}
 			else
 			{
@@ -218,12 +277,17 @@ Parser::ResultType Parser::term()
 		minus++;
 		next_symbol();
 	}
+	bool has_signs = minus > 0;
 	minus = minus % 2;
 	skip_ws();
 	if( lexer( *it_curr_symb ) == terminal_symbol_t::TS_OPENING and minus != 0 )
 	{
-		token_list.emplace_back( Token( "-1", Token::token_t::OPERAND, 0 ) );
-		token_list.emplace_back( Token( "*", Token::token_t::OPERATOR, 3 ) );
+		if( not push_token( Token( "-1", Token::token_t::OPERAND, 0 ) ) or
+		    not push_token( Token( "*", Token::token_t::OPERATOR, 3 ) ) )
+		{
+			return limit_exceeded();
+		}
+		++unary_rewrites;
 	}
 	else if( minus != 0 and lexer( *it_curr_symb ) != terminal_symbol_t::TS_OPENING )
 	{
@@ -231,12 +295,28 @@ Parser::ResultType Parser::term()
 	}
 
 	skip_ws();
+	// Signs with nothing after them: without this the expression would be accepted with a missing operand.
+	if( has_signs and end_input() )
+	{
+		return ResultType( ResultType::MISSING_TERM, std::distance( expr.begin(), it_curr_symb ) );
+	}
+
     if( accept( terminal_symbol_t::TS_OPENING ) )
 	{
 		// Increases the difference between scopes of opening and closing.
-		scopeOPENING++;
+		scope_opening++;
 
-		token_list.emplace_back( Token( "(", Token::token_t::SCOPE, 1 ) );
+		if( not push_token( Token( "(", Token::token_t::SCOPE, 1 ) ) )
+		{
+			return limit_exceeded();
+		}
+		// Deep nesting is rejected here, before it costs any recursion.
+		auto open_scopes = static_cast< size_t >( scope_opening - scope_closing );
+		if( open_scopes > limits.max_depth )
+		{
+			return limit_exceeded();
+		}
+		nesting = std::max( nesting, open_scopes );
 
 		// If a parenthesis was opened, then it should render an expression.
 		// Process the expression
@@ -248,8 +328,14 @@ Parser::ResultType Parser::term()
 		skip_ws();
 	}
 
+	// A name takes the place of an integer, sign included.
+	if ( at_name() )
+	{
+		result = name();
+		skip_ws();
+	}
 	// If we do not detect parentheses, then we must parse an integer.
-	if ( not peek( terminal_symbol_t::TS_OPENING ) and not peek( terminal_symbol_t::TS_CLOSING ) and not end_input() )
+	else if ( not peek( terminal_symbol_t::TS_OPENING ) and not peek( terminal_symbol_t::TS_CLOSING ) and not end_input() )
 	{			
 	    // Saves the beginning of the term in the input, for possible error messages.
     	auto begin_token( it_curr_symb );
@@ -262,14 +348,20 @@ Parser::ResultType Parser::term()
 	        std::string token_str;
 	        std::copy( begin_token, it_curr_symb, std::back_inserter( token_str ) );
 
-    	    // Try to convert the string to integer (use stoll ()).
-        	input_int_type token_int;
-	        try { token_int = stoll( token_str ); }
-    	    catch( const std::invalid_argument & e )
+    	    // Try to convert the string to integer (use from_chars(), which reports errors without throwing).
+        	input_int_type token_int = 0;
+	        auto conversion = std::from_chars( token_str.data(), token_str.data() + token_str.size(), token_int );
+    	    if ( conversion.ec == std::errc::invalid_argument )
         	{
             	return ResultType( ResultType::ILL_FORMED_INTEGER, 
                 	               std::distance( expr.begin(), begin_token ) );
 	        }
+	        // Too many digits even for the input type: certainly out of range.
+	        if ( conversion.ec == std::errc::result_out_of_range )
+	        {
+	            return ResultType( ResultType::INTEGER_OUT_OF_RANGE,
+	                               std::distance( expr.begin(), begin_token ) );
+	        }
 
     	    // We received a valid integer, it remains to know if it is within the range.
         	if ( token_int < std::numeric_limits< required_int_type >::min() or
@@ -280,7 +372,10 @@ Parser::ResultType Parser::term()
             	                   std::distance( expr.begin(), begin_token ) );
 	        }
     	    // Puts the new token on our token list.
-        	token_list.emplace_back( Token( token_str, Token::token_t::OPERAND ) );
+        	if( not push_token( Token( token_str, Token::token_t::OPERAND ) ) )
+			{
+				return limit_exceeded();
+			}
 	    }
 		skip_ws();
 	}
@@ -288,18 +383,27 @@ Parser::ResultType Parser::term()
 	// It consumes sequential closing parentheses.
 	while( accept( terminal_symbol_t::TS_CLOSING ) )
 	{
-		scopeCLOSING++;
-		if( (scopeOPENING - scopeCLOSING) < 0 ) {
+		scope_closing++;
+		if( (scope_opening - scope_closing) < 0 ) {
             // If there already is a Closing scope where it shouldn't have,
             // then or there were an operator expected or a operand.
             // Note that there can't be another scope expected.
-            if( (int) token_list.back().type == 0 ) {
+            if( not token_list.empty() and (int) token_list.back().type == 0 ) {
                 return ResultType( ResultType::EXTRANEOUS_SYMBOL, std::distance( expr.begin(), it_curr_symb-1 ) );
             }
             else
                 return ResultType( ResultType::ILL_FORMED_INTEGER, std::distance( expr.begin(), it_curr_symb-1 ) );
 		}
-		token_list.emplace_back( Token( ")", Token::token_t::SCOPE ) );
+		// A ")" right after an operator or a "(" closes a missing term, as in "(2+)" or "()".
+		if( result.type == ResultType::OK and
+		    ( token_list.back().type == Token::token_t::OPERATOR or token_list.back().value == "(" ) )
+		{
+			return ResultType( ResultType::ILL_FORMED_INTEGER, std::distance( expr.begin(), it_curr_symb-1 ) );
+		}
+		if( not push_token( Token( ")", Token::token_t::SCOPE ) ) )
+		{
+			return limit_exceeded();
+		}
 		
 		// At the end of the parentheses, the term is considered finished.
 		skip_ws();
@@ -330,6 +434,43 @@ Parser::ResultType Parser::integer()
     return natural_number();
 }
 
+/// @brief Says if a <name> starts at the current symbol, when names are enabled.
+bool Parser::at_name( void ) const
+{
+    auto letter = []( char c_ ){ return std::isalpha( static_cast< unsigned char >( c_ ) ) or c_ == '_'; };
+
+    if ( not names or end_input() )
+        return false;
+
+    // The sign left in place by term(), as for integers.
+    auto first = it_curr_symb;
+    if ( *first == '-' and ++first == expr.end() )
+        return false;
+
+    return letter( *first );
+}
+
+/// @brief Validates and consumes a name from the input string, adding it to the token list.
+/*! Production rule is:
+ * ```
+ * <name> := ["-"],<letter>,{<letter>|<digit>};
+ * ```
+ * The token is an operand whose value is the name, with the "-" if there is one.
+ */
+Parser::ResultType Parser::name()
+{
+    auto begin_token( it_curr_symb );
+    accept( terminal_symbol_t::TS_MINUS );
+
+    while ( not end_input() and ( std::isalnum( static_cast< unsigned char >( *it_curr_symb ) ) or *it_curr_symb == '_' ) )
+        next_symbol();
+
+    if ( not push_token( Token( std::string( begin_token, it_curr_symb ), Token::token_t::OPERAND ) ) )
+        return limit_exceeded();
+
+    return ResultType( ResultType::OK );
+}
+
 /// @brief Validates (i.e. returns true or false) and consumes a natural number from the input string.
 /*! This method parses a valid natural number from the input.
  *
@@ -403,6 +544,20 @@ Parser::ResultType Parser::parse( std::string e_ )
 
     // Always cleaning the token list from the last time.
     token_list.clear();
+    operator_count = 0;
+    pending.clear();
+    pending_values = 0;
+    stack_depth = StackDepth();
+    nesting = 0;
+    unary_rewrites = 0;
+    scope_opening = 0;
+    scope_closing = 0;
+
+    // Too long a line is not even looked at.
+    if ( expr.size() > limits.max_bytes )
+    {
+        return ResultType( ResultType::LIMIT_EXCEEDED, static_cast< ResultType::size_type >( limits.max_bytes ) );
+    }
 
     // Let's check if we get a 'Let us ignore any leading white spaces.'
     skip_ws();
@@ -414,9 +569,6 @@ Parser::ResultType Parser::parse( std::string e_ )
     else
     {
         // Regular call for expression.
-		scopeOPENING = 0;
-		scopeCLOSING = 0;
-
         result = expression();
 
         // Check if there is something left in the expression.
@@ -430,7 +582,7 @@ Parser::ResultType Parser::parse( std::string e_ )
                 return ResultType( ResultType::EXTRANEOUS_SYMBOL, std::distance( expr.begin(), it_curr_symb ) );
             }
 
-			if( scopeOPENING > scopeCLOSING )
+			if( scope_opening > scope_closing )
 			{
 				return ResultType( ResultType::MISSING_CLOSING_SCOPE,
 									std::distance( expr.begin(), it_curr_symb ) );
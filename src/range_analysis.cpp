@@ -0,0 +1,218 @@
+/**
+ * @file range_analysis.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Range Analysis Code
+ * @brief Bounds the values of a compiled expression before running it.
+ */
+
+#include "../include/range_analysis.hpp"
+#include "../include/stack.hpp" // stack
+
+#include <algorithm> // std::min, std::max
+#include <cstdlib>   // std::abs
+#include <limits>    // std::numeric_limits
+
+namespace
+{
+    const value_type short_min = std::numeric_limits< short int >::min();
+    const value_type short_max = std::numeric_limits< short int >::max();
+
+    //! Anything evaluation may carry on with.
+    const Interval short_range{ short_min, short_max };
+
+    bool contains( const Interval & i_, value_type v_ )
+    {
+        return i_.lo <= v_ and v_ <= i_.hi;
+    }
+
+    //! @brief Smallest interval holding the four values `f_( a, b )` for the ends a, b of `x_`, `y_`.
+    //! Right for operations monotone in each operand over the given intervals.
+    template < typename F >
+    Interval corners( const Interval & x_, const Interval & y_, F f_ )
+    {
+        value_type c[] = { f_( x_.lo, y_.lo ), f_( x_.lo, y_.hi ), f_( x_.hi, y_.lo ), f_( x_.hi, y_.hi ) };
+        return Interval{ *std::min_element( c, c + 4 ), *std::max_element( c, c + 4 ) };
+    }
+
+    //! @brief Range of `x_ % y_` (truncating), for a divisor interval without 0.
+    Interval remainder_range( const Interval & x_, const Interval & y_ )
+    {
+        // |x % y| < |y| and the remainder takes the sign of the dividend.
+        auto bound = std::max( std::abs( y_.lo ), std::abs( y_.hi ) ) - 1;
+        if ( x_.lo >= 0 ) return Interval{ 0, std::min( x_.hi, bound ) };
+        if ( x_.hi <= 0 ) return Interval{ std::max( x_.lo, -bound ), 0 };
+        return Interval{ std::max( x_.lo, -bound ), std::min( x_.hi, bound ) };
+    }
+
+    //! @brief Range and safety of one operation.
+    RangeInfo combine( const Interval & x_, const Interval & y_, opcode_t op_ )
+    {
+        // Constants: just run the operation.
+        if ( x_.is_point() and y_.is_point() )
+        {
+            auto result = execute_operator( x_.lo, y_.lo, symbol_of( op_ ) );
+            if ( result.second == 0 )
+                return RangeInfo{ Interval{ result.first, result.first }, true };
+            return RangeInfo{ short_range, false };
+        }
+
+        Interval range = short_range;
+        bool divides = op_ == opcode_t::DIV or op_ == opcode_t::MOD;
+        bool defined = not divides or not contains( y_, 0 );
+
+        switch ( op_ )
+        {
+            case opcode_t::ADD:
+                range = corners( x_, y_, []( value_type a, value_type b ){ return a + b; } );
+                break;
+            case opcode_t::SUB:
+                range = corners( x_, y_, []( value_type a, value_type b ){ return a - b; } );
+                break;
+            case opcode_t::MUL:
+                range = corners( x_, y_, []( value_type a, value_type b ){ return a * b; } );
+                break;
+            case opcode_t::DIV:
+                // Truncating division is monotone in each operand while the divisor keeps its sign.
+                if ( defined )
+                    range = corners( x_, y_, []( value_type a, value_type b ){ return a / b; } );
+                break;
+            case opcode_t::MOD:
+                if ( defined )
+                    range = remainder_range( x_, y_ );
+                break;
+            default:
+                // Powers are only bounded for constants.
+                return RangeInfo{ short_range, false };
+        }
+
+        bool fits = range.lo >= short_min and range.hi <= short_max;
+        if ( defined and fits )
+            return RangeInfo{ range, true };
+
+        // Evaluation only goes on with values that fit.
+        range.lo = std::max( range.lo, short_min );
+        range.hi = std::min( range.hi, short_max );
+        if ( range.lo > range.hi ) range = short_range;
+
+        return RangeInfo{ range, false };
+    }
+
+    //! @brief Range and safety of a unary operation on the values in `x_`.
+    RangeInfo combine( const Interval & x_, const Instruction & ins_ )
+    {
+        auto apply = [&]( value_type v_ ){ return execute_unary( v_, ins_ ); };
+        Interval range;
+        switch ( ins_.op )
+        {
+            case opcode_t::NEG:
+                range = Interval{ -x_.hi, -x_.lo };
+                break;
+            case opcode_t::SQR:
+                // lo * hi is only the minimum when it is negative, and then 0 is.
+                range = corners( x_, x_, []( value_type a, value_type b ){ return a * b; } );
+                range.lo = std::max< value_type >( range.lo, 0 );
+                break;
+            case opcode_t::MOD2:
+                range = remainder_range( x_, Interval{ value_type( 1 ) << ins_.operand, value_type( 1 ) << ins_.operand } );
+                break;
+            default:
+                // SHL and DIV2 don't decrease.
+                range = Interval{ apply( x_.lo ), apply( x_.hi ) };
+                break;
+        }
+
+        if ( range.lo >= short_min and range.hi <= short_max )
+            return RangeInfo{ range, true };
+
+        range.lo = std::max( range.lo, short_min );
+        range.hi = std::min( range.hi, short_max );
+        if ( range.lo > range.hi ) range = short_range;
+
+        return RangeInfo{ range, false };
+    }
+}
+
+/// @brief Interval analysis of the program in [first_, last_), one RangeInfo per instruction.
+std::vector< RangeInfo > analyze_ranges( const Instruction * first_, const Instruction * last_ )
+{
+    std::vector< RangeInfo > info;
+    info.reserve( last_ - first_ );
+    sc::stack< Interval > s;
+
+    for ( ; first_ != last_; ++first_ )
+    {
+        if ( first_->op == opcode_t::PUSH )
+        {
+            info.push_back( RangeInfo{ Interval{ first_->operand, first_->operand }, true } );
+        }
+        else if ( is_unary( first_->op ) )
+        {
+            auto x = s.top(); s.pop();
+            info.push_back( combine( x, *first_ ) );
+        }
+        else
+        {
+            // Recover the two operands in reverse order.
+            auto y = s.top(); s.pop();
+            auto x = s.top(); s.pop();
+
+            info.push_back( combine( x, y, first_->op ) );
+        }
+        s.push( info.back().range );
+    }
+
+    return info;
+}
+
+/// @brief Sets unchecked_flag on every operation that provably neither overflows nor divides by zero.
+RangeAnalysis mark_unchecked( Instruction * first_, Instruction * last_ )
+{
+    RangeAnalysis outcome;
+    auto info = analyze_ranges( first_, last_ );
+
+    for ( auto i(0u); i < info.size(); ++i )
+    {
+        auto & ins = first_[i];
+        if ( ins.op == opcode_t::PUSH ) continue;
+
+        ++outcome.operations;
+        if ( info[i].safe )
+        {
+            ins.flags |= unchecked_flag;
+            ++outcome.unchecked;
+        }
+        else
+            ins.flags &= ~unchecked_flag;
+    }
+
+    return outcome;
+}
+
+/// @brief Sets unchecked_flag on the safe operations of a whole program.
+RangeAnalysis mark_unchecked( Program & program_ )
+{
+    return mark_unchecked( program_.data(), program_.data() + program_.size() );
+}
+
+/// @brief Says if mark_unchecked() would have set every flag found in [first_, last_), and no other flag is set.
+bool flags_proved( const Instruction * first_, const Instruction * last_ )
+{
+    bool any = false;
+    for ( auto ins = first_; ins != last_; ++ins )
+    {
+        if ( ( ins->flags & ~unchecked_flag ) != 0 ) return false;
+        any = any or ins->flags != 0;
+    }
+
+    // Most programs are all checked or all constants; only flagged ones need the analysis.
+    if ( not any ) return true;
+
+    auto info = analyze_ranges( first_, last_ );
+    for ( auto i(0u); i < info.size(); ++i )
+        if ( ( first_[i].flags & unchecked_flag ) and not info[i].safe )
+            return false;
+
+    return true;
+}
@@ -0,0 +1,205 @@
+/**
+ * @file shape_batch.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shape Batch Code
+ * @brief Evaluates together the expressions that differ only in their literals.
+ */
+
+#include "../include/shape_batch.hpp"
+
+#include <algorithm> // std::copy, std::max
+#include <cassert>   // assert
+#include <charconv>  // std::from_chars
+#include <cmath>     // pow
+#include <limits>    // std::numeric_limits
+
+namespace
+{
+    //! @brief Same range check as execute_operator().
+    inline bool out_of_range( value_type value_ )
+    {
+        return value_ < std::numeric_limits< short int >::min() or value_ > std::numeric_limits< short int >::max();
+    }
+
+    //! Column numbers are stored in Instruction::operand.
+    constexpr size_t max_columns = std::numeric_limits< std::int16_t >::max();
+}
+
+/// @brief Adds the tokens of a successfully parsed expression to the batch.
+void ShapeBatch::add( const std::vector< Token > & tokens_ )
+{
+    // Operators keep their weight in the key: "-(" makes a "*" of its own.
+    key.clear();
+    size_t operands = 0;
+    for ( const auto & t : tokens_ )
+    {
+        if ( t.type == Token::token_t::OPERAND )
+        {
+            key += '#';
+            ++operands;
+        }
+        else
+        {
+            key += t.value[0];
+            key += static_cast< char >( '0' + t.precedence );
+        }
+    }
+
+    // Too many operands to number them: this one is evaluated on its own.
+    if ( operands > max_columns )
+    {
+        solo.emplace_back( added++, evaluate_postfix( infix2postfix( tokens_ ) ) );
+        return;
+    }
+
+    auto found = index.find( key );
+    if ( found == index.end() )
+    {
+        found = index.emplace( key, static_cast< std::uint32_t >( catalog.size() ) ).first;
+        catalog.push_back( compile( tokens_ ) );
+    }
+
+    auto & group = groups[ found->second ];
+    group.columns.resize( operands );
+
+    auto column = group.columns.begin();
+    for ( const auto & t : tokens_ )
+    {
+        if ( t.type != Token::token_t::OPERAND ) continue;
+
+        // The parser only lets valid integers through, so no error is expected here.
+        value_type literal = 0;
+        auto conversion = std::from_chars( t.value.data(), t.value.data() + t.value.size(), literal );
+        assert( conversion.ec == std::errc() );
+        (void) conversion;
+
+        ( column++ )->push_back( literal );
+    }
+
+    group.lines.push_back( added++ );
+}
+
+/// @brief Compiles a new shape from the expression that first has it.
+ShapeBatch::Shape ShapeBatch::compile( const std::vector< Token > & tokens_ ) const
+{
+    Shape shape;
+    shape.program = compile_postfix( infix2postfix( tokens_ ) );
+
+    // The conversion keeps the operands in order, so the n-th PUSH takes the n-th literal.
+    size_t depth = 0;
+    for ( auto & ins : shape.program )
+    {
+        if ( ins.op == opcode_t::PUSH )
+        {
+            ins.operand = static_cast< std::int16_t >( shape.operands++ );
+            shape.depth = std::max( shape.depth, ++depth );
+        }
+        else
+            --depth;
+    }
+
+    return shape;
+}
+
+/// @return The results of the expressions added since the last call, in the order they were added.
+std::vector< ShapeBatch::answer_type > ShapeBatch::evaluate( void )
+{
+    std::vector< answer_type > out( added );
+
+    for ( const auto & g : groups )
+        run( catalog[ g.first ], g.second, out );
+
+    for ( const auto & s : solo )
+        out[ s.first ] = s.second;
+
+    groups.clear();
+    solo.clear();
+    added = 0;
+    return out;
+}
+
+/*!
+ * Every row keeps going after its first error, with its value reset to 0,
+ * so the loops need no per-row branch; only that first error is kept.
+ * Values are back in the `short int` range after each step, so no row
+ * can overflow a value_type.
+ */
+void ShapeBatch::run( const Shape & shape_, const Group & group_, std::vector< answer_type > & out_ )
+{
+    const auto n = group_.lines.size();
+    stack.resize( shape_.depth * n );
+    codes.assign( n, 0 );
+    failed.assign( n, 0 );
+
+    // Records the rows that left the range, then brings them back into it.
+    auto check_range = [&]( value_type * a_ ){
+        bool any = false;
+        for ( auto j(0u); j < n; ++j ) any |= out_of_range( a_[j] );
+        if ( not any ) return;
+
+        for ( auto j(0u); j < n; ++j )
+        {
+            if ( not out_of_range( a_[j] ) ) continue;
+            if ( codes[j] == 0 ) { codes[j] = 10; failed[j] = a_[j]; }
+            a_[j] = 0;
+        }
+    };
+
+    // Records the rows that divide by zero, and makes their divisor harmless.
+    auto check_divisors = [&]( value_type * b_ ){
+        bool any = false;
+        for ( auto j(0u); j < n; ++j ) any |= b_[j] == 0;
+        if ( not any ) return;
+
+        for ( auto j(0u); j < n; ++j )
+        {
+            if ( b_[j] != 0 ) continue;
+            if ( codes[j] == 0 ) { codes[j] = -10; failed[j] = 0; }
+            b_[j] = 1;
+        }
+    };
+
+    size_t sp = 0;
+    for ( const auto & ins : shape_.program )
+    {
+        if ( ins.op == opcode_t::PUSH )
+        {
+            const auto & column = group_.columns[ ins.operand ];
+            std::copy( column.begin(), column.end(), stack.begin() + sp * n );
+            ++sp;
+            continue;
+        }
+
+        // Recover the two operand columns; the result replaces the first one.
+        value_type * a = stack.data() + ( sp - 2 ) * n;
+        value_type * b = stack.data() + ( sp - 1 ) * n;
+        --sp;
+
+        switch ( ins.op )
+        {
+            case opcode_t::ADD: for ( auto j(0u); j < n; ++j ) a[j] += b[j]; break;
+            case opcode_t::SUB: for ( auto j(0u); j < n; ++j ) a[j] -= b[j]; break;
+            case opcode_t::MUL: for ( auto j(0u); j < n; ++j ) a[j] *= b[j]; break;
+            case opcode_t::DIV:
+                check_divisors( b );
+                for ( auto j(0u); j < n; ++j ) a[j] /= b[j];
+                break;
+            case opcode_t::MOD:
+                check_divisors( b );
+                for ( auto j(0u); j < n; ++j ) a[j] %= b[j];
+                break;
+            case opcode_t::POW:
+                for ( auto j(0u); j < n; ++j )
+                    a[j] = codes[j] != 0 ? 0 : static_cast< value_type >( pow( a[j], b[j] ) );
+                break;
+            default:
+                assert( false );
+        }
+        check_range( a );
+    }
+
+    for ( auto j(0u); j < n; ++j )
+        out_[ group_.lines[j] ] = codes[j] == 0 ? answer_type( stack[j], 0 ) : answer_type( failed[j], codes[j] );
+}
@@ -0,0 +1,394 @@
+/**
+ * @file sheet.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Sheet Code
+ * @brief Named expressions that refer to each other, recomputed incrementally.
+ */
+
+#include "../include/sheet.hpp"
+
+#include <algorithm> // std::sort, std::unique, std::remove, std::min
+#include <cctype>    // std::isalpha, std::isalnum
+#include <limits>    // std::numeric_limits
+
+namespace
+{
+    //! @brief Whether `c_` may start a name.
+    inline bool name_start( char c_ )
+    {
+        return std::isalpha( static_cast< unsigned char >( c_ ) ) or c_ == '_';
+    }
+
+    //! @brief The distinct values of `ids_`.
+    std::vector< Sheet::id_type > distinct( std::vector< Sheet::id_type > ids_ )
+    {
+        std::sort( ids_.begin(), ids_.end() );
+        ids_.erase( std::unique( ids_.begin(), ids_.end() ), ids_.end() );
+        return ids_;
+    }
+}
+
+/// @brief Splits "<name> = <expression>". @return false if `line_` is not a definition.
+bool parse_definition( const std::string & line_, std::string & name_, std::string & expression_, size_t & column_ )
+{
+    auto skip_ws = [&]( size_t i_ ){
+        while ( i_ < line_.size() and ( line_[i_] == ' ' or line_[i_] == '\t' ) ) ++i_;
+        return i_; };
+
+    auto i = skip_ws( 0 );
+    auto begin = i;
+    if ( i == line_.size() or not name_start( line_[i] ) )
+    {
+        column_ = i;
+        return false;
+    }
+    while ( i < line_.size() and ( std::isalnum( static_cast< unsigned char >( line_[i] ) ) or line_[i] == '_' ) ) ++i;
+    name_.assign( line_, begin, i - begin );
+
+    i = skip_ws( i );
+    if ( i == line_.size() or line_[i] != '=' )
+    {
+        column_ = i;
+        return false;
+    }
+
+    column_ = i + 1;
+    expression_.assign( line_, column_, std::string::npos );
+    return true;
+}
+
+/// @brief A sheet that evaluates levels of at least `grain_` definitions on `pool_`, if given.
+Sheet::Sheet( ThreadPool * pool_, size_t grain_ )
+    : pool( pool_ )
+    , grain( std::max< size_t >( 1, grain_ ) )
+{
+    parser.set_names( true );
+}
+
+/// @return The number of `name_`, creating it if needed.
+Sheet::id_type Sheet::intern( const std::string & name_ )
+{
+    auto found = ids.find( name_ );
+    if ( found != ids.end() )
+        return found->second;
+
+    auto id = static_cast< id_type >( names.size() );
+    ids.emplace( name_, id );
+    names.push_back( name_ );
+    cells.emplace_back();
+    users.emplace_back();
+    return id;
+}
+
+/// @return The number of `name_`, or size() if it was never seen.
+Sheet::id_type Sheet::find( const std::string & name_ ) const
+{
+    auto found = ids.find( name_ );
+    return found == ids.end() ? static_cast< id_type >( size() ) : found->second;
+}
+
+/// @brief Defines `name_`, or changes its definition. @return The result of parsing `expression_`.
+Parser::ResultType Sheet::define( const std::string & name_, const std::string & expression_ )
+{
+    auto id = intern( name_ );
+    auto result = parser.parse( expression_ );
+
+    // Names are compiled as 0 and remembered as slots; interning them may move the cells.
+    std::vector< id_type > refs;
+    std::vector< size_t > slots;
+    std::vector< bool > negated;
+    Program program;
+    if ( result.type == Parser::ResultType::OK )
+    {
+        auto postfix = infix2postfix( parser.get_tokens(), parser.get_stack_depth() );
+        for ( auto i(0u); i < postfix.size(); ++i )
+        {
+            auto & entry = postfix[i];
+            bool minus = entry[0] == '-' and entry.size() > 1;
+            if ( is_operator_entry( entry ) or not name_start( entry[ minus ? 1 : 0 ] ) )
+                continue;
+
+            refs.push_back( intern( entry.substr( minus ? 1 : 0 ) ) );
+            slots.push_back( i );
+            negated.push_back( minus );
+            entry = "0";
+        }
+        program = compile_postfix( postfix );
+    }
+
+    auto & c = cells[id];
+    auto old_refs = std::move( c.refs );
+    c.defined = true;
+    c.expression = expression_;
+    c.parsed = result;
+    c.program = std::move( program );
+    c.refs = std::move( refs );
+    c.slots = std::move( slots );
+    c.negated = std::move( negated );
+
+    relink( id, old_refs );
+    dirty.push_back( id );
+    return result;
+}
+
+/// @brief Removes the definition of `name_`, if any.
+void Sheet::undefine( const std::string & name_ )
+{
+    auto id = find( name_ );
+    if ( id == size() or not cells[id].defined )
+        return;
+
+    auto old_refs = std::move( cells[id].refs );
+    cells[id] = Cell();
+    relink( id, old_refs );
+    dirty.push_back( id );
+}
+
+/// @brief Replaces the references of `id_` in `users`, from its old ones to its new ones.
+void Sheet::relink( id_type id_, const std::vector< id_type > & old_refs_ )
+{
+    for ( auto ref : distinct( old_refs_ ) )
+    {
+        auto & u = users[ref];
+        u.erase( std::remove( u.begin(), u.end(), id_ ), u.end() );
+    }
+
+    for ( auto ref : distinct( cells[id_].refs ) )
+        users[ref].push_back( id_ );
+}
+
+/// @brief Brings every definition up to date. @return The definitions evaluated.
+/*!
+ * Only the definitions reachable from a changed one, through `users`,
+ * are evaluated again. Each of them waits for its references among those
+ * to be done; the ones with nothing to wait for form the next level.
+ * Whatever is still waiting when the levels run out is on a cycle or
+ * depends on one.
+ */
+size_t Sheet::recompute( void )
+{
+    if ( dirty.empty() )
+        return 0;
+
+    std::vector< char > affected( size(), 0 );
+    std::vector< id_type > order;
+    for ( auto id : dirty )
+    {
+        if ( affected[id] ) continue;
+        affected[id] = 1;
+        order.push_back( id );
+    }
+    dirty.clear();
+
+    for ( auto i(0u); i < order.size(); ++i )
+        for ( auto u : users[ order[i] ] )
+            if ( not affected[u] )
+            {
+                affected[u] = 1;
+                order.push_back( u );
+            }
+
+    // `users` holds each user once, so this counts distinct references.
+    std::vector< std::uint32_t > waiting( size(), 0 );
+    for ( auto id : order )
+        for ( auto u : users[id] )
+            ++waiting[u];
+
+    std::vector< id_type > level, next;
+    for ( auto id : order )
+        if ( waiting[id] == 0 ) level.push_back( id );
+
+    size_t evaluated = 0;
+    while ( not level.empty() )
+    {
+        if ( pool != nullptr and pool->size() > 1 and level.size() >= 2 * grain )
+        {
+            TaskGroup group;
+            for ( size_t first = 0; first < level.size(); first += grain )
+            {
+                auto last = std::min( level.size(), first + grain );
+                pool->run( group, [this, &level, first, last](){
+                    for ( auto i = first; i < last; ++i ) evaluate( level[i] ); } );
+            }
+            pool->wait( group );
+        }
+        else
+        {
+            for ( auto id : level ) evaluate( id );
+        }
+        evaluated += level.size();
+
+        next.clear();
+        for ( auto id : level )
+            for ( auto u : users[id] )
+                if ( --waiting[u] == 0 ) next.push_back( u );
+        level.swap( next );
+    }
+
+    std::vector< id_type > stuck;
+    for ( auto id : order )
+        if ( waiting[id] != 0 ) stuck.push_back( id );
+    if ( not stuck.empty() )
+        report_cycles( stuck );
+
+    return evaluated;
+}
+
+/// @brief Evaluates the definition of `id_`, whose references are all up to date.
+void Sheet::evaluate( id_type id_ )
+{
+    auto & c = cells[id_];
+    if ( not c.defined )
+    {
+        c.status = status_t::UNDEFINED;
+        return;
+    }
+    if ( c.parsed.type != Parser::ResultType::OK )
+    {
+        c.status = status_t::SYNTAX_ERROR;
+        return;
+    }
+
+    c.status = status_t::OK;
+    for ( auto i(0u); i < c.slots.size(); ++i )
+    {
+        const auto & ref = cells[ c.refs[i] ];
+        if ( not ref.has_value() )
+        {
+            c.status = status_t::BAD_REFERENCE;
+            c.blame = c.refs[i];
+            return;
+        }
+
+        // Only -(-32768) does not fit: that is the overflow evaluate_postfix() reports for it.
+        value_type value = c.negated[i] ? -ref.answer.first : ref.answer.first;
+        if ( value > std::numeric_limits< std::int16_t >::max() )
+        {
+            c.answer = answer_type( value, 10 );
+            return;
+        }
+        c.program[ c.slots[i] ].operand = static_cast< std::int16_t >( value );
+    }
+
+    c.answer = execute_program( c.program );
+}
+
+/// @brief Marks the cycles among the definitions in `stuck_` and what depends on them.
+/*!
+ * Finds the strongly connected components of the references among
+ * `stuck_` (Tarjan, without recursion). A definition is on a cycle if its
+ * component has more than one definition or it refers to itself; the
+ * others only depend on a cycle, through one of their stuck references.
+ */
+void Sheet::report_cycles( const std::vector< id_type > & stuck_ )
+{
+    const auto n = stuck_.size();
+    std::unordered_map< id_type, size_t > local;
+    for ( auto i(0u); i < n; ++i ) local.emplace( stuck_[i], i );
+
+    std::vector< std::vector< size_t > > refs( n );
+    for ( auto i(0u); i < n; ++i )
+        for ( auto ref : distinct( cells[ stuck_[i] ].refs ) )
+        {
+            auto found = local.find( ref );
+            if ( found != local.end() ) refs[i].push_back( found->second );
+        }
+
+    const size_t none = std::numeric_limits< size_t >::max();
+    std::vector< size_t > index( n, none ), low( n, 0 );
+    std::vector< char > on_stack( n, 0 ), cyclic( n, 0 );
+    std::vector< size_t > stack;
+    std::vector< std::pair< size_t, size_t > > calls; // Node, next reference to visit.
+    size_t counter = 0;
+
+    for ( auto root(0u); root < n; ++root )
+    {
+        if ( index[root] != none ) continue;
+        calls.emplace_back( root, 0 );
+
+        while ( not calls.empty() )
+        {
+            auto v = calls.back().first;
+            if ( index[v] == none )
+            {
+                index[v] = low[v] = counter++;
+                stack.push_back( v );
+                on_stack[v] = 1;
+            }
+
+            if ( calls.back().second < refs[v].size() )
+            {
+                auto w = refs[v][ calls.back().second++ ];
+                if ( index[w] == none )
+                    calls.emplace_back( w, 0 );
+                else if ( on_stack[w] )
+                    low[v] = std::min( low[v], index[w] );
+                continue;
+            }
+
+            if ( low[v] == index[v] )
+            {
+                std::vector< size_t > component;
+                do
+                {
+                    component.push_back( stack.back() );
+                    stack.pop_back();
+                    on_stack[ component.back() ] = 0;
+                } while ( component.back() != v );
+
+                bool self = std::find( refs[v].begin(), refs[v].end(), v ) != refs[v].end();
+                if ( component.size() > 1 or self )
+                    for ( auto w : component ) cyclic[w] = 1;
+            }
+
+            calls.pop_back();
+            if ( not calls.empty() )
+            {
+                auto parent = calls.back().first;
+                low[parent] = std::min( low[parent], low[v] );
+            }
+        }
+    }
+
+    // A definition that is stuck without being on a cycle waits for a stuck reference.
+    for ( auto i(0u); i < n; ++i )
+    {
+        auto & c = cells[ stuck_[i] ];
+        if ( cyclic[i] )
+            c.status = status_t::CYCLE;
+        else
+        {
+            c.status = status_t::BAD_REFERENCE;
+            c.blame = stuck_[ refs[i].front() ];
+        }
+    }
+}
+
+/// @return The names on the cycle that `id_` is on, starting and ending with `id_`.
+std::vector< Sheet::id_type > Sheet::cycle_of( id_type id_ ) const
+{
+    // Every definition on a cycle through id_ is itself marked CYCLE, so the search stays among those.
+    std::unordered_map< id_type, id_type > parent;
+    std::vector< id_type > frontier{ id_ };
+    for ( auto i(0u); i < frontier.size(); ++i )
+    {
+        for ( auto ref : cells[ frontier[i] ].refs )
+        {
+            if ( cells[ref].status != status_t::CYCLE or parent.count( ref ) ) continue;
+            parent.emplace( ref, frontier[i] );
+            if ( ref == id_ )
+            {
+                std::vector< id_type > path{ id_ };
+                for ( auto at = parent[id_]; at != id_; at = parent[at] ) path.push_back( at );
+                path.push_back( id_ );
+                std::reverse( path.begin() + 1, path.end() - 1 );
+                return path;
+            }
+            frontier.push_back( ref );
+        }
+    }
+
+    return { id_ };
+}
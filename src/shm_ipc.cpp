@@ -0,0 +1,510 @@
+/**
+ * @file shm_ipc.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shared Memory Front End Code
+ * @brief Serves BARES to clients on the same host through shared memory rings.
+ */
+
+#include "../include/shm_ipc.hpp"
+#include "../include/infix2postfix.hpp"
+
+#include <cassert>  // assert
+#include <cerrno>   // errno
+#include <csignal>  // kill
+#include <cstring>  // std::memcpy
+#include <iostream> // std::cerr
+#include <new>      // placement new
+
+#include <fcntl.h>    // O_CREAT, O_RDWR
+#include <sched.h>    // sched_yield
+#include <sys/mman.h> // shm_open, mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // ftruncate, close, getpid
+
+namespace
+{
+    //! Rings and their data start on their own pages.
+    constexpr size_t page = 4096;
+
+    size_t align_up( size_t n_, size_t to_ ) { return ( n_ + to_ - 1 ) / to_ * to_; }
+
+    //! @brief Where the slots start.
+    size_t slots_offset( void ) { return align_up( sizeof( ShmHeader ), alignof( ShmSlot ) ); }
+
+    //! @brief Where the ring data starts.
+    size_t data_offset( std::uint32_t slots_ ) { return align_up( slots_offset() + slots_ * sizeof( ShmSlot ), page ); }
+
+    //! @brief Bytes of the whole object.
+    size_t object_size( std::uint32_t slots_, std::uint64_t ring_bytes_ )
+    {
+        return data_offset( slots_ ) + 2 * slots_ * ring_bytes_;
+    }
+
+    //! @brief POSIX names of shared memory objects start with a slash.
+    std::string object_name( const std::string & name_ )
+    {
+        return name_.empty() or name_[0] != '/' ? "/" + name_ : name_;
+    }
+
+    //! @brief Says if process `pid_` still runs.
+    bool alive( std::int32_t pid_ )
+    {
+        return pid_ > 0 and ( kill( pid_, 0 ) == 0 or errno != ESRCH );
+    }
+
+    //! @brief Says if the object `name_` was left behind by a server that is gone.
+    bool stale_object( const std::string & name_ )
+    {
+        int fd = shm_open( name_.c_str(), O_RDONLY, 0 );
+        if ( fd < 0 ) return false;
+
+        struct stat st;
+        void * base = MAP_FAILED;
+        if ( fstat( fd, &st ) == 0 and static_cast< size_t >( st.st_size ) >= sizeof( ShmHeader ) )
+            base = mmap( nullptr, sizeof( ShmHeader ), PROT_READ, MAP_SHARED, fd, 0 );
+        close( fd );
+        if ( base == MAP_FAILED ) return false;
+
+        // Anything else may be in use, or not ours at all.
+        auto h = static_cast< const ShmHeader * >( base );
+        bool stale = h->magic == shm_magic and h->version == shm_version and not alive( h->server_pid );
+        munmap( base, sizeof( ShmHeader ) );
+        return stale;
+    }
+
+    //! @brief Sets the slot's `interrupt` and wakes whoever sleeps on its rings.
+    void interrupt_slot( ShmSlot & slot_ )
+    {
+        slot_.interrupt.store( 1, std::memory_order_release );
+        for ( auto ring : { &slot_.requests, &slot_.responses } )
+        {
+            ring->readable.fetch_add( 1 );
+            futex_wake_all( ring->readable );
+            ring->writable.fetch_add( 1 );
+            futex_wake_all( ring->writable );
+        }
+    }
+
+    //! @brief Hands the slot over to its server thread, which empties the rings and frees it.
+    void abandon_slot( ShmSlot & slot_ )
+    {
+        slot_.claimed.store( SLOT_ABANDONED, std::memory_order_release );
+        interrupt_slot( slot_ );
+    }
+
+    //! @brief Parses and evaluates one expression, like a line of an input file.
+    ShmResult evaluate_request( Parser & parser_, const char * record_, std::uint32_t length_ )
+    {
+        ShmResult out{ 0, 0, 0, 0, 0 };
+
+        // Not a record ShmClient sends.
+        if ( length_ < sizeof( out.id ) )
+        {
+            out.code = Parser::ResultType::UNEXPECTED_END_OF_EXPRESSION;
+            return out;
+        }
+
+        std::memcpy( &out.id, record_, sizeof( out.id ) );
+
+        std::string expression( record_ + sizeof( out.id ), length_ - sizeof( out.id ) );
+        auto result = parser_.parse( expression );
+        out.code = result.type;
+        if ( result.type != Parser::ResultType::OK )
+        {
+            out.at_col = result.at_col;
+            return out;
+        }
+
+        auto depth = parser_.get_stack_depth();
+        auto answer = evaluate_postfix( infix2postfix( parser_.get_tokens(), depth ), depth );
+        out.eval = answer.second;
+        out.value = answer.first;
+        return out;
+    }
+}
+
+//=== ShmSegment
+
+ShmSegment::~ShmSegment()
+{
+    if ( base != nullptr )
+        munmap( base, length );
+
+    if ( not owned.empty() )
+        shm_unlink( owned.c_str() );
+}
+
+/// @brief Creates the object `name_` and maps it. @return false on any problem, or if a live server has it.
+bool ShmSegment::create( const std::string & name_, const ShmConfig & config_ )
+{
+    auto name = object_name( name_ );
+    std::uint64_t ring_bytes = page;
+    while ( ring_bytes < config_.ring_bytes ) ring_bytes <<= 1;
+
+    int fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+
+    // Only an object left behind by a server that did not stop cleanly is replaced.
+    if ( fd < 0 and errno == EEXIST )
+    {
+        if ( not stale_object( name ) )
+        {
+            std::cerr << "The shared memory object \"" << name << "\" is in use (or is not a BARES one)!\n";
+            return false;
+        }
+        shm_unlink( name.c_str() );
+        fd = shm_open( name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600 );
+    }
+    if ( fd < 0 ) return false;
+
+    length = object_size( config_.slots, ring_bytes );
+    if ( ftruncate( fd, static_cast< off_t >( length ) ) != 0 )
+    {
+        close( fd );
+        shm_unlink( name.c_str() );
+        return false;
+    }
+
+    base = mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( base == MAP_FAILED )
+    {
+        base = nullptr;
+        shm_unlink( name.c_str() );
+        return false;
+    }
+    owned = name;
+
+    auto h = new ( base ) ShmHeader;
+    h->magic = shm_magic;
+    h->version = shm_version;
+    h->slots = config_.slots;
+    h->ring_bytes = ring_bytes;
+    h->stop.store( 0 );
+    h->ready.store( 0 );
+    h->server_pid = static_cast< std::int32_t >( getpid() );
+
+    for ( auto i(0u); i < config_.slots; ++i )
+    {
+        auto s = new ( static_cast< char * >( base ) + slots_offset() + i * sizeof( ShmSlot ) ) ShmSlot;
+        s->claimed.store( SLOT_FREE );
+        s->owner.store( 0 );
+        s->interrupt.store( 0 );
+        init_ring( s->requests );
+        init_ring( s->responses );
+    }
+
+    return true;
+}
+
+/// @brief Maps an object made by create(). @return false if it is missing or not valid.
+bool ShmSegment::attach( const std::string & name_ )
+{
+    int fd = shm_open( object_name( name_ ).c_str(), O_RDWR, 0 );
+    if ( fd < 0 ) return false;
+
+    struct stat st;
+    if ( fstat( fd, &st ) != 0 or static_cast< size_t >( st.st_size ) < sizeof( ShmHeader ) )
+    {
+        close( fd );
+        return false;
+    }
+
+    length = static_cast< size_t >( st.st_size );
+    base = mmap( nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if ( base == MAP_FAILED )
+    {
+        base = nullptr;
+        return false;
+    }
+
+    // The header must describe exactly the object that was mapped.
+    auto h = header();
+    if ( h->magic != shm_magic or h->version != shm_version or h->slots == 0 or
+         ( h->ring_bytes & ( h->ring_bytes - 1 ) ) != 0 or object_size( h->slots, h->ring_bytes ) != length )
+    {
+        munmap( base, length );
+        base = nullptr;
+        return false;
+    }
+
+    return true;
+}
+
+ShmSlot & ShmSegment::slot( std::uint32_t i_ ) const
+{
+    assert( i_ < header()->slots );
+    return *reinterpret_cast< ShmSlot * >( static_cast< char * >( base ) + slots_offset() + i_ * sizeof( ShmSlot ) );
+}
+
+SpscRing ShmSegment::request_ring( std::uint32_t i_ ) const
+{
+    auto ring_bytes = header()->ring_bytes;
+    auto data = static_cast< char * >( base ) + data_offset( header()->slots ) + 2 * i_ * ring_bytes;
+    return SpscRing( &slot( i_ ).requests, data, ring_bytes );
+}
+
+SpscRing ShmSegment::response_ring( std::uint32_t i_ ) const
+{
+    auto ring_bytes = header()->ring_bytes;
+    auto data = static_cast< char * >( base ) + data_offset( header()->slots ) + ( 2 * i_ + 1 ) * ring_bytes;
+    return SpscRing( &slot( i_ ).responses, data, ring_bytes );
+}
+
+//=== ShmServer
+
+/// @brief Creates the shared memory object `name_` and starts one thread per slot. @return false on any problem.
+bool ShmServer::start( const std::string & name_, const ShmConfig & config_ )
+{
+    if ( config_.slots == 0 or not segment.create( name_, config_ ) )
+        return false;
+
+    blocking = config_.blocking;
+    for ( auto i(0u); i < config_.slots; ++i )
+        workers.emplace_back( &ShmServer::serve, this, i );
+
+    segment.header()->ready.store( 1, std::memory_order_release );
+    return true;
+}
+
+/// @brief Tells the clients and the threads to stop, then joins the threads.
+void ShmServer::stop( void )
+{
+    if ( workers.empty() ) return;
+
+    auto h = segment.header();
+    h->stop.store( 1, std::memory_order_release );
+
+    // Whoever sleeps on a ring wakes up and sees `stop`.
+    for ( auto i(0u); i < h->slots; ++i )
+        interrupt_slot( segment.slot( i ) );
+
+    for ( auto & w : workers )
+        w.join();
+    workers.clear();
+}
+
+/// @brief Serves slot `i_` until the server stops.
+void ShmServer::serve( std::uint32_t i_ )
+{
+    auto requests = segment.request_ring( i_ );
+    auto responses = segment.response_ring( i_ );
+    const auto * stop = &segment.header()->stop;
+    const auto * interrupt = &segment.slot( i_ ).interrupt;
+    Parser parser( limits );
+
+    for ( ;; )
+    {
+        // The server stops, or the client died: waits end early for both.
+        if ( interrupt->load( std::memory_order_acquire ) != 0 )
+        {
+            if ( stop->load( std::memory_order_acquire ) != 0 ) return;
+            reclaim( i_ );
+            requests = segment.request_ring( i_ );
+            responses = segment.response_ring( i_ );
+        }
+        if ( not requests.wait_readable( blocking, interrupt ) ) continue;
+
+        // Everything published is answered as one batch.
+        const char * record;
+        std::uint32_t length;
+        while ( requests.peek( record, length ) )
+        {
+            auto result = evaluate_request( parser, record, length );
+            if ( not responses.try_push( &result, sizeof( result ) ) )
+            {
+                // Let the client read what is done, and send more, while we wait.
+                responses.publish();
+                requests.release();
+                if ( not responses.wait_writable( sizeof( result ), blocking, interrupt ) ) break;
+                responses.try_push( &result, sizeof( result ) );
+            }
+            requests.pop();
+        }
+
+        requests.release();
+        responses.publish();
+
+        // A client that writes past its ring loses the slot, as if it died.
+        if ( requests.corrupt() )
+        {
+            std::cerr << "Client of slot " << i_ << " sent a corrupt record; the slot is reclaimed.\n";
+            segment.slot( i_ ).owner.store( 0, std::memory_order_release );
+            abandon_slot( segment.slot( i_ ) );
+        }
+    }
+}
+
+/// @brief Empties the rings of slot `i_`, whose client died or sent a corrupt record, and frees it.
+void ShmServer::reclaim( std::uint32_t i_ )
+{
+    auto & s = segment.slot( i_ );
+    init_ring( s.requests );
+    init_ring( s.responses );
+    s.interrupt.store( 0, std::memory_order_relaxed );
+    s.claimed.store( SLOT_FREE, std::memory_order_release );
+}
+
+//=== ShmClient
+
+/// @brief Maps the server's object and claims a free slot, or one whose client died. @return false if there is none.
+bool ShmClient::connect( const std::string & name_ )
+{
+    if ( connected or not segment.attach( name_ ) ) return false;
+
+    auto h = segment.header();
+    auto me = static_cast< std::int32_t >( getpid() );
+    while ( h->stop.load( std::memory_order_acquire ) == 0 )
+    {
+        for ( auto i(0u); i < h->slots; ++i )
+        {
+            std::uint32_t expected = SLOT_FREE;
+            if ( segment.slot( i ).claimed.compare_exchange_strong( expected, SLOT_CLAIMED, std::memory_order_acq_rel ) )
+            {
+                segment.slot( i ).owner.store( me, std::memory_order_release );
+                index = i;
+                connected = true;
+                requests = segment.request_ring( i );
+                responses = segment.response_ring( i );
+                submitted = received = 0;
+                early.clear();
+                return true;
+            }
+        }
+
+        // None is free: the server thread of a slot whose client died empties
+        // it, and we try again. Taking the owner first keeps two clients from
+        // handing over the same slot, or a slot that changed hands meanwhile.
+        bool reclaiming = false;
+        for ( auto i(0u); i < h->slots; ++i )
+        {
+            auto & s = segment.slot( i );
+            auto owner = s.owner.load( std::memory_order_acquire );
+            if ( owner > 0 and not alive( owner ) and s.owner.compare_exchange_strong( owner, 0, std::memory_order_acq_rel ) )
+            {
+                abandon_slot( s );
+                reclaiming = true;
+            }
+            else
+                reclaiming = reclaiming or s.claimed.load( std::memory_order_acquire ) != SLOT_CLAIMED;
+        }
+        if ( not reclaiming ) return false;
+        sched_yield();
+    }
+
+    return false;
+}
+
+/// @brief Waits for the outstanding results and gives the slot back.
+void ShmClient::disconnect( void )
+{
+    if ( not connected ) return;
+
+    // The rings must be empty for the next client of the slot.
+    ShmResult ignored;
+    while ( outstanding() > 0 and wait( ignored ) ) { /* empty */ }
+
+    segment.slot( index ).owner.store( 0, std::memory_order_relaxed );
+    segment.slot( index ).claimed.store( SLOT_FREE, std::memory_order_release );
+    connected = false;
+}
+
+/// @brief Stages an expression; it is sent by flush(), or sooner if the ring fills up.
+/// @return false if the expression is longer than the ring takes or the server stopped.
+bool ShmClient::submit( const std::string & expression_, std::uint64_t id_ )
+{
+    if ( not connected ) return false;
+
+    record.resize( sizeof( id_ ) + expression_.size() );
+    std::memcpy( record.data(), &id_, sizeof( id_ ) );
+    std::memcpy( record.data() + sizeof( id_ ), expression_.data(), expression_.size() );
+    if ( record.size() > requests.max_record() ) return false;
+
+    auto length = static_cast< std::uint32_t >( record.size() );
+    while ( not requests.try_push( record.data(), length ) )
+    {
+        // The server may be waiting for us to read results, so poll both rings instead of sleeping.
+        requests.publish();
+        drain();
+        if ( segment.header()->stop.load( std::memory_order_acquire ) != 0 ) return false;
+        sched_yield();
+    }
+
+    ++submitted;
+    return true;
+}
+
+/// @brief Sends the staged expressions.
+void ShmClient::flush( void )
+{
+    if ( connected ) requests.publish();
+}
+
+/// @brief Moves the results already published into `early`.
+void ShmClient::drain( void )
+{
+    const char * data;
+    std::uint32_t length;
+    bool any = false;
+
+    while ( responses.peek( data, length ) )
+    {
+        assert( length == sizeof( ShmResult ) );
+        ShmResult result;
+        std::memcpy( &result, data, sizeof( result ) );
+        early.push_back( result );
+        responses.pop();
+        ++received;
+        any = true;
+    }
+
+    if ( any ) responses.release();
+}
+
+/// @brief Takes a result if one is ready. @return false if none is.
+bool ShmClient::poll( ShmResult & result_ )
+{
+    if ( early.empty() )
+        drain();
+
+    if ( early.empty() ) return false;
+
+    result_ = early.front();
+    early.pop_front();
+    return true;
+}
+
+/// @brief Waits for the next result. @return false if none is outstanding or the server stopped.
+bool ShmClient::wait( ShmResult & result_ )
+{
+    if ( poll( result_ ) ) return true;
+    if ( not connected or outstanding() == 0 ) return false;
+
+    // Nothing comes back for expressions that were never sent.
+    requests.publish();
+    if ( not responses.wait_readable( blocking, &segment.header()->stop ) ) return false;
+
+    return poll( result_ );
+}
+
+/// @brief Submits a batch and waits for all of its results, in order.
+std::vector< ShmResult > ShmClient::evaluate( const std::vector< std::string > & expressions_ )
+{
+    // Results of earlier submissions would be mixed with the batch.
+    assert( outstanding() == 0 and early.empty() );
+
+    std::vector< ShmResult > results;
+    results.reserve( expressions_.size() );
+
+    for ( auto i(0u); i < expressions_.size(); ++i )
+        if ( not submit( expressions_[i], i ) ) return results;
+    flush();
+
+    ShmResult r;
+    while ( results.size() < expressions_.size() and wait( r ) )
+        results.push_back( r );
+
+    return results;
+}
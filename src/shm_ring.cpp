@@ -0,0 +1,244 @@
+/**
+ * @file shm_ring.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Shared Memory Ring Code
+ * @brief Lock-free single-producer/single-consumer ring of records, for shared memory.
+ */
+
+#include "../include/shm_ring.hpp"
+
+#include <cassert>  // assert
+#include <climits>  // INT_MAX
+#include <cstring>  // std::memcpy
+#include <thread>   // std::thread::hardware_concurrency
+
+#include <linux/futex.h> // FUTEX_WAIT, FUTEX_WAKE
+#include <sched.h>       // sched_yield
+#include <sys/syscall.h> // SYS_futex
+#include <unistd.h>      // syscall
+
+namespace
+{
+    //! Length of the record that says "the next record is at the start of the data".
+    constexpr std::uint32_t wrap_marker = 0xFFFFFFFFu;
+
+    //! Polls before a waiting side goes to sleep or starts yielding; on a single CPU, spinning only delays the other side.
+    const int spin_limit = std::thread::hardware_concurrency() > 1 ? 4096 : 0;
+
+    //! @brief Tells the CPU this is a spin loop.
+    inline void cpu_relax( void )
+    {
+#if defined( __x86_64__ ) or defined( __i386__ )
+        __builtin_ia32_pause();
+#endif
+    }
+
+    //! @brief Sleeps while `word_` holds `expected_`. Not FUTEX_PRIVATE: the word is shared between processes.
+    void futex_wait( std::atomic< std::uint32_t > & word_, std::uint32_t expected_ )
+    {
+        syscall( SYS_futex, reinterpret_cast< std::uint32_t * >( &word_ ), FUTEX_WAIT, expected_, nullptr, nullptr, 0 );
+    }
+
+    //! @brief Bumps the futex word and wakes its sleepers, if the other side said it sleeps.
+    void notify( std::atomic< std::uint32_t > & word_, std::atomic< std::uint32_t > & waiting_ )
+    {
+        // Pairs with the fence in wait(): either the sleeper sees the new
+        // counter, or this sees its flag.
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if ( waiting_.load( std::memory_order_relaxed ) != 0 )
+        {
+            word_.fetch_add( 1, std::memory_order_release );
+            futex_wake_all( word_ );
+        }
+    }
+
+    //! @brief Spins, then sleeps on `word_` or yields, until `ready_()` or a non-zero `stop_`.
+    template < typename Ready >
+    bool wait( Ready ready_, std::atomic< std::uint32_t > & word_, std::atomic< std::uint32_t > & waiting_,
+               bool blocking_, const std::atomic< std::uint32_t > * stop_ )
+    {
+        for ( int spin = 0; ; ++spin )
+        {
+            if ( ready_() ) return true;
+            if ( stop_ != nullptr and stop_->load( std::memory_order_acquire ) != 0 ) return false;
+
+            if ( spin < spin_limit )
+                cpu_relax();
+            else if ( not blocking_ )
+                sched_yield();
+            else
+            {
+                auto seq = word_.load( std::memory_order_acquire );
+                waiting_.store( 1, std::memory_order_relaxed );
+                std::atomic_thread_fence( std::memory_order_seq_cst );
+
+                if ( not ready_() and ( stop_ == nullptr or stop_->load( std::memory_order_acquire ) == 0 ) )
+                    futex_wait( word_, seq );
+
+                waiting_.store( 0, std::memory_order_relaxed );
+            }
+        }
+    }
+}
+
+/// @brief Puts a ring's control block in its initial, empty state.
+void init_ring( RingControl & control_ )
+{
+    control_.head.store( 0 );
+    control_.tail.store( 0 );
+    control_.readable.store( 0 );
+    control_.consumer_waiting.store( 0 );
+    control_.writable.store( 0 );
+    control_.producer_waiting.store( 0 );
+}
+
+/// @brief Wakes every thread sleeping on `word_`, in any process.
+void futex_wake_all( std::atomic< std::uint32_t > & word_ )
+{
+    syscall( SYS_futex, reinterpret_cast< std::uint32_t * >( &word_ ), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0 );
+}
+
+/// @brief A view of the ring at `control_`, with `capacity_` bytes of data (a power of two) at `data_`.
+SpscRing::SpscRing( RingControl * control_, char * data_, size_t capacity_ )
+    : control( control_ )
+    , data( data_ )
+    , capacity( capacity_ )
+{
+    assert( ( capacity & ( capacity - 1 ) ) == 0 );
+
+    // Both sides may attach to a ring that was already used.
+    if ( control != nullptr )
+    {
+        local_tail = control->tail.load( std::memory_order_acquire );
+        local_head = control->head.load( std::memory_order_acquire );
+        cached_head = local_head;
+        cached_tail = local_tail;
+    }
+}
+
+/// @return true if a record of `length_` bytes fits after the staged ones, given `head_`.
+bool SpscRing::fits( std::uint32_t length_, std::uint64_t head_ ) const
+{
+    auto offset = local_tail & ( capacity - 1 );
+    auto need = footprint( length_ );
+    auto contiguous = capacity - offset;
+
+    // A record that would cross the end starts over at the beginning.
+    auto total = need <= contiguous ? need : contiguous + need;
+    return local_tail + total - head_ <= capacity;
+}
+
+/// @brief Stages a record. @return false if there is no room for it now.
+bool SpscRing::try_push( const void * data_, std::uint32_t length_ )
+{
+    assert( length_ <= max_record() );
+
+    if ( not fits( length_, cached_head ) )
+    {
+        cached_head = control->head.load( std::memory_order_acquire );
+        if ( not fits( length_, cached_head ) ) return false;
+    }
+
+    auto offset = local_tail & ( capacity - 1 );
+    if ( footprint( length_ ) > capacity - offset )
+    {
+        std::memcpy( data + offset, &wrap_marker, 4 );
+        local_tail += capacity - offset;
+        offset = 0;
+    }
+
+    std::memcpy( data + offset, &length_, 4 );
+    std::memcpy( data + offset + 4, data_, length_ );
+    local_tail += footprint( length_ );
+    return true;
+}
+
+/// @brief Makes the staged records visible, waking the consumer if it sleeps.
+void SpscRing::publish( void )
+{
+    control->tail.store( local_tail, std::memory_order_release );
+    notify( control->readable, control->consumer_waiting );
+}
+
+/// @brief Waits until a record of `length_` bytes fits, or `stop_` becomes non-zero. @return true if it fits.
+bool SpscRing::wait_writable( std::uint32_t length_, bool blocking_, const std::atomic< std::uint32_t > * stop_ )
+{
+    auto ready = [&](){
+        cached_head = control->head.load( std::memory_order_acquire );
+        return fits( length_, cached_head ); };
+
+    return wait( ready, control->writable, control->producer_waiting, blocking_, stop_ );
+}
+
+/// @brief The next record, if any. @return false if none is published, or if the ring is corrupt().
+bool SpscRing::peek( const char *& data_, std::uint32_t & length_ )
+{
+    if ( broken ) return false;
+
+    if ( local_head == cached_tail )
+    {
+        cached_tail = control->tail.load( std::memory_order_acquire );
+        if ( local_head == cached_tail ) return false;
+    }
+
+    // The producer may be another process: nothing it wrote is trusted.
+    auto head = local_head;
+    auto offset = head & ( capacity - 1 );
+    if ( cached_tail - head > capacity or offset + 4 > capacity )
+    {
+        broken = true;
+        return false;
+    }
+    std::memcpy( &length_, data + offset, 4 );
+
+    // A wrap marker is always followed by a record, at the start.
+    if ( length_ == wrap_marker )
+    {
+        head += capacity - offset;
+        offset = 0;
+        if ( cached_tail - head < 4 or cached_tail - head > capacity )
+        {
+            broken = true;
+            return false;
+        }
+        std::memcpy( &length_, data, 4 );
+    }
+
+    if ( length_ > max_record() or offset + 4 + length_ > capacity or footprint( length_ ) > cached_tail - head )
+    {
+        broken = true;
+        return false;
+    }
+
+    local_head = head;
+    data_ = data + offset + 4;
+    popped = static_cast< std::uint32_t >( footprint( length_ ) );
+    return true;
+}
+
+/// @brief Drops the record returned by peek().
+void SpscRing::pop( void )
+{
+    local_head += popped;
+    popped = 0;
+}
+
+/// @brief Gives the room of the popped records back, waking the producer if it sleeps.
+void SpscRing::release( void )
+{
+    control->head.store( local_head, std::memory_order_release );
+    notify( control->writable, control->producer_waiting );
+}
+
+/// @brief Waits until a record is published, or `stop_` becomes non-zero. @return true if there is one.
+bool SpscRing::wait_readable( bool blocking_, const std::atomic< std::uint32_t > * stop_ )
+{
+    auto ready = [&](){
+        if ( local_head != cached_tail ) return true;
+        cached_tail = control->tail.load( std::memory_order_acquire );
+        return local_head != cached_tail; };
+
+    return wait( ready, control->readable, control->consumer_waiting, blocking_, stop_ );
+}
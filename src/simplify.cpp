@@ -0,0 +1,219 @@
+/**
+ * @file simplify.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Simplify Code
+ * @brief Algebraic simplification and strength reduction of compiled programs.
+ */
+
+#include "../include/simplify.hpp"
+#include "../include/range_analysis.hpp"
+
+#include <cassert> // assert
+#include <limits>  // std::numeric_limits
+#include <utility> // std::pair
+#include <vector>  // std::vector
+
+namespace
+{
+    const value_type short_min = std::numeric_limits< short int >::min();
+    const value_type short_max = std::numeric_limits< short int >::max();
+
+    /*!
+     * @brief The program as a tree, so an operation can see its whole operands.
+     *
+     * Nodes are made in postfix order and a rewrite only points at older
+     * nodes, so the children of a node always come before it.
+     */
+    class Tree
+    {
+        public:
+            /// @brief A node: an instruction and the nodes of its operands.
+            struct Node
+            {
+                Instruction ins;
+                int left;       //!< First operand, or the only one; -1 for PUSH.
+                int right;      //!< Second operand of a binary operation; -1 otherwise.
+                Interval range; //!< Values it may give, from the analysis of the original program.
+            };
+
+            explicit Tree( SimplifyStats & stats_ ) : stats( stats_ ) { /* empty */ }
+
+            /// @brief Adds the instruction `ins_`, with operands `left_` and `right_`. @return Its node, or the node that replaces it.
+            int add( const Instruction & ins_, int left_, int right_, const Interval & range_ );
+
+            /// @return The program that computes `root_`.
+            Program emit( int root_ ) const;
+
+        private:
+            std::vector< Node > nodes;
+            SimplifyStats & stats;
+
+            int make( opcode_t op_, std::int16_t operand_, int left_, int right_, const Interval & range_ )
+            {
+                nodes.push_back( Node{ Instruction{ op_, 0, operand_ }, left_, right_, range_ } );
+                return static_cast< int >( nodes.size() ) - 1;
+            }
+
+            /// @brief Whether `i_` pushes the literal `value_`.
+            bool is_literal( int i_, value_type value_ ) const
+            {
+                return nodes[i_].ins.op == opcode_t::PUSH and nodes[i_].ins.operand == value_;
+            }
+
+            /// @return k if `i_` pushes the literal 2^k, or -2^k with `either_sign_`; -1 otherwise.
+            int power_of_two( int i_, bool either_sign_ = false ) const
+            {
+                if ( nodes[i_].ins.op != opcode_t::PUSH ) return -1;
+                value_type v = nodes[i_].ins.operand;
+                if ( either_sign_ and v < 0 ) v = -v;
+                if ( v < 1 or ( v & ( v - 1 ) ) != 0 ) return -1;
+
+                int k = 0;
+                while ( ( value_type( 1 ) << k ) != v ) ++k;
+                return k;
+            }
+
+            /// @brief The unary `op_` on `child_`, folded or cancelled where that is safe.
+            int unary( opcode_t op_, int k_, int child_, const Interval & range_ );
+    };
+
+    /// @brief The unary `op_` on `child_`, folded or cancelled where that is safe.
+    int Tree::unary( opcode_t op_, int k_, int child_, const Interval & range_ )
+    {
+        const auto & child = nodes[child_];
+        Instruction ins{ op_, 0, static_cast< std::int16_t >( k_ ) };
+
+        // A literal operand: the result, if it can't fail.
+        if ( child.ins.op == opcode_t::PUSH )
+        {
+            auto value = execute_unary( child.ins.operand, ins );
+            if ( value >= short_min and value <= short_max )
+            {
+                ++stats.folded;
+                return make( opcode_t::PUSH, static_cast< std::int16_t >( value ), -1, -1, range_ );
+            }
+        }
+
+        // -(-x) is x, unless the inner negation overflows, for x = -32768.
+        if ( op_ == opcode_t::NEG and child.ins.op == opcode_t::NEG and nodes[ child.left ].range.lo > short_min )
+        {
+            ++stats.removed;
+            return child.left;
+        }
+
+        return make( op_, ins.operand, child_, -1, range_ );
+    }
+
+    /// @brief Adds the instruction `ins_`, with operands `left_` and `right_`. @return Its node, or the node that replaces it.
+    int Tree::add( const Instruction & ins_, int left_, int right_, const Interval & range_ )
+    {
+        if ( ins_.op == opcode_t::PUSH or is_unary( ins_.op ) )
+            return make( ins_.op, ins_.operand, left_, right_, range_ );
+
+        // Each operand is a short int that evaluation got past, so dropping
+        // an operation that gives one of them back unchanged drops no error.
+        auto keep = [&]( int operand_ ){ ++stats.removed; return operand_; };
+        auto negate = [&]( int operand_ ){ ++stats.negations; return unary( opcode_t::NEG, 0, operand_, range_ ); };
+        auto reduce = [&]( opcode_t op_, int k_, int operand_ ){ ++stats.reduced; return unary( op_, k_, operand_, range_ ); };
+
+        int k = -1;
+        switch ( ins_.op )
+        {
+            case opcode_t::ADD:
+                if ( is_literal( right_, 0 ) ) return keep( left_ );
+                if ( is_literal( left_, 0 ) ) return keep( right_ );
+                break;
+            case opcode_t::SUB:
+                if ( is_literal( right_, 0 ) ) return keep( left_ );
+                if ( is_literal( left_, 0 ) ) return negate( right_ );
+                break;
+            case opcode_t::MUL:
+                // The "-1 *" that Parser::term() puts before "-(" ends up here.
+                if ( is_literal( right_, 1 ) ) return keep( left_ );
+                if ( is_literal( left_, 1 ) ) return keep( right_ );
+                if ( is_literal( right_, -1 ) ) return negate( left_ );
+                if ( is_literal( left_, -1 ) ) return negate( right_ );
+                if ( ( k = power_of_two( right_ ) ) > 0 ) return reduce( opcode_t::SHL, k, left_ );
+                if ( ( k = power_of_two( left_ ) ) > 0 ) return reduce( opcode_t::SHL, k, right_ );
+                break;
+            case opcode_t::DIV:
+                if ( is_literal( right_, 1 ) ) return keep( left_ );
+                if ( is_literal( right_, -1 ) ) return negate( left_ );
+                if ( ( k = power_of_two( right_ ) ) > 0 ) return reduce( opcode_t::DIV2, k, left_ );
+                break;
+            case opcode_t::MOD:
+                // x % -d is x % d; x % 1 and x % -1 are 0, which MOD2 by 2^0 gives.
+                if ( ( k = power_of_two( right_, true ) ) >= 0 ) return reduce( opcode_t::MOD2, k, left_ );
+                break;
+            case opcode_t::POW:
+                if ( is_literal( right_, 1 ) ) return keep( left_ );
+                if ( is_literal( right_, 2 ) ) return reduce( opcode_t::SQR, 0, left_ );
+                break;
+            default:
+                assert( false );
+        }
+
+        return make( ins_.op, 0, left_, right_, range_ );
+    }
+
+    /// @return The program that computes `root_`.
+    Program Tree::emit( int root_ ) const
+    {
+        Program program;
+
+        // Post-order walk without recursion: a node is emitted after its operands.
+        std::vector< std::pair< int, int > > todo{ { root_, 0 } }; // Node, operands already emitted.
+        while ( not todo.empty() )
+        {
+            auto & top = todo.back();
+            const auto & node = nodes[ top.first ];
+            int next = top.second == 0 ? node.left : top.second == 1 ? node.right : -1;
+
+            if ( next >= 0 )
+            {
+                ++top.second;
+                todo.emplace_back( next, 0 );
+                continue;
+            }
+
+            program.push_back( node.ins );
+            todo.pop_back();
+        }
+
+        return program;
+    }
+}
+
+/// @brief Rewrites a program into one that does less work for the same results.
+SimplifyStats simplify_program( Program & program_ )
+{
+    SimplifyStats stats;
+    if ( program_.empty() )
+        return stats;
+
+    auto info = analyze_ranges( program_.data(), program_.data() + program_.size() );
+    Tree tree( stats );
+    std::vector< int > operands;
+
+    for ( auto i(0u); i < program_.size(); ++i )
+    {
+        const auto & ins = program_[i];
+        int left = -1, right = -1;
+        if ( is_unary( ins.op ) )
+        {
+            left = operands.back(); operands.pop_back();
+        }
+        else if ( ins.op != opcode_t::PUSH )
+        {
+            right = operands.back(); operands.pop_back();
+            left = operands.back(); operands.pop_back();
+        }
+        operands.push_back( tree.add( ins, left, right, info[i].range ) );
+    }
+
+    assert( operands.size() == 1 );
+    program_ = tree.emit( operands.back() );
+    return stats;
+}
@@ -0,0 +1,385 @@
+/**
+ * @file stream_parser.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Streaming Parser Code
+ * @brief Parses and evaluates expressions read in fixed-size chunks.
+ */
+
+#include "../include/stream_parser.hpp"
+
+#include <cstring> // std::memchr
+#include <limits>  // std::numeric_limits
+
+//=== ChunkSource
+
+/// @brief Reads `is_` in chunks of `chunk_size_` bytes.
+ChunkSource::ChunkSource( std::istream & is_, size_t chunk_size_ )
+    : is( is_ )
+    , buffer( ( chunk_size_ == 0 ? 1 : chunk_size_ ) + 1 )
+{ /* empty */ }
+
+/// @brief Reads the next chunk if the current one is over. @return false at the end of the input.
+bool ChunkSource::fill( void )
+{
+    if ( pos < length ) return true;
+
+    // Keep the last character, so back() still works after the refill.
+    buffer[0] = buffer[ length - 1 ];
+    is.read( buffer.data() + 1, buffer.size() - 1 );
+    pos = 1;
+    length = 1 + static_cast< size_t >( is.gcount() );
+
+    return length > 1;
+}
+
+/// @return true if there is another line to read.
+bool ChunkSource::has_line( void )
+{
+    column = 0;
+    return fill();
+}
+
+/// @return true at the end of the line (or of the input), or at the line limit.
+bool ChunkSource::at_end( void )
+{
+    return column >= line_limit or not fill() or buffer[pos] == '\n';
+}
+
+/// @brief Skips what is left of the current line, including its '\n'.
+/// @return The length of the line, without the '\n'.
+std::uint64_t ChunkSource::finish_line( void )
+{
+    while ( fill() )
+    {
+        auto first = buffer.data() + pos;
+        auto nl = static_cast< const char * >( std::memchr( first, '\n', length - pos ) );
+        if ( nl != nullptr )
+        {
+            column += nl - first;
+            pos += nl - first + 1;
+            return column;
+        }
+        column += length - pos;
+        pos = length;
+    }
+
+    return column;
+}
+
+//=== StreamParser
+
+/// @brief Parses and evaluates the next line of `src_`, which is left at the end of that line.
+StreamResult StreamParser::parse( ChunkSource & src_ )
+{
+    src = &src_;
+    src->set_line_limit( limits.max_bytes );
+    operators.clear();
+    values.clear();
+    scope_opening = 0;
+    scope_closing = 0;
+    last_token = token_kind::NONE;
+    token_count = 0;
+    operator_count = 0;
+    failed = false;
+    answer = std::make_pair( 0, 0 );
+
+    StreamResult out;
+
+    // Same checks, in the same order, as Parser::parse().
+    skip_ws();
+    if ( src->at_end() )
+    {
+        out.result = error( Parser::ResultType::UNEXPECTED_END_OF_EXPRESSION );
+    }
+    else
+    {
+        out.result = expression();
+
+        if ( out.result.type == Parser::ResultType::OK and scope_opening > scope_closing )
+            out.result = error( Parser::ResultType::MISSING_CLOSING_SCOPE );
+    }
+
+    // Pop out all the remaining operators.
+    if ( out.result.type == Parser::ResultType::OK )
+    {
+        while ( not operators.empty() )
+            apply_top();
+
+        if ( not failed )
+            answer = std::make_pair( values.top(), 0 );
+    }
+    out.answer = answer;
+
+    // The line was cut at the limit: whatever was found, it is too long.
+    if ( src_.finish_line() > limits.max_bytes )
+    {
+        out.result = Parser::ResultType( Parser::ResultType::LIMIT_EXCEEDED,
+                                         static_cast< Parser::ResultType::size_type >( limits.max_bytes ) );
+        out.answer = std::make_pair( 0, 0 );
+    }
+
+    return out;
+}
+
+/// @brief Skips any white space or tab.
+void StreamParser::skip_ws( void )
+{
+    while ( src->current() == ' ' or src->current() == '\t' )
+        src->advance();
+}
+
+/// @brief Consumes the current character if it is `c_`.
+bool StreamParser::accept( char c_ )
+{
+    if ( src->at_end() or src->current() != c_ ) return false;
+
+    src->advance();
+    return true;
+}
+
+/// @brief The parsing result `code_` at the current position plus `delta_`.
+Parser::ResultType StreamParser::error( Parser::ResultType::code_t code_, std::int64_t delta_ ) const
+{
+    return Parser::ResultType( code_, static_cast< std::int64_t >( src->offset() ) + delta_ );
+}
+
+/*!
+ * Parser::term() calls Parser::expression() after every "(", and that call
+ * only comes back successfully at the end of the input, so it is a tail
+ * call. Here it becomes a new turn of the loop, and ")" are consumed by
+ * the term they follow, exactly as Parser does.
+ */
+Parser::ResultType StreamParser::expression( void )
+{
+    while ( true )
+    {
+        //--- <term>
+        // Process the several '-' signs that may come before a term.
+        int minus = 0;
+        while ( src->current() == '-' )
+        {
+            ++minus;
+            src->advance();
+        }
+        bool has_signs = minus > 0;
+        minus = minus % 2;
+        skip_ws();
+
+        if ( src->current() == '(' and minus != 0 )
+        {
+            if ( not count_token( token_kind::OPERAND ) or not count_token( token_kind::OPERATOR ) )
+                return error( Parser::ResultType::LIMIT_EXCEEDED );
+
+            push_operand( -1 );
+            push_operator( '*' );
+        }
+        else if ( minus != 0 )
+        {
+            src->back();
+        }
+        skip_ws();
+
+        if ( has_signs and src->at_end() )
+            return error( Parser::ResultType::MISSING_TERM );
+
+        if ( accept( '(' ) )
+        {
+            ++scope_opening;
+            if ( not count_token( token_kind::OPENING ) or
+                 static_cast< size_t >( scope_opening - scope_closing ) > limits.max_depth )
+                return error( Parser::ResultType::LIMIT_EXCEEDED );
+
+            push_opening();
+            continue;
+        }
+
+        Parser::ResultType result;
+        if ( src->current() != ')' and not src->at_end() )
+        {
+            auto begin = static_cast< std::int64_t >( src->offset() );
+            value_type value = 0;
+
+            result = integer( value );
+            if ( result.type == Parser::ResultType::OK )
+            {
+                if ( value < std::numeric_limits< Parser::required_int_type >::min() or
+                     value > std::numeric_limits< Parser::required_int_type >::max() )
+                    return Parser::ResultType( Parser::ResultType::INTEGER_OUT_OF_RANGE, begin );
+
+                if ( not count_token( token_kind::OPERAND ) )
+                    return error( Parser::ResultType::LIMIT_EXCEEDED );
+
+                push_operand( value );
+            }
+            skip_ws();
+        }
+
+        // It consumes sequential closing parentheses.
+        while ( accept( ')' ) )
+        {
+            ++scope_closing;
+            if ( scope_opening - scope_closing < 0 )
+            {
+                return error( last_token == token_kind::OPERAND ? Parser::ResultType::EXTRANEOUS_SYMBOL
+                                                                : Parser::ResultType::ILL_FORMED_INTEGER, -1 );
+            }
+            // A ")" right after an operator or a "(" closes a missing term.
+            if ( result.type == Parser::ResultType::OK and
+                 ( last_token == token_kind::OPERATOR or last_token == token_kind::OPENING ) )
+                return error( Parser::ResultType::ILL_FORMED_INTEGER, -1 );
+
+            if ( not count_token( token_kind::CLOSING ) )
+                return error( Parser::ResultType::LIMIT_EXCEEDED );
+
+            // After a bad integer the conversion state does not matter anymore.
+            if ( result.type == Parser::ResultType::OK )
+                push_closing();
+            else
+                last_token = token_kind::CLOSING;
+
+            skip_ws();
+        }
+
+        if ( result.type != Parser::ResultType::OK )
+            return result;
+
+        //--- { operator, <term> }
+        skip_ws();
+        if ( src->at_end() )
+            return result;
+
+        char op = src->current();
+        if ( std::strchr( "^*/%+-", op ) == nullptr )
+            return error( Parser::ResultType::EXTRANEOUS_SYMBOL );
+
+        src->advance();
+        if ( not count_token( token_kind::OPERATOR ) )
+            return error( Parser::ResultType::LIMIT_EXCEEDED );
+
+        push_operator( op );
+
+        // After a operator, we need a term to apply operation.
+        skip_ws();
+        if ( src->at_end() )
+            return error( Parser::ResultType::MISSING_TERM );
+    }
+}
+
+/// @brief <integer> production; `value_` receives the number.
+Parser::ResultType StreamParser::integer( value_type & value_ )
+{
+    value_ = 0;
+    if ( accept( '0' ) )
+        return Parser::ResultType( Parser::ResultType::OK );
+
+    bool negative = accept( '-' );
+
+    // <natural_number> := <digit_excl_zero>,{<digit>};
+    if ( src->current() < '1' or src->current() > '9' )
+        return error( Parser::ResultType::ILL_FORMED_INTEGER );
+
+    // Saturates just past the range: the exact value of a longer number is never needed.
+    const value_type saturation = std::numeric_limits< Parser::required_int_type >::max() + 2;
+    while ( src->current() >= '0' and src->current() <= '9' )
+    {
+        if ( value_ < saturation )
+            value_ = value_ * 10 + ( src->current() - '0' );
+        src->advance();
+    }
+
+    if ( negative ) value_ = -value_;
+    return Parser::ResultType( Parser::ResultType::OK );
+}
+
+/// @brief Counts a token, as Parser::push_token() does. @return false if that goes over a limit.
+bool StreamParser::count_token( token_kind kind_ )
+{
+    if ( kind_ == token_kind::OPERATOR and ++operator_count > limits.max_steps )
+        return false;
+
+    return ++token_count <= limits.max_tokens;
+}
+
+//=== Conversion and evaluation.
+
+namespace
+{
+    //! @brief Same weights the parser gives to the tokens.
+    int precedence( char op_ )
+    {
+        switch ( op_ )
+        {
+            case '^': return 4;
+            case '*': case '/': case '%': return 3;
+            case '+': case '-': return 2;
+            default: return 1; // "("
+        }
+    }
+}
+
+void StreamParser::push_operand( value_type value_ )
+{
+    last_token = token_kind::OPERAND;
+    if ( failed ) return;
+
+    values.push( value_ );
+}
+
+void StreamParser::push_operator( char op_ )
+{
+    last_token = token_kind::OPERATOR;
+    if ( failed ) return;
+
+    // Pop out all the element with higher priority, like has_higher_precedence().
+    auto p = precedence( op_ );
+    while ( not operators.empty() )
+    {
+        auto top = operators.top();
+        auto p_top = precedence( top );
+        if ( ( p_top == p and top == '^' ) or p_top < p ) break;
+
+        apply_top();
+    }
+    operators.push( op_ );
+}
+
+void StreamParser::push_opening( void )
+{
+    last_token = token_kind::OPENING;
+    if ( failed ) return;
+
+    operators.push( '(' );
+}
+
+void StreamParser::push_closing( void )
+{
+    last_token = token_kind::CLOSING;
+    if ( failed ) return;
+
+    while ( operators.top() != '(' )
+        apply_top();
+    operators.pop(); // Remove the '(' that was on the stack.
+}
+
+/// @brief Applies the operator on top of the stack to the top two values.
+void StreamParser::apply_top( void )
+{
+    auto op = operators.top();
+    operators.pop();
+    if ( failed ) return;
+
+    auto op2 = values.top(); values.pop();
+    auto op1 = values.top(); values.pop();
+
+    auto result = execute_operator( op1, op2, op );
+    values.push( result.first );
+
+    // Same codes as evaluate_postfix(); the first error decides the answer.
+    if ( result.second != 0 )
+    {
+        failed = true;
+        answer = std::make_pair( result.first, result.second < 0 ? -10 : 10 );
+    }
+}
@@ -0,0 +1,156 @@
+/**
+ * @file thread_pool.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Thread Pool
+ * @brief Work-stealing thread pool used by the parallel modes.
+ */
+
+#include "../include/thread_pool.hpp"
+
+namespace
+{
+    thread_local const ThreadPool * current_pool = nullptr; //!< Pool of the calling worker.
+    thread_local size_t current_index = 0;                  //!< Deque of the calling worker.
+}
+
+/// @brief Starts `n_workers_` workers (at least one).
+ThreadPool::ThreadPool( size_t n_workers_ )
+{
+    if ( n_workers_ == 0 ) n_workers_ = 1;
+
+    for ( auto i(0u); i < n_workers_; ++i )
+        queues.emplace_back( new WorkQueue );
+
+    for ( auto i(0u); i < n_workers_; ++i )
+        workers.emplace_back( &ThreadPool::worker_loop, this, i );
+}
+
+/// @brief Finishes the queued tasks and joins the workers.
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard< std::mutex > guard( sleep_lock );
+        stopping = true;
+    }
+    wake_up.notify_all();
+
+    for ( auto & w : workers )
+        w.join();
+}
+
+/// @brief Index of the calling thread deque, or a round robin pick for outsiders.
+size_t ThreadPool::home_queue( void )
+{
+    if ( current_pool == this )
+        return current_index;
+
+    return next_queue++ % queues.size();
+}
+
+/// @brief Queues a detached task.
+void ThreadPool::submit( task_type task_ )
+{
+    auto & q = *queues[ home_queue() ];
+    {
+        std::lock_guard< std::mutex > guard( q.lock );
+        q.tasks.push_back( std::move( task_ ) );
+    }
+    {
+        // Counting under the sleep lock avoids losing a wake up.
+        std::lock_guard< std::mutex > guard( sleep_lock );
+        ++queued;
+    }
+    wake_up.notify_one();
+
+    // A thread waiting on a group may run it.
+    task_ready.notify_all();
+}
+
+/// @brief Queues a task that belongs to the group `group_`.
+void ThreadPool::run( TaskGroup & group_, task_type task_ )
+{
+    ++group_.pending;
+    submit( [ this, &group_, task_ ]()
+    {
+        task_();
+        if ( --group_.pending > 0 ) return;
+
+        // The group may be gone once wait() sees zero: only the pool is touched from here.
+        { std::lock_guard< std::mutex > guard( sleep_lock ); }
+        task_ready.notify_all();
+    } );
+}
+
+/// @brief Runs queued tasks until every task of `group_` is done.
+void ThreadPool::wait( TaskGroup & group_ )
+{
+    auto home = ( current_pool == this ) ? current_index : 0;
+    task_type task;
+
+    while ( group_.pending > 0 )
+    {
+        // Help instead of blocking: the task we run may be one of ours.
+        if ( try_pop( home, task ) )
+        {
+            task();
+            continue;
+        }
+
+        // Nothing left to steal: sleep until the group is done or there is a task to help with.
+        std::unique_lock< std::mutex > guard( sleep_lock );
+        task_ready.wait( guard, [ this, &group_ ](){ return group_.pending == 0 or queued > 0; } );
+    }
+}
+
+/// @brief Pops from the own deque or steals from another one.
+bool ThreadPool::try_pop( size_t home_, task_type & task_ )
+{
+    const auto n = queues.size();
+
+    for ( auto i(0u); i < n; ++i )
+    {
+        auto & q = *queues[ ( home_ + i ) % n ];
+        std::lock_guard< std::mutex > guard( q.lock );
+
+        if ( q.tasks.empty() ) continue;
+
+        if ( i == 0 ) // Own deque: newest task first.
+        {
+            task_ = std::move( q.tasks.back() );
+            q.tasks.pop_back();
+        }
+        else // Stealing: oldest (usually the biggest) task first.
+        {
+            task_ = std::move( q.tasks.front() );
+            q.tasks.pop_front();
+        }
+        --queued;
+        return true;
+    }
+
+    return false;
+}
+
+/// @brief Main loop of the worker `index_`.
+void ThreadPool::worker_loop( size_t index_ )
+{
+    current_pool = this;
+    current_index = index_;
+    task_type task;
+
+    while ( true )
+    {
+        if ( try_pop( index_, task ) )
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock< std::mutex > guard( sleep_lock );
+        wake_up.wait( guard, [ this ](){ return stopping or queued > 0; } );
+
+        if ( stopping and queued == 0 ) return;
+    }
+}
@@ -0,0 +1,223 @@
+/**
+ * @file threaded_eval.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Threaded Interpreter Code
+ * @brief A direct-threaded interpreter for compiled postfix expressions.
+ */
+
+#include "../include/threaded_eval.hpp"
+
+#include <algorithm> // std::max
+#include <cassert>   // assert
+#include <cmath>     // pow
+#include <limits>    // std::numeric_limits
+#include <memory>    // std::unique_ptr
+
+namespace
+{
+    //! @brief Same range check as execute_operator().
+    inline bool out_of_range( value_type value_ )
+    {
+        return value_ < std::numeric_limits< short int >::min() or value_ > std::numeric_limits< short int >::max();
+    }
+
+    //! @brief The threaded version of an operator opcode.
+    threaded_op_t plain( opcode_t op_ )
+    {
+        assert( op_ != opcode_t::PUSH );
+        return static_cast< threaded_op_t >( static_cast< int >( op_ ) - static_cast< int >( opcode_t::ADD ) +
+                                             static_cast< int >( threaded_op_t::ADD ) );
+    }
+
+    //! @brief The version of an operator opcode that takes its right operand as an immediate.
+    threaded_op_t with_constant( opcode_t op_ )
+    {
+        assert( op_ != opcode_t::PUSH );
+        return static_cast< threaded_op_t >( static_cast< int >( op_ ) - static_cast< int >( opcode_t::ADD ) +
+                                             static_cast< int >( threaded_op_t::ADD_K ) );
+    }
+
+    //! @brief The threaded version of a unary opcode.
+    threaded_op_t unary( opcode_t op_ )
+    {
+        assert( is_unary( op_ ) );
+        return static_cast< threaded_op_t >( static_cast< int >( op_ ) - static_cast< int >( opcode_t::NEG ) +
+                                             static_cast< int >( threaded_op_t::NEG ) );
+    }
+
+    /*!
+     * @brief The interpreter loop, with its value stack at `stack_`.
+     *
+     * Called with a `table_`, it only hands out the addresses of its
+     * handlers, which decode_program() stores in the instructions: labels
+     * can't be seen from outside the function they are in.
+     */
+    std::pair< value_type,int > run( const ThreadedOp * ip, value_type * stack_, const void * const ** table_ )
+    {
+#if BARES_COMPUTED_GOTO
+        // Same order as threaded_op_t.
+        static const void * const handlers[] = {
+            &&op_PUSH,
+            &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_POW,
+            &&op_ADD_K, &&op_SUB_K, &&op_MUL_K, &&op_DIV_K, &&op_MOD_K, &&op_POW_K,
+            &&op_MADD, &&op_MADD_K,
+            &&op_NEG, &&op_SHL, &&op_DIV2, &&op_MOD2, &&op_SQR, &&op_HALT };
+
+        static_assert( sizeof( handlers ) / sizeof( handlers[0] ) == static_cast< size_t >( threaded_op_t::HALT ) + 1,
+                       "One handler per operation." );
+
+        if ( table_ != nullptr )
+        {
+            *table_ = handlers;
+            return std::make_pair( 0, 0 );
+        }
+
+#define CASE( name ) op_##name:
+#define DISPATCH() goto *ip->handler
+#define NEXT() goto *( ++ip )->handler
+#else
+        (void) table_;
+
+#define CASE( name ) case threaded_op_t::name:
+#define DISPATCH() goto dispatch
+#define NEXT() do { ++ip; goto dispatch; } while ( false )
+#endif
+
+// The first value of a binary operation, its right operand popped into `y`.
+#define BINARY( y ) auto y = *sp--; (void) y
+
+// Same error codes as evaluate_postfix(); the value is the one it would leave on top.
+#define CHECK() if ( out_of_range( *sp ) ) goto overflow
+
+        // `sp` points at the top of the stack.
+        value_type * sp = stack_ - 1;
+        DISPATCH();
+
+#if not BARES_COMPUTED_GOTO
+    dispatch:
+        switch ( ip->code )
+        {
+#endif
+        CASE( PUSH )  { *++sp = ip->imm; NEXT(); }
+
+        CASE( ADD )   { BINARY( y ); *sp += y; CHECK(); NEXT(); }
+        CASE( SUB )   { BINARY( y ); *sp -= y; CHECK(); NEXT(); }
+        CASE( MUL )   { BINARY( y ); *sp *= y; CHECK(); NEXT(); }
+        CASE( DIV )   { BINARY( y ); if ( y == 0 ) goto division_by_zero; *sp /= y; CHECK(); NEXT(); }
+        CASE( MOD )   { BINARY( y ); if ( y == 0 ) goto division_by_zero; *sp %= y; CHECK(); NEXT(); }
+        CASE( POW )   { BINARY( y ); *sp = static_cast< value_type >( pow( *sp, y ) ); CHECK(); NEXT(); }
+
+        CASE( ADD_K ) { *sp += ip->imm; CHECK(); NEXT(); }
+        CASE( SUB_K ) { *sp -= ip->imm; CHECK(); NEXT(); }
+        CASE( MUL_K ) { *sp *= ip->imm; CHECK(); NEXT(); }
+        CASE( DIV_K ) { if ( ip->imm == 0 ) goto division_by_zero; *sp /= ip->imm; CHECK(); NEXT(); }
+        CASE( MOD_K ) { if ( ip->imm == 0 ) goto division_by_zero; *sp %= ip->imm; CHECK(); NEXT(); }
+        CASE( POW_K ) { *sp = static_cast< value_type >( pow( *sp, ip->imm ) ); CHECK(); NEXT(); }
+
+        // The product is checked first, as a separate "*" would be.
+        CASE( MADD )  { BINARY( y ); *sp *= y; CHECK(); BINARY( p ); *sp += p; CHECK(); NEXT(); }
+        CASE( MADD_K ) { auto p = *sp * ip->imm; *sp = p; CHECK(); --sp; *sp += p; CHECK(); NEXT(); }
+
+        CASE( NEG )   { *sp = -*sp; CHECK(); NEXT(); }
+        CASE( SHL )   { *sp = shift_left( *sp, ip->imm ); CHECK(); NEXT(); }
+        CASE( DIV2 )  { *sp = divide_pow2( *sp, ip->imm ); NEXT(); }
+        CASE( MOD2 )  { *sp = remainder_pow2( *sp, ip->imm ); NEXT(); }
+        CASE( SQR )   { *sp *= *sp; CHECK(); NEXT(); }
+
+        CASE( HALT )  { return std::make_pair( *sp, 0 ); }
+#if not BARES_COMPUTED_GOTO
+        }
+#endif
+
+    overflow:
+        return std::make_pair( *sp, 10 );
+
+    division_by_zero:
+        // execute_operator() leaves 0 behind a division by zero.
+        return std::make_pair( 0, -10 );
+
+#undef CASE
+#undef DISPATCH
+#undef NEXT
+#undef BINARY
+#undef CHECK
+    }
+}
+
+/// @brief Decodes the program in [first_, last_), which must form a whole expression.
+ThreadedProgram decode_program( const Instruction * first_, const Instruction * last_ )
+{
+    ThreadedProgram program;
+    program.code.reserve( static_cast< size_t >( last_ - first_ ) + 1 );
+    size_t depth = 0;
+
+    for ( ; first_ != last_; ++first_ )
+    {
+        auto & code = program.code;
+
+        if ( first_->op == opcode_t::PUSH and first_ + 1 != last_ and first_[1].op != opcode_t::PUSH and
+             not is_unary( first_[1].op ) )
+        {
+            // A constant right operand: "k op" becomes "op_K k".
+            code.push_back( ThreadedOp{ nullptr, first_->operand, with_constant( first_[1].op ) } );
+            ++first_;
+        }
+        else if ( first_->op == opcode_t::PUSH )
+        {
+            code.push_back( ThreadedOp{ nullptr, first_->operand, threaded_op_t::PUSH } );
+            program.max_depth = std::max( program.max_depth, ++depth );
+        }
+        else if ( is_unary( first_->op ) )
+        {
+            code.push_back( ThreadedOp{ nullptr, first_->operand, unary( first_->op ) } );
+        }
+        else if ( first_->op == opcode_t::ADD and not code.empty() and
+                  ( code.back().code == threaded_op_t::MUL or code.back().code == threaded_op_t::MUL_K ) )
+        {
+            // The multiplication just before it is fused with the addition.
+            --depth;
+            code.back().code = code.back().code == threaded_op_t::MUL ? threaded_op_t::MADD : threaded_op_t::MADD_K;
+        }
+        else
+        {
+            --depth;
+            code.push_back( ThreadedOp{ nullptr, 0, plain( first_->op ) } );
+        }
+    }
+    program.code.push_back( ThreadedOp{ nullptr, 0, threaded_op_t::HALT } );
+
+#if BARES_COMPUTED_GOTO
+    const void * const * handlers = nullptr;
+    run( nullptr, nullptr, &handlers );
+    for ( auto & op : program.code )
+        op.handler = handlers[ static_cast< size_t >( op.code ) ];
+#endif
+
+    return program;
+}
+
+/// @brief Decodes a whole program.
+ThreadedProgram decode_program( const Program & program_ )
+{
+    return decode_program( program_.data(), program_.data() + program_.size() );
+}
+
+/// @brief Runs a decoded program. Gives the same result as evaluate_postfix().
+std::pair< value_type,int > execute_threaded( const ThreadedProgram & program_ )
+{
+    // Most expressions fit the local buffer; deeper ones get a heap one.
+    constexpr size_t local_depth = 64;
+    value_type local[ local_depth ];
+    std::unique_ptr< value_type[] > heap;
+
+    value_type * stack = local;
+    if ( program_.max_depth > local_depth )
+    {
+        heap.reset( new value_type[ program_.max_depth ] );
+        stack = heap.get();
+    }
+
+    return run( program_.code.data(), stack, nullptr );
+}
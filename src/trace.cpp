@@ -0,0 +1,131 @@
+/**
+ * @file trace.cpp
+ * @version 1.0
+ * @date Oct, 18.
+ * @author Daniel Guerra and Oziel Alves
+ * @title Trace Code
+ * @brief Timestamped spans of each expression and phase, exported as Chrome trace events.
+ */
+
+#include "../include/trace.hpp"
+
+#include <algorithm> // std::min
+#include <chrono>    // std::chrono::steady_clock
+#include <fstream>   // std::ofstream
+#include <memory>    // std::unique_ptr
+#include <mutex>     // std::mutex
+#include <vector>    // std::vector
+
+namespace
+{
+    /*!
+     * @brief Spans of one thread. Only that thread writes; the oldest spans are overwritten.
+     *
+     * The write position is published with release ordering after each
+     * event is stored, so a reader that acquires it sees whole events.
+     */
+    struct TraceRing
+    {
+        explicit TraceRing( size_t capacity_, std::uint32_t tid_ )
+            : events( capacity_ )
+            , tid( tid_ )
+        { /* empty */ }
+
+        std::vector< TraceEvent > events;
+        std::atomic< std::uint64_t > head{ 0 }; //!< Events written so far.
+        std::uint32_t tid;                      //!< Thread number in the trace.
+    };
+
+    std::mutex registry_mutex;                          //!< Guards `rings`; taken once per thread.
+    std::vector< std::unique_ptr< TraceRing > > rings;  //!< Rings of every thread that recorded a span.
+    size_t ring_capacity = default_trace_capacity;
+    std::chrono::steady_clock::time_point origin;       //!< Time zero of the trace.
+
+    thread_local TraceRing * my_ring = nullptr;          //!< Ring of the calling thread.
+
+    //! @brief The calling thread's ring, created on its first span.
+    TraceRing & ring( void )
+    {
+        if ( my_ring == nullptr )
+        {
+            std::lock_guard< std::mutex > lock( registry_mutex );
+            rings.emplace_back( new TraceRing( ring_capacity, static_cast< std::uint32_t >( rings.size() + 1 ) ) );
+            my_ring = rings.back().get();
+        }
+        return *my_ring;
+    }
+
+    //! @brief Writes `ns_` nanoseconds as microseconds, the unit of trace events.
+    void write_us( std::ofstream & ofs_, std::uint64_t ns_ )
+    {
+        ofs_ << ns_ / 1000 << '.';
+        auto frac = ns_ % 1000;
+        ofs_ << char( '0' + frac / 100 ) << char( '0' + frac / 10 % 10 ) << char( '0' + frac % 10 );
+    }
+}
+
+namespace trace_detail
+{
+    bool enabled = false;
+    std::atomic< std::uint64_t > line{ 0 };
+
+    std::uint64_t now( void )
+    {
+        return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - origin ).count();
+    }
+
+    void record( const TraceEvent & event_ )
+    {
+        auto & r = ring();
+        auto h = r.head.load( std::memory_order_relaxed );
+        r.events[ h % r.events.size() ] = event_;
+        r.head.store( h + 1, std::memory_order_release );
+    }
+}
+
+/// @brief Turns tracing on, with room for `capacity_` spans per thread. Call it before any span.
+/// The calling thread is the first one of the trace.
+void trace_start( size_t capacity_ )
+{
+    ring_capacity = capacity_ == 0 ? 1 : capacity_;
+    origin = std::chrono::steady_clock::now();
+    trace_detail::enabled = true;
+    ring();
+}
+
+/// @brief Writes every recorded span as Chrome trace-event JSON. Call it after the workers are done.
+bool trace_write_json( const std::string & path_ )
+{
+    std::ofstream ofs( path_.c_str() );
+    if ( not ofs ) return false;
+
+    std::lock_guard< std::mutex > lock( registry_mutex );
+    ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+    bool first = true;
+    for ( const auto & r : rings )
+    {
+        // Thread name, shown by the viewers instead of the number.
+        ofs << ( first ? "\n" : ",\n" )
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid
+            << ",\"args\":{\"name\":\"" << ( r->tid == 1 ? std::string( "main" ) : "thread " + std::to_string( r->tid ) ) << "\"}}";
+        first = false;
+
+        // Only the last `capacity` spans are still there.
+        auto head = r->head.load( std::memory_order_acquire );
+        auto count = std::min< std::uint64_t >( head, r->events.size() );
+        for ( auto i = head - count; i < head; ++i )
+        {
+            const auto & e = r->events[ i % r->events.size() ];
+            ofs << ",\n{\"name\":\"" << e.name << "\",\"cat\":\"bares\",\"ph\":\"X\",\"pid\":1,\"tid\":" << r->tid
+                << ",\"ts\":";
+            write_us( ofs, e.start );
+            ofs << ",\"dur\":";
+            write_us( ofs, e.duration );
+            ofs << ",\"args\":{\"line\":" << e.line << "}}";
+        }
+    }
+
+    ofs << "\n]}\n";
+    return not ofs.fail();
+}